@@ -1,4 +1,7 @@
 #include <animation/animation.h>
+#ifdef GEF_FAST_MATH
+#include <maths/fast_math.h>
+#endif
 
 namespace gef
 {
@@ -86,7 +89,11 @@ namespace gef
 			if(pNextKey)
 			{
 				float t = (_time - pPrevKey->time) / (pNextKey->time - pPrevKey->time);
+#ifdef GEF_FAST_MATH
+				FastSlerp(result, pPrevKey->value, pNextKey->value, t);
+#else
 				result.Slerp(pPrevKey->value, pNextKey->value, t);
+#endif
 			}
 			else
 				result = pPrevKey->value;
@@ -225,42 +225,42 @@ bool OBJLoader::Load(const std::string& filename, Platform& platform, Model& mod
 						std::string name = om_it->second.diffuse_texture_;
 						auto lt_it = loaded_texture.find(name);
 						if(lt_it != loaded_texture.end()){
-							new_mat->texture_diffuse_ = lt_it->second;
+							new_mat->set_texture_diffuse(lt_it->second);
 						}else if(!name.empty()){
 							Texture* new_texture = gef::Texture::Create(platform, {name.c_str()});
 							loaded_texture.insert({name, new_texture });
-							new_mat->texture_diffuse_ = new_texture;
+							new_mat->set_texture_diffuse(new_texture);
 						}
 					}
 					{//Get Specular Texture
 						std::string name = om_it->second.specular_texture_;
 						auto lt_it = loaded_texture.find(name);
 						if (lt_it != loaded_texture.end()) {
-							new_mat->texture_specular_ = lt_it->second;
+							new_mat->set_texture_specular(lt_it->second);
 						}
 						else if (!name.empty()) {
 							Texture* new_texture = gef::Texture::Create(platform, { name.c_str() });
 							loaded_texture.insert({ name, new_texture });
-							new_mat->texture_specular_ = new_texture;
+							new_mat->set_texture_specular(new_texture);
 						}
 					}
 					{//Get Normal Texture
 						std::string name = om_it->second.normal_texture_;
 						auto lt_it = loaded_texture.find(name);
 						if (lt_it != loaded_texture.end()) {
-							new_mat->texture_normal_ = lt_it->second;
+							new_mat->set_texture_normal(lt_it->second);
 						}
 						else if (!name.empty()) {
 							Texture* new_texture = gef::Texture::Create(platform, { name.c_str() });
 							loaded_texture.insert({ name, new_texture });
-							new_mat->texture_normal_ = new_texture;
+							new_mat->set_texture_normal(new_texture);
 						}
 					}
 					//Other parameters
-					new_mat->ambient_ = om_it->second.ambient_;
-					new_mat->diffuse_ = om_it->second.diffuse_;
-					new_mat->specular_ = om_it->second.specular_;
-					new_mat->shininess_ = om_it->second.shininess_;
+					new_mat->set_ambient(om_it->second.ambient_);
+					new_mat->set_diffuse(om_it->second.diffuse_);
+					new_mat->set_specular(om_it->second.specular_);
+					new_mat->set_shininess(om_it->second.shininess_);
 					mesh->GetPrimitive(primitive_num)->set_material(new_mat);
 				}else{
 					gef::DebugOut(("No material '"+material_name+"' found while loading model '"+filename+"'\n").c_str());
@@ -0,0 +1,19 @@
+#include <graphics/default_3d_instanced_shader.h>
+#include <graphics/shader_interface.h>
+
+namespace gef
+{
+	Default3DInstancedShader::Default3DInstancedShader(const Platform& platform)
+		: Default3DShader(platform, true)
+	{
+	}
+
+	void Default3DInstancedShader::SetSceneData(const LightData& light_data, const Matrix44& view_matrix, const Matrix44& projection_matrix, const LightClusters* light_clusters)
+	{
+		Default3DShader::SetSceneData(light_data, view_matrix, projection_matrix, light_clusters);
+
+		gef::Matrix44 view_projectionT;
+		view_projectionT.Transpose(view_projection_matrix_);
+		device_interface_->SetVertexShaderVariable(view_projection_matrix_variable_index_, &view_projectionT);
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef _GEF_DEFAULT_3D_INSTANCED_SHADER_H
+#define _GEF_DEFAULT_3D_INSTANCED_SHADER_H
+
+#include <graphics/default_3d_shader.h>
+
+namespace gef
+{
+	/**
+	The default shader for Renderer3D::DrawMeshInstanced.
+	Lighting and materials are the same as Default3DShader, but the world matrix of each instance
+	is read from vertex stream 1 so a single draw call renders every instance.
+	The instance stream holds one Matrix44 per instance, in the same row vector layout as Matrix44,
+	so SetMeshData is not used.
+	The vertex shader default_3d_instanced_shader_vs is not part of gef, as its output must match the input of
+	the default_3d_shader_ps the application deploys, so applications that want hardware instancing supply it
+	next to the default shaders. It reads position, normal and uv (POSITION, NORMAL, TEXCOORD0) from stream 0,
+	the rows of the instance matrix (WORLD0 to WORLD3) from stream 1, and the transposed view projection matrix
+	from the first constant buffer. If it is missing, DrawMeshInstanced draws each instance with Default3DShader.
+	*/
+	class Default3DInstancedShader : public Default3DShader
+	{
+	public:
+		Default3DInstancedShader(const Platform& platform);
+
+		void SetSceneData(const LightData& light_data, const Matrix44& view_matrix, const Matrix44& projection_matrix, const LightClusters* light_clusters = NULL);
+	};
+}
+
+#endif // _GEF_DEFAULT_3D_INSTANCED_SHADER_H
@@ -14,7 +14,6 @@
 #include <graphics/material.h>
 #include <graphics/colour.h>
 #include <graphics/light_data.h>
-#include <array>
 
 #ifdef _WIN32
 #include <platform/d3d11/graphics/shader_interface_d3d11.h>
@@ -24,26 +23,40 @@
 namespace gef
 {
 	Default3DShader::Default3DShader(const Platform& platform)
+	:Default3DShader(platform, false)
+	{
+	}
+
+	Default3DShader::Default3DShader(const Platform& platform, bool instanced)
 	:Shader(platform)
 	,wvp_matrix_variable_index_{0}
 	,world_matrix_variable_index_{0}
+	,view_projection_matrix_variable_index_{0}
 	,ambient_variable_index_{0}
 	,diffuse_variable_index_{0}
 	,specular_variable_index_{0}
 	,shininess_variable_index_{0}
-	,ambient_light_colour_variable_index_{0}
-	,light_data_variable_index_{0}
 	,diffuse_sampler_index_{0}
 	,specular_sampler_index_{0}
 	,normal_sampler_index_{0}
+	,bound_material_(NULL)
+	,bound_material_version_{0}
 	{
 		// Compile shaders
-		device_interface_->SetVertexShaderPath(L"default_3d_shader_vs", L"shaders/gef", platform);
+		device_interface_->SetVertexShaderPath(instanced ? L"default_3d_instanced_shader_vs" : L"default_3d_shader_vs", L"shaders/gef", platform);
 		device_interface_->SetPixelShaderPath(L"default_3d_shader_ps", L"shaders/gef", platform);
 
 		// Vertex Shader
-		wvp_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("wvp", ShaderInterface::kMatrix44);
-		world_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("world", ShaderInterface::kMatrix44);
+		// the instanced vertex shader reads the world matrix from the instance stream
+		if (instanced)
+		{
+			view_projection_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("view_projection", ShaderInterface::kMatrix44);
+		}
+		else
+		{
+			wvp_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("wvp", ShaderInterface::kMatrix44);
+			world_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("world", ShaderInterface::kMatrix44);
+		}
 
 		// Pixel Shader
 		ambient_variable_index_ = device_interface_->AddPixelShaderVariable("ambient", ShaderInterface::kVector4);
@@ -51,10 +64,7 @@ namespace gef
 		specular_variable_index_ = device_interface_->AddPixelShaderVariable("specular", ShaderInterface::kVector4);
 		shininess_variable_index_ = device_interface_->AddPixelShaderVariable("shininess", ShaderInterface::kFloat);
 
-		//Light Shader Variables
-		viewer_position_variable_index_ = device_interface_->AddLightShaderVariable("viewer_position", gef::ShaderInterface::kVector4);
-		ambient_light_colour_variable_index_ = device_interface_->AddLightShaderVariable("ambient_light_colour", gef::ShaderInterface::kVector4);
-		light_data_variable_index_ = device_interface_->AddLightShaderVariable("lights", gef::ShaderInterface::kLightData, MAX_LIGHTS);
+		light_block_.AddVariables(*device_interface_);
 
 		diffuse_sampler_index_ = device_interface_->AddTextureSampler("diffuse_sampler", gef::ShaderInterface::TextureType::DIFFUSE);
 		specular_sampler_index_ = device_interface_->AddTextureSampler("specular_sampler", gef::ShaderInterface::TextureType::SPECULAR);
@@ -64,6 +74,13 @@ namespace gef
 		device_interface_->AddVertexParameter("normal", ShaderInterface::kVector3, 12, "NORMAL", 0);
 		device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 24, "TEXCOORD", 0);
 		device_interface_->set_vertex_size(sizeof(Mesh::Vertex));
+		if (instanced)
+		{
+			// one row of the world matrix per parameter, in stream 1
+			for (int row = 0; row < 4; ++row)
+				device_interface_->AddVertexParameter("world", ShaderInterface::kVector4, row * sizeof(Vector4), "WORLD", row, 1, true);
+			device_interface_->set_instance_size(sizeof(Matrix44));
+		}
 		device_interface_->CreateVertexFormat();
 
 #ifdef _WIN32
@@ -94,15 +111,16 @@ namespace gef
 	Default3DShader::Default3DShader()
 		: wvp_matrix_variable_index_{0}
 		, world_matrix_variable_index_{0}
+		, view_projection_matrix_variable_index_{0}
 		, ambient_variable_index_{ 0 }
 		, diffuse_variable_index_{ 0 }
 		, specular_variable_index_{ 0 }
 		, shininess_variable_index_{ 0 }
-		, ambient_light_colour_variable_index_{0}
-		, light_data_variable_index_{0}
 		, diffuse_sampler_index_{0}
 		, specular_sampler_index_{0}
 		, normal_sampler_index_{0}
+		, bound_material_(NULL)
+		, bound_material_version_{0}
 	{
 
 	}
@@ -113,30 +131,10 @@ namespace gef
 
 
 
-	void Default3DShader::SetSceneData(const LightData& shader_data, const Matrix44& view_matrix, const Matrix44& projection_matrix)
+	void Default3DShader::SetSceneData(const LightData& shader_data, const Matrix44& view_matrix, const Matrix44& projection_matrix, const LightClusters* light_clusters)
 	{
-		//gef::Matrix44 wvp = world_matrix * view_matrix * projection_matrix;
-		gef::Vector4 ambient_light_colour = shader_data.AmbientLightColour().GetRGBAasVector4();
-		std::array<gef::LightData::Light, MAX_LIGHTS> shader_lights{};
-		int i = 0;
-		for (auto& light : shader_data.GetLights())
-		{
-			shader_lights[i] = light.second;
-			i++;
-			if (i == MAX_LIGHTS) break;
-		}
-		//A Radius that is -1 is to determine end of lights in shader
-		if (i < MAX_LIGHTS) shader_lights[i].radius_ = -1.f;
-
-		view_projection_matrix_ = view_matrix * projection_matrix;
-		gef::Matrix44 inverse_vp{};
-		inverse_vp.Inverse(view_projection_matrix_);
-		gef::Vector4 viewer_position{ inverse_vp.GetRow(3) };
-		viewer_position *= 1/viewer_position.w();
-		viewer_position.set_w(1);
-		device_interface_->SetLightShaderVariable(viewer_position_variable_index_, (void*)&viewer_position);
-		device_interface_->SetLightShaderVariable(ambient_light_colour_variable_index_, (void*)&ambient_light_colour);
-		device_interface_->SetLightShaderVariable(light_data_variable_index_, (void*)shader_lights.data());
+		light_block_.SetSceneData(*device_interface_, shader_data, light_clusters, view_matrix, projection_matrix);
+		view_projection_matrix_ = light_block_.view_projection_matrix();
 	}
 
 	void Default3DShader::SetMeshData(const gef::MeshInstance& mesh_instance)
@@ -156,16 +154,23 @@ namespace gef
 
 	void Default3DShader::SetMaterialData(const gef::Material* material)
 	{
-		Material default_material{};
+		static const Material default_material{};
 
 		const Material* mat = (material != nullptr) ? material : &default_material;
-		device_interface_->SetPixelShaderVariable(ambient_variable_index_, &mat->ambient_);
-		device_interface_->SetPixelShaderVariable(diffuse_variable_index_, &mat->diffuse_);
-		device_interface_->SetPixelShaderVariable(specular_variable_index_, &mat->specular_);
-		device_interface_->SetPixelShaderVariable(shininess_variable_index_, &mat->shininess_);
-		device_interface_->SetTextureSampler(diffuse_sampler_index_, mat->texture_diffuse_);
-		device_interface_->SetTextureSampler(specular_sampler_index_, mat->texture_specular_);
-		device_interface_->SetTextureSampler(normal_sampler_index_, mat->texture_normal_);
+
+		// the pixel block and samplers still hold this material
+		if (mat == bound_material_ && mat->version() == bound_material_version_)
+			return;
+
+		// the constant block is packed in the same layout as the pixel shader variables, starting at ambient
+		device_interface_->SetPixelShaderVariables(ambient_variable_index_, &mat->constant_block(), sizeof(Material::ConstantBlock));
+		const Material::TextureSet& textures = mat->texture_set();
+		device_interface_->SetTextureSampler(diffuse_sampler_index_, textures.diffuse);
+		device_interface_->SetTextureSampler(specular_sampler_index_, textures.specular);
+		device_interface_->SetTextureSampler(normal_sampler_index_, textures.normal);
+
+		bound_material_ = mat;
+		bound_material_version_ = mat->version();
 	}
 
 } /* namespace gef */
@@ -13,6 +13,7 @@
 #include <maths/vector4.h>
 #include <maths/matrix44.h>
 #include <graphics/shader_interface.h>
+#include <graphics/light_block.h>
 
 namespace gef
 {
@@ -22,6 +23,7 @@ namespace gef
 	class Texture;
 	class Material;
 	class LightData;
+	class LightClusters;
 
 	class Default3DShader: public Shader
 	{
@@ -35,7 +37,8 @@ namespace gef
 
 		Default3DShader(const Platform& platform);
 		virtual ~Default3DShader();
-		void SetSceneData(const LightData& shader_data, const Matrix44& view_matrix, const Matrix44& projection_matrix);
+		/// @param[in] light_clusters	The clusters of the lights in shader_data, or NULL to disable clustering.
+		void SetSceneData(const LightData& shader_data, const Matrix44& view_matrix, const Matrix44& projection_matrix, const LightClusters* light_clusters = NULL);
 		void SetMeshData(const gef::MeshInstance& mesh_instance);
 		void SetMeshData(const gef::Matrix44& transform);
 		void SetMaterialData(const gef::Material* material);
@@ -43,19 +46,18 @@ namespace gef
 		inline PrimitiveData& primitive_data() { return primitive_data_; }
 	protected:
 		Default3DShader();
+		/// @param[in] instanced	Use the instanced vertex shader, which reads the world matrix from a per instance stream.
+		Default3DShader(const Platform& platform, bool instanced);
 
 		gef::ShaderInterface::VVIndex wvp_matrix_variable_index_;
 		gef::ShaderInterface::VVIndex world_matrix_variable_index_;
+		gef::ShaderInterface::VVIndex view_projection_matrix_variable_index_;
 
 		gef::ShaderInterface::PVIndex ambient_variable_index_;
 		gef::ShaderInterface::PVIndex diffuse_variable_index_;
 		gef::ShaderInterface::PVIndex specular_variable_index_;
 		gef::ShaderInterface::PVIndex shininess_variable_index_;
 
-		gef::ShaderInterface::LVIndex viewer_position_variable_index_;
-		gef::ShaderInterface::LVIndex ambient_light_colour_variable_index_;
-		gef::ShaderInterface::LVIndex light_data_variable_index_;
-
 		gef::ShaderInterface::TSIndex diffuse_sampler_index_;
 		gef::ShaderInterface::TSIndex specular_sampler_index_;
 		gef::ShaderInterface::TSIndex normal_sampler_index_;
@@ -64,6 +66,13 @@ namespace gef
 
 		gef::Matrix44 view_projection_matrix_;
 
+		// the light block and the scene data in it
+		LightBlock light_block_;
+
+		// material currently in the pixel block and texture samplers
+		const Material* bound_material_;
+		UInt32 bound_material_version_;
+
 	};
 
 } /* namespace gef */
@@ -14,7 +14,6 @@
 #include <graphics/material.h>
 #include <graphics/colour.h>
 #include <graphics/skinned_mesh_shader_data.h>
-#include <array>
 
 #ifdef _WIN32
 #include <platform/d3d11/graphics/shader_interface_d3d11.h>
@@ -31,12 +30,12 @@ namespace gef
 	, diffuse_variable_index_{ 0 }
 	, specular_variable_index_{ 0 }
 	, shininess_variable_index_{ 0 }
-	,ambient_light_colour_variable_index_{0}
-	,light_data_variable_index_{0}
 	,diffuse_sampler_index_{0}
 	,specular_sampler_index_{0}
 	,normal_sampler_index_{0}
 	,bone_matrices_variable_index_{0}
+	,bound_material_(NULL)
+	,bound_material_version_{0}
 	{
 		// Compile shaders
 		device_interface_->SetVertexShaderPath(L"default_3d_skinning_shader_vs", L"shaders/gef", platform);
@@ -53,10 +52,7 @@ namespace gef
 		specular_variable_index_ = device_interface_->AddPixelShaderVariable("specular", ShaderInterface::kVector4);
 		shininess_variable_index_ = device_interface_->AddPixelShaderVariable("shininess", ShaderInterface::kFloat);
 
-		//Light Shader Variables
-		viewer_position_variable_index_ = device_interface_->AddLightShaderVariable("viewer_position", gef::ShaderInterface::kVector4);
-		ambient_light_colour_variable_index_ = device_interface_->AddLightShaderVariable("ambient_light_colour", gef::ShaderInterface::kVector4);
-		light_data_variable_index_ = device_interface_->AddLightShaderVariable("lights", gef::ShaderInterface::kLightData, MAX_LIGHTS);
+		light_block_.AddVariables(*device_interface_);
 
 		diffuse_sampler_index_ = device_interface_->AddTextureSampler("diffuse_sampler", gef::ShaderInterface::TextureType::DIFFUSE);
 		specular_sampler_index_ = device_interface_->AddTextureSampler("specular_sampler", gef::ShaderInterface::TextureType::SPECULAR);
@@ -102,11 +98,11 @@ namespace gef
 		, diffuse_variable_index_{ 0 }
 		, specular_variable_index_{ 0 }
 		, shininess_variable_index_{ 0 }
-		, ambient_light_colour_variable_index_{0}
-		, light_data_variable_index_{0}
 		, diffuse_sampler_index_{ 0 }
 		, specular_sampler_index_{ 0 }
 		, normal_sampler_index_{ 0 }
+		, bound_material_(NULL)
+		, bound_material_version_{0}
 	{
 	}
 
@@ -114,33 +110,14 @@ namespace gef
 	{
 	}
 
-	void Default3DSkinningShader::SetSceneData(const SkinnedMeshShaderData& shader_data, const LightData& light_data, const Matrix44& view_matrix, const Matrix44& projection_matrix)
+	void Default3DSkinningShader::SetSceneData(const SkinnedMeshShaderData& shader_data, const LightData& light_data, const Matrix44& view_matrix, const Matrix44& projection_matrix, const LightClusters* light_clusters)
 	{
-		gef::Vector4 ambient_light_colour = light_data.AmbientLightColour().GetRGBAasVector4();
-		std::array<gef::LightData::Light, MAX_LIGHTS> shader_lights{};
-		int i = 0;
-		for (auto& light : light_data.GetLights())
-		{
-			shader_lights[i] = light.second;
-			i++;
-			if (i == MAX_LIGHTS) break;
-		}
-		//A Radius that is -1 is to determine end of lights in shader
-		if (i < MAX_LIGHTS) shader_lights[i].radius_ = -1.f;
-
-		view_projection_matrix_ = view_matrix * projection_matrix;
-		gef::Matrix44 inverse_vp{};
-		inverse_vp.Inverse(view_projection_matrix_);
-		gef::Vector4 viewer_position{ inverse_vp.GetRow(3) };
-		viewer_position *= 1 / viewer_position.w();
-		viewer_position.set_w(1);
-		device_interface_->SetLightShaderVariable(viewer_position_variable_index_, (void*)&viewer_position);
-		device_interface_->SetLightShaderVariable(ambient_light_colour_variable_index_, (void*)&ambient_light_colour);
-		device_interface_->SetLightShaderVariable(light_data_variable_index_, (void*)shader_lights.data());
+		light_block_.SetSceneData(*device_interface_, light_data, light_clusters, view_matrix, projection_matrix);
+		view_projection_matrix_ = light_block_.view_projection_matrix();
 
 		UInt32 k = 0;
 		for(const gef::Matrix44& bm : *shader_data.bone_matrices()){
-			bones_matrices[i].Transpose(bm);
+			bones_matrices[k].Transpose(bm);
 			k++;
 		}
 
@@ -165,15 +142,23 @@ namespace gef
 
 	void Default3DSkinningShader::SetMaterialData(const gef::Material* material)
 	{
-		Material default_material{};
+		static const Material default_material{};
+
 		const Material* mat = (material != nullptr) ? material : &default_material;
-		device_interface_->SetPixelShaderVariable(ambient_variable_index_, &mat->ambient_);
-		device_interface_->SetPixelShaderVariable(diffuse_variable_index_, &mat->diffuse_);
-		device_interface_->SetPixelShaderVariable(specular_variable_index_, &mat->specular_);
-		device_interface_->SetPixelShaderVariable(shininess_variable_index_, &mat->shininess_);
-		device_interface_->SetTextureSampler(diffuse_sampler_index_, mat->texture_diffuse_);
-		device_interface_->SetTextureSampler(specular_sampler_index_, mat->texture_specular_);
-		device_interface_->SetTextureSampler(normal_sampler_index_, mat->texture_normal_);
+
+		// the pixel block and samplers still hold this material
+		if (mat == bound_material_ && mat->version() == bound_material_version_)
+			return;
+
+		// the constant block is packed in the same layout as the pixel shader variables, starting at ambient
+		device_interface_->SetPixelShaderVariables(ambient_variable_index_, &mat->constant_block(), sizeof(Material::ConstantBlock));
+		const Material::TextureSet& textures = mat->texture_set();
+		device_interface_->SetTextureSampler(diffuse_sampler_index_, textures.diffuse);
+		device_interface_->SetTextureSampler(specular_sampler_index_, textures.specular);
+		device_interface_->SetTextureSampler(normal_sampler_index_, textures.normal);
+
+		bound_material_ = mat;
+		bound_material_version_ = mat->version();
 	}
 
 } /* namespace gef */
@@ -14,6 +14,7 @@
 #include <maths/matrix44.h>
 #include <graphics/light_data.h>
 #include <graphics/shader_interface.h>
+#include <graphics/light_block.h>
 
 constexpr int MAX_NUM_BONE_MATRICES = 128;
 
@@ -25,6 +26,7 @@ namespace gef
 	class Texture;
 	class Material;
 	class SkinnedMeshShaderData;
+	class LightClusters;
 
 	class Default3DSkinningShader: public Shader
 	{
@@ -37,7 +39,8 @@ namespace gef
 
 		Default3DSkinningShader(const Platform& platform);
 		virtual ~Default3DSkinningShader();
-		void SetSceneData(const SkinnedMeshShaderData& shader_data, const LightData& light_data, const Matrix44& view_matrix, const Matrix44& projection_matrix);
+		/// @param[in] light_clusters	The clusters of the lights in light_data, or NULL to disable clustering.
+		void SetSceneData(const SkinnedMeshShaderData& shader_data, const LightData& light_data, const Matrix44& view_matrix, const Matrix44& projection_matrix, const LightClusters* light_clusters = NULL);
 		void SetMeshData(const gef::MeshInstance& mesh_instance);
 		void SetMeshData(const gef::Matrix44& transform);
 		void SetMaterialData(const gef::Material* material);
@@ -55,10 +58,6 @@ namespace gef
 		gef::ShaderInterface::PVIndex specular_variable_index_;
 		gef::ShaderInterface::PVIndex shininess_variable_index_;
 
-		gef::ShaderInterface::LVIndex viewer_position_variable_index_;
-		gef::ShaderInterface::LVIndex ambient_light_colour_variable_index_;
-		gef::ShaderInterface::LVIndex light_data_variable_index_;
-
 		gef::ShaderInterface::TSIndex diffuse_sampler_index_;
 		gef::ShaderInterface::TSIndex specular_sampler_index_;
 		gef::ShaderInterface::TSIndex normal_sampler_index_;
@@ -68,6 +67,13 @@ namespace gef
 
 		gef::Matrix44 view_projection_matrix_;
 
+		// the light block and the scene data in it
+		LightBlock light_block_;
+
+		// material currently in the pixel block and texture samplers
+		const Material* bound_material_;
+		UInt32 bound_material_version_;
+
 	};
 
 } /* namespace gef */
@@ -0,0 +1,15 @@
+#include <graphics/default_sprite_batch_shader.h>
+#include <graphics/shader_interface.h>
+
+namespace gef
+{
+	DefaultSpriteBatchShader::DefaultSpriteBatchShader(const Platform& platform)
+		: DefaultSpriteShader(platform, true)
+	{
+	}
+
+	void DefaultSpriteBatchShader::SetTexture(const Texture* texture)
+	{
+		device_interface_->SetTextureSampler(texture_sampler_index_, texture);
+	}
+}
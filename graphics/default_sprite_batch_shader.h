@@ -0,0 +1,29 @@
+#ifndef _GEF_DEFAULT_SPRITE_BATCH_SHADER_H
+#define _GEF_DEFAULT_SPRITE_BATCH_SHADER_H
+
+#include <graphics/default_sprite_shader.h>
+
+namespace gef
+{
+	/**
+	The default shader for batched sprites.
+	The pixel shader is the same as DefaultSpriteShader, but the vertex shader reads the corners,
+	colours and uvs of each sprite from SpriteBatch::Vertex vertices instead of a per sprite variable,
+	so every sprite that uses the same texture is drawn with one draw call.
+	The vertex shader default_sprite_batch_shader_vs is not part of gef, as its output must match the input of
+	the default_sprite_shader_ps the application deploys, so applications that batch sprites or draw a UILayer
+	supply it next to the default shaders. It reads position, colour and uv (POSITION, COLOR0, TEXCOORD0) from
+	SpriteBatch::Vertex and the transposed projection matrix from the first constant buffer.
+	If it is missing, SpriteRenderer draws each sprite with DefaultSpriteShader.
+	*/
+	class DefaultSpriteBatchShader : public DefaultSpriteShader
+	{
+	public:
+		DefaultSpriteBatchShader(const Platform& platform);
+
+		/// @brief Sets the texture the next run of sprites is drawn with.
+		void SetTexture(const Texture* texture);
+	};
+}
+
+#endif // _GEF_DEFAULT_SPRITE_BATCH_SHADER_H
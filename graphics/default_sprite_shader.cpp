@@ -12,6 +12,7 @@
 #include <system/debug_log.h>
 #include <string>
 #include <graphics/sprite.h>
+#include <graphics/sprite_batch.h>
 #include <math.h>
 
 #ifdef _WIN32
@@ -21,21 +22,38 @@
 namespace gef
 {
 	DefaultSpriteShader::DefaultSpriteShader(const Platform& platform)
+		:DefaultSpriteShader(platform, false)
+	{
+	}
+
+	DefaultSpriteShader::DefaultSpriteShader(const Platform& platform, bool batched)
 		:Shader(platform)
 		,sprite_data_variable_index_{0}
 		,projection_matrix_variable_index_{ 0 }
 		,texture_sampler_index_{ 0 }
 	{
 		// Compile shaders
-		device_interface_->SetVertexShaderPath(L"default_sprite_shader_vs", L"shaders/gef", platform);
+		device_interface_->SetVertexShaderPath(batched ? L"default_sprite_batch_shader_vs" : L"default_sprite_shader_vs", L"shaders/gef", platform);
 		device_interface_->SetPixelShaderPath(L"default_sprite_shader_ps", L"shaders/gef", platform);
 
 		projection_matrix_variable_index_ = device_interface_->AddVertexShaderVariable("proj_matrix", ShaderInterface::kMatrix44);
-		sprite_data_variable_index_ = device_interface_->AddVertexShaderVariable("sprite_data", ShaderInterface::kMatrix44);
 		texture_sampler_index_ = device_interface_->AddTextureSampler("texture_sampler");
 
-		device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
-		device_interface_->set_vertex_size(12);
+		// the batched vertex shader reads each sprite from the expanded quad vertices
+		if (batched)
+		{
+			device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
+			device_interface_->AddVertexParameter("colour", ShaderInterface::kUByte4Norm, 12, "COLOR", 0);
+			device_interface_->AddVertexParameter("uv", ShaderInterface::kVector2, 16, "TEXCOORD", 0);
+			device_interface_->set_vertex_size(sizeof(SpriteBatch::Vertex));
+		}
+		else
+		{
+			sprite_data_variable_index_ = device_interface_->AddVertexShaderVariable("sprite_data", ShaderInterface::kMatrix44);
+
+			device_interface_->AddVertexParameter("position", ShaderInterface::kVector3, 0, "POSITION", 0);
+			device_interface_->set_vertex_size(12);
+		}
 
 		device_interface_->CreateVertexFormat();
 
@@ -121,10 +139,12 @@ namespace gef
 		}
 		else
 		{
-			sprite_data.set_m(0,0,cosf(sprite.rotation())*sprite.width());
-			sprite_data.set_m(0,1,sinf(sprite.rotation())*sprite.width());
-			sprite_data.set_m(1,0,-sinf(sprite.rotation())*sprite.height());
-			sprite_data.set_m(1,1,cosf(sprite.rotation())*sprite.height());
+			const float cos_rotation = cosf(sprite.rotation());
+			const float sin_rotation = sinf(sprite.rotation());
+			sprite_data.set_m(0,0,cos_rotation*sprite.width());
+			sprite_data.set_m(0,1,sin_rotation*sprite.width());
+			sprite_data.set_m(1,0,-sin_rotation*sprite.height());
+			sprite_data.set_m(1,1,cos_rotation*sprite.height());
 		}
 
 		// Source rectangle
@@ -28,6 +28,7 @@ namespace gef
 		void SetSpriteData(const Sprite& sprite, const Texture* texture);
 	protected:
 		DefaultSpriteShader();
+		DefaultSpriteShader(const Platform& platform, bool batched);
 		void BuildSpriteShaderData(const Sprite& sprite, Matrix44& sprite_data);
 
 
@@ -1,15 +1,16 @@
 #include <graphics/font.h>
 #include <maths/vector2.h>
 #include <graphics/texture.h>
+#include <graphics/glyph_atlas.h>
 #include <graphics/sprite_renderer.h>
 #include <graphics/sprite.h>
 #include <assets/png_loader.h>
 #include <graphics/image_data.h>
 #include <system/platform.h>
 #include <system/file.h>
-#include <system/memory_stream_buffer.h>
-//#include <fstream>
-#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <utility>
 #include <cstdarg>
 #include <string>
 #include <cstdio>
@@ -21,212 +22,709 @@
 namespace gef
 {
 
+namespace
+{
+	const UInt32 kBinaryFontFileId = 0x46464547;		// "GEFF"
+	const UInt32 kBinaryFontVersion = 1;
+
+	// the binary font is a header, the glyph records, then the kerning pairs sorted by first and second character
+	// every record is a multiple of four bytes, so a file that is loaded or mapped to aligned memory can be read in place
+	struct BinaryFontHeader
+	{
+		UInt32 file_id;
+		UInt32 version;
+		UInt16 line_height;
+		UInt16 base;
+		UInt16 width;
+		UInt16 height;
+		UInt16 pages;
+		UInt16 padding;
+		UInt32 num_glyphs;
+		UInt32 num_kerning_pairs;
+	};
+
+	struct BinaryGlyph
+	{
+		UInt32 id;
+		UInt16 x;
+		UInt16 y;
+		UInt16 width;
+		UInt16 height;
+		Int16 x_offset;
+		Int16 y_offset;
+		Int16 x_advance;
+		UInt16 page;
+	};
+
+	static_assert(sizeof(BinaryFontHeader) == 28, "binary font header layout has changed");
+	static_assert(sizeof(BinaryGlyph) == 20, "binary font glyph layout has changed");
+
+	enum LineType
+	{
+		kLineOther,
+		kLineCommon,
+		kLineChars,
+		kLineChar,
+		kLineKernings,
+		kLineKerning
+	};
+
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline bool KeyEquals(const char* key, const char* key_end, const char* text)
+	{
+		const size_t length = strlen(text);
+		return (size_t)(key_end - key) == length && memcmp(key, text, length) == 0;
+	}
+
+	LineType GetLineType(const char* tag, const char* tag_end)
+	{
+		if (KeyEquals(tag, tag_end, "char"))
+			return kLineChar;
+		if (KeyEquals(tag, tag_end, "kerning"))
+			return kLineKerning;
+		if (KeyEquals(tag, tag_end, "common"))
+			return kLineCommon;
+		if (KeyEquals(tag, tag_end, "chars"))
+			return kLineChars;
+		if (KeyEquals(tag, tag_end, "kernings"))
+			return kLineKernings;
+		return kLineOther;
+	}
+
+	// finds the next key=value pair on a line, quoted values may contain spaces
+	bool NextKeyValue(const char*& cursor, const char* line_end, const char*& key, const char*& key_end, const char*& value, const char*& value_end)
+	{
+		while (cursor < line_end && IsSpace(*cursor))
+			++cursor;
+		if (cursor >= line_end)
+			return false;
+
+		key = cursor;
+		while (cursor < line_end && *cursor != '=' && !IsSpace(*cursor))
+			++cursor;
+		key_end = cursor;
+		if (cursor < line_end && *cursor == '=')
+			++cursor;
+
+		if (cursor < line_end && *cursor == '"')
+		{
+			value = ++cursor;
+			while (cursor < line_end && *cursor != '"')
+				++cursor;
+			value_end = cursor;
+			if (cursor < line_end)
+				++cursor;
+		}
+		else
+		{
+			value = cursor;
+			while (cursor < line_end && !IsSpace(*cursor))
+				++cursor;
+			value_end = cursor;
+		}
+		return true;
+	}
+
+	Int32 ParseInt(const char* text, const char* text_end)
+	{
+		bool negative = false;
+		if (text < text_end && *text == '-')
+		{
+			negative = true;
+			++text;
+		}
+
+		Int32 value = 0;
+		while (text < text_end && *text >= '0' && *text <= '9')
+			value = value * 10 + (*text++ - '0');
+		return negative ? -value : value;
+	}
+
+	template<typename KerningPairType>
+	void SortKerningPairs(std::vector<KerningPairType>& kerning_pairs)
+	{
+		auto less = [](const KerningPairType& a, const KerningPairType& b)
+		{
+			return a.First != b.First ? a.First < b.First : a.Second < b.Second;
+		};
+		if (!std::is_sorted(kerning_pairs.begin(), kerning_pairs.end(), less))
+			std::stable_sort(kerning_pairs.begin(), kerning_pairs.end(), less);
+	}
+
+	// a glyph ready to draw from a glyph record in pixels, inv_width and inv_height are the inverse page size
+	Font::Glyph MakeGlyph(Int32 x, Int32 y, Int32 width, Int32 height, Int32 x_offset, Int32 y_offset, Int32 x_advance, Int32 page, float inv_width, float inv_height)
+	{
+		Font::Glyph glyph;
+		glyph.uv_position = Vector2((float)x * inv_width, (float)y * inv_height);
+		glyph.uv_width = (float)width * inv_width;
+		glyph.uv_height = (float)height * inv_height;
+		glyph.width = (float)width;
+		glyph.height = (float)height;
+		glyph.offset_x = (float)x_offset;
+		glyph.offset_y = (float)y_offset;
+		glyph.advance = (float)x_advance;
+		glyph.page = (UInt32)page;
+		glyph.kerning_begin = 0;
+		glyph.kerning_count = 0;
+		return glyph;
+	}
+
+	bool ReadFileData(const char* filename, void*& data, Int32& size)
+	{
+		File* file = File::Create();
+		bool success = file->Open(filename);
+		if (success)
+		{
+			success = file->GetSize(size);
+			if (success)
+			{
+				data = malloc(size > 0 ? size : 1);
+				success = data != NULL;
+				if (success)
+				{
+					Int32 bytes_read;
+					success = file->Read(data, size, bytes_read) && bytes_read == size;
+				}
+			}
+			file->Close();
+		}
+		delete file;
+
+		if (!success)
+		{
+			free(data);
+			data = NULL;
+		}
+		return success;
+	}
+}
+
 Font::Font(Platform& platform) :
 font_texture_(NULL),
+	max_cached_layouts_(kDefaultMaxCachedLayouts),
+	glyph_atlas_(NULL),
 	platform_(platform)
 {
+	BuildGlyphTable();
 }
 
 Font::~Font()
 {
-	if(font_texture_)
+	ReleasePageTextures();
+}
+
+void Font::ReleasePageTextures()
+{
+	for (Texture* page_texture : page_textures_)
 	{
-		platform_.RemoveTexture(font_texture_);
-		delete font_texture_;
-		font_texture_ = NULL;
+		if(page_texture)
+		{
+			platform_.RemoveTexture(page_texture);
+			delete page_texture;
+		}
+	}
+	page_textures_.clear();
+	font_texture_ = NULL;
+}
+
+bool Font::Load(const char* font_name, bool load_page_textures)
+{
+	if(!LoadGlyphs(font_name))
+		return false;
+
+	ClearLayoutCache();
+
+	// pages are stored as font_name_0.png, font_name_1.png...
+	ReleasePageTextures();
+	if (!load_page_textures)
+		return true;
+	const UInt32 num_pages = character_set.Pages > 0 ? character_set.Pages : 1;
+	for (UInt32 page = 0; page < num_pages; ++page)
+	{
+		std::string font_texture_filename(font_name);
+		font_texture_filename += "_" + std::to_string(page) + ".png";
+		gef::ImageData image_data{ font_texture_filename.c_str() };
+		Texture* page_texture = NULL;
+		if (image_data.image())
+		{
+			page_texture = gef::Texture::Create(platform_, image_data);
+			platform_.AddTexture(page_texture);
+		}
+		page_textures_.push_back(page_texture);
 	}
+	font_texture_ = page_textures_[0];
+
+	return true;
 }
 
-bool Font::Load(const char* font_name)
+bool Font::LoadGlyphs(const char* font_name)
 {
-	std::string font_config_filename(font_name);
-	font_config_filename += ".fnt";
-	void* font_file_data = NULL;
+	std::string filename(font_name);
+	filename += ".fntb";
+	void* file_data = NULL;
 	Int32 file_size = 0;
-	gef::File* file = gef::File::Create();
-	
-	bool success = true;
-	success = file->Open(font_config_filename.c_str());
-	if(success)
+
+	bool success;
+	if(ReadFileData(filename.c_str(), file_data, file_size))
 	{
-		success = file->GetSize(file_size);
+		success = ReadBinaryFont(file_data, (UInt32)file_size);
+	}
+	else
+	{
+		filename.pop_back();
+		Charset charset;
+		success = ReadFileData(filename.c_str(), file_data, file_size) && ParseFont((const char*)file_data, (UInt32)file_size, charset);
 		if(success)
 		{
-			font_file_data = malloc(file_size);
-			success = font_file_data != NULL;
-			if(success)
+			character_set = std::move(charset);
+			BuildGlyphTable();
+		}
+	}
+
+	free(file_data);
+	return success;
+}
+
+bool Font::ConvertToBinary(const char* text_filename, const char* binary_filename)
+{
+	void* file_data = NULL;
+	Int32 file_size = 0;
+	Charset charset;
+	bool success = ReadFileData(text_filename, file_data, file_size) && ParseFont((const char*)file_data, (UInt32)file_size, charset);
+	free(file_data);
+	if(!success)
+		return false;
+
+	std::ofstream file_stream(binary_filename, std::ios::out | std::ios::binary);
+	if(!file_stream.is_open())
+		return false;
+
+	success = WriteBinaryFont(file_stream, charset);
+	file_stream.close();
+	return success;
+}
+
+bool Font::ParseFont( const char* data, UInt32 size, Font::Charset& CharsetDesc )
+{
+	const char* cursor = data;
+	const char* const data_end = data + size;
+	while( cursor < data_end )
+	{
+		const char* line_end = static_cast<const char*>(memchr(cursor, '\n', data_end - cursor));
+		if( line_end == NULL )
+			line_end = data_end;
+
+		//read the line's type
+		const char* tag_end = cursor;
+		while( tag_end < line_end && !IsSpace(*tag_end) )
+			++tag_end;
+		const LineType line_type = GetLineType(cursor, tag_end);
+		// the counts are only a hint, each char or kerning line after this one takes at least five bytes, so a bad count can not reserve more
+		const UInt32 max_lines_left = (UInt32)(data_end - line_end) / 5;
+
+		CharDescriptor char_desc;
+		KerningPair kerning_pair = { 0, 0, 0 };
+
+		const char* key;
+		const char* key_end;
+		const char* value;
+		const char* value_end;
+		const char* pair_cursor = tag_end;
+		while( line_type != kLineOther && NextKeyValue(pair_cursor, line_end, key, key_end, value, value_end) )
+		{
+			const Int32 number = ParseInt(value, value_end);
+			switch( line_type )
 			{
-				Int32 bytes_read;
-				success = file->Read(font_file_data, file_size, bytes_read);
-				if(success)
-					success = bytes_read == file_size;
+			case kLineCommon:
+				if( KeyEquals(key, key_end, "lineHeight") )
+					CharsetDesc.LineHeight = (UInt16)number;
+				else if( KeyEquals(key, key_end, "base") )
+					CharsetDesc.Base = (UInt16)number;
+				else if( KeyEquals(key, key_end, "scaleW") )
+					CharsetDesc.Width = (UInt16)number;
+				else if( KeyEquals(key, key_end, "scaleH") )
+					CharsetDesc.Height = (UInt16)number;
+				else if( KeyEquals(key, key_end, "pages") )
+					CharsetDesc.Pages = (UInt16)number;
+				break;
+			case kLineChars:
+				if( KeyEquals(key, key_end, "count") && number > 0 )
+					CharsetDesc.Chars.reserve(CharsetDesc.Chars.size() + std::min((UInt32)number, max_lines_left));
+				break;
+			case kLineChar:
+				if( KeyEquals(key, key_end, "id") )
+					char_desc.Id = (UInt32)number;
+				else if( KeyEquals(key, key_end, "x") )
+					char_desc.x = number;
+				else if( KeyEquals(key, key_end, "y") )
+					char_desc.y = number;
+				else if( KeyEquals(key, key_end, "width") )
+					char_desc.Width = number;
+				else if( KeyEquals(key, key_end, "height") )
+					char_desc.Height = number;
+				else if( KeyEquals(key, key_end, "xoffset") )
+					char_desc.XOffset = number;
+				else if( KeyEquals(key, key_end, "yoffset") )
+					char_desc.YOffset = number;
+				else if( KeyEquals(key, key_end, "xadvance") )
+					char_desc.XAdvance = number;
+				else if( KeyEquals(key, key_end, "page") )
+					char_desc.Page = number;
+				break;
+			case kLineKernings:
+				if( KeyEquals(key, key_end, "count") && number > 0 )
+					CharsetDesc.Kernings.reserve(CharsetDesc.Kernings.size() + std::min((UInt32)number, max_lines_left));
+				break;
+			case kLineKerning:
+				if( KeyEquals(key, key_end, "first") )
+					kerning_pair.First = (UInt32)number;
+				else if( KeyEquals(key, key_end, "second") )
+					kerning_pair.Second = (UInt32)number;
+				else if( KeyEquals(key, key_end, "amount") )
+					kerning_pair.Amount = number;
+				break;
+			default:
+				break;
 			}
 		}
-		file->Close();
-		delete file;
-		file = NULL;
+
+		if( line_type == kLineChar )
+			CharsetDesc.Chars.push_back(char_desc);
+		else if( line_type == kLineKerning && kerning_pair.Amount != 0 )
+			CharsetDesc.Kernings.push_back(kerning_pair);
+
+		cursor = line_end + 1;
 	}
 
+	SortKerningPairs(CharsetDesc.Kernings);
+	return true;
+}
+
+bool Font::ReadBinaryFont( const void* data, UInt32 size )
+{
+	const UInt8* bytes = static_cast<const UInt8*>(data);
+	if( size < sizeof(BinaryFontHeader) )
+		return false;
+	const BinaryFontHeader& header = *reinterpret_cast<const BinaryFontHeader*>(bytes);
+	if( header.file_id != kBinaryFontFileId || header.version != kBinaryFontVersion )
+		return false;
+
+	const UInt64 glyphs_size = (UInt64)header.num_glyphs * sizeof(BinaryGlyph);
+	const UInt64 kernings_size = (UInt64)header.num_kerning_pairs * sizeof(KerningPair);
+	if( sizeof(BinaryFontHeader) + glyphs_size + kernings_size > size )
+		return false;
 
+	character_set.LineHeight = header.line_height;
+	character_set.Base = header.base;
+	character_set.Width = header.width;
+	character_set.Height = header.height;
+	character_set.Pages = header.pages;
+	character_set.Chars.clear();
 
-	bool config_initialised = false;
+	// kerning pairs are stored in the same layout and order they are used in
+	const UInt8* glyph_data = bytes + sizeof(BinaryFontHeader);
+	const KerningPair* kerning_pairs = reinterpret_cast<const KerningPair*>(glyph_data + glyphs_size);
+	character_set.Kernings.assign(kerning_pairs, kerning_pairs + header.num_kerning_pairs);
+	SortKerningPairs(character_set.Kernings);
 
-	if(success)
+	// the glyph table is built straight from the records in the file data
+	const BinaryGlyph* glyphs = reinterpret_cast<const BinaryGlyph*>(glyph_data);
+	const float inv_width = header.width > 0 ? 1.0f / (float)header.width : 0.0f;
+	const float inv_height = header.height > 0 ? 1.0f / (float)header.height : 0.0f;
+	ResetGlyphTable(header.num_glyphs);
+	for( UInt32 glyph_num = 0; glyph_num < header.num_glyphs; ++glyph_num )
 	{
-		gef::MemoryStreamBuffer font_buffer((char*)font_file_data, file_size);
+		const BinaryGlyph& glyph = glyphs[glyph_num];
+		AddGlyph(glyph.id, MakeGlyph(glyph.x, glyph.y, glyph.width, glyph.height, glyph.x_offset, glyph.y_offset, glyph.x_advance, glyph.page, inv_width, inv_height));
+	}
+	SetGlyphKernings();
 
-		std::istream font_config_stream(&font_buffer);
-		config_initialised = ParseFont(font_config_stream, character_set);
+	return true;
+}
 
-		// don't need the font file data any more
-		free(font_file_data);
-		font_file_data = NULL;
+bool Font::WriteBinaryFont( std::ostream& stream, const Font::Charset& CharsetDesc )
+{
+	BinaryFontHeader header;
+	header.file_id = kBinaryFontFileId;
+	header.version = kBinaryFontVersion;
+	header.line_height = CharsetDesc.LineHeight;
+	header.base = CharsetDesc.Base;
+	header.width = CharsetDesc.Width;
+	header.height = CharsetDesc.Height;
+	header.pages = CharsetDesc.Pages;
+	header.padding = 0;
+	header.num_glyphs = (UInt32)CharsetDesc.Chars.size();
+	header.num_kerning_pairs = (UInt32)CharsetDesc.Kernings.size();
+	stream.write((const char*)&header, sizeof(BinaryFontHeader));
 
-		std::string font_texture_filename(font_name);
-		font_texture_filename += "_0.png";
-		gef::ImageData image_data{ font_texture_filename.c_str() };
-		font_texture_ = gef::Texture::Create(platform_, image_data);
-		platform_.AddTexture(font_texture_);
+	for( const CharDescriptor& char_desc : CharsetDesc.Chars )
+	{
+		BinaryGlyph glyph;
+		glyph.id = char_desc.Id;
+		glyph.x = (UInt16)char_desc.x;
+		glyph.y = (UInt16)char_desc.y;
+		glyph.width = (UInt16)char_desc.Width;
+		glyph.height = (UInt16)char_desc.Height;
+		glyph.x_offset = (Int16)char_desc.XOffset;
+		glyph.y_offset = (Int16)char_desc.YOffset;
+		glyph.x_advance = (Int16)char_desc.XAdvance;
+		glyph.page = (UInt16)char_desc.Page;
+		stream.write((const char*)&glyph, sizeof(BinaryGlyph));
 	}
 
-	return config_initialised;
+	if( !CharsetDesc.Kernings.empty() )
+		stream.write((const char*)CharsetDesc.Kernings.data(), CharsetDesc.Kernings.size() * sizeof(KerningPair));
+
+	return stream.good();
+}
+
+void Font::BuildGlyphTable()
+{
+	const float inv_width = character_set.Width > 0 ? 1.0f / (float)character_set.Width : 0.0f;
+	const float inv_height = character_set.Height > 0 ? 1.0f / (float)character_set.Height : 0.0f;
+	ResetGlyphTable((UInt32)character_set.Chars.size());
+	for (const CharDescriptor& desc : character_set.Chars)
+		AddGlyph(desc.Id, MakeGlyph(desc.x, desc.y, desc.Width, desc.Height, desc.XOffset, desc.YOffset, desc.XAdvance, desc.Page, inv_width, inv_height));
+	SetGlyphKernings();
+}
+
+void Font::ResetGlyphTable(UInt32 num_glyphs)
+{
+	glyphs_.clear();
+	glyphs_.reserve(num_glyphs + 1);
+	glyph_indices_.assign(kNumTableCharacters, 0);
+	extended_glyph_indices_.clear();
+
+	Glyph empty_glyph;
+	empty_glyph.uv_position = Vector2(0.0f, 0.0f);
+	empty_glyph.uv_width = empty_glyph.uv_height = 0.0f;
+	empty_glyph.width = empty_glyph.height = 0.0f;
+	empty_glyph.offset_x = empty_glyph.offset_y = 0.0f;
+	empty_glyph.advance = 0.0f;
+	empty_glyph.page = 0;
+	empty_glyph.kerning_begin = 0;
+	empty_glyph.kerning_count = 0;
+	glyphs_.push_back(empty_glyph);
 }
 
+void Font::AddGlyph(UInt32 character, const Glyph& glyph)
+{
+	const UInt32 glyph_index = (UInt32)glyphs_.size();
+	if (character < kNumTableCharacters && glyph_index <= 0xffff)
+		glyph_indices_[character] = (UInt16)glyph_index;
+	else
+		extended_glyph_indices_[character] = glyph_index;
+	glyphs_.push_back(glyph);
+}
 
-bool Font::ParseFont( std::istream& Stream, Font::Charset& CharsetDesc )
+void Font::SetGlyphKernings()
 {
-	std::string Line;
-	std::string Read, Key, Value;
-	std::size_t i;
-	while( !Stream.eof() )
+	// the pairs are sorted by first character, so each glyph's pairs are one range
+	const std::vector<KerningPair>& kernings = character_set.Kernings;
+	for (UInt32 pair_num = 0; pair_num < kernings.size(); )
 	{
-		std::stringstream LineStream;
-		std::getline( Stream, Line );
-		LineStream << Line;
+		UInt32 range_end = pair_num + 1;
+		while (range_end < kernings.size() && kernings[range_end].First == kernings[pair_num].First)
+			++range_end;
 
-		//read the line's type
-		LineStream >> Read;
-		if( Read == "common" )
+		const UInt32 glyph_index = FindGlyphIndex(kernings[pair_num].First);
+		if (glyph_index != 0)
 		{
-			//this holds common data
-			while( !LineStream.eof() )
-			{
-				std::stringstream Converter;
-				LineStream >> Read;
-				i = Read.find( '=' );
-				Key = Read.substr( 0, i );
-				Value = Read.substr( i + 1 );
-
-				//assign the correct value
-				Converter << Value;
-				if( Key == "lineHeight" )
-					Converter >> CharsetDesc.LineHeight;
-				else if( Key == "base" )
-					Converter >> CharsetDesc.Base;
-				else if( Key == "scaleW" )
-					Converter >> CharsetDesc.Width;
-				else if( Key == "scaleH" )
-					Converter >> CharsetDesc.Height;
-				else if( Key == "pages" )
-					Converter >> CharsetDesc.Pages;
-			}
+			glyphs_[glyph_index].kerning_begin = pair_num;
+			glyphs_[glyph_index].kerning_count = range_end - pair_num;
 		}
-		else if( Read == "char" )
-		{
-			//this is data for a specific char
-			UInt32 CharID = 0;
+		pair_num = range_end;
+	}
+}
 
-			while( !LineStream.eof() )
-			{
-				std::stringstream Converter;
-				LineStream >> Read;
-				i = Read.find( '=' );
-				Key = Read.substr( 0, i );
-				Value = Read.substr( i + 1 );
-
-				//assign the correct value
-				Converter << Value;
-				if( Key == "id" )
-					Converter >> CharID;
-				else if( Key == "x" )
-					Converter >> CharsetDesc.Chars[CharID].x;
-				else if( Key == "y" )
-					Converter >> CharsetDesc.Chars[CharID].y;
-				else if( Key == "width" )
-					Converter >> CharsetDesc.Chars[CharID].Width;
-				else if( Key == "height" )
-					Converter >> CharsetDesc.Chars[CharID].Height;
-				else if( Key == "xoffset" )
-					Converter >> CharsetDesc.Chars[CharID].XOffset;
-				else if( Key == "yoffset" )
-					Converter >> CharsetDesc.Chars[CharID].YOffset;
-				else if( Key == "xadvance" )
-					Converter >> CharsetDesc.Chars[CharID].XAdvance;
-				else if( Key == "page" )
-					Converter >> CharsetDesc.Chars[CharID].Page;
-			}
-		}
+UInt32 Font::FindGlyphIndex(UInt32 character) const
+{
+	if (character < kNumTableCharacters)
+	{
+		const UInt16 glyph_index = glyph_indices_[character];
+		if (glyph_index != 0 || extended_glyph_indices_.empty())
+			return glyph_index;
 	}
 
-	return true;
+	std::unordered_map<UInt32, UInt32>::const_iterator glyph_iter = extended_glyph_indices_.find(character);
+	return glyph_iter != extended_glyph_indices_.end() ? glyph_iter->second : 0;
 }
 
-void Font::RenderText(SpriteRenderer* renderer, const class Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, std::wstring& string) const
+const Font::Glyph& Font::GetGlyph(UInt32 character) const
 {
-	if(string.empty())
-		return;
+	return glyphs_[FindGlyphIndex(character)];
+}
 
-	UInt32 character_count = string.size();
-	float string_length = GetStringLength(string);
+float Font::GetKerning(UInt32 first, UInt32 second) const
+{
+	return GetKerning(GetGlyph(first), second);
+}
+
+float Font::GetKerning(const Glyph& first_glyph, UInt32 second) const
+{
+	if (first_glyph.kerning_count == 0)
+		return 0.0f;
+
+	const KerningPair* pairs_begin = &character_set.Kernings[first_glyph.kerning_begin];
+	const KerningPair* pairs_end = pairs_begin + first_glyph.kerning_count;
+	const KerningPair* pair = std::lower_bound(pairs_begin, pairs_end, second, [](const KerningPair& kerning_pair, UInt32 character)
+	{
+		return kerning_pair.Second < character;
+	});
+	return pair != pairs_end && pair->Second == second ? (float)pair->Amount : 0.0f;
+}
+
+const Font::TextLayout& Font::LayoutText(const std::wstring& text, const float scale, const TextJustification justification) const
+{
+	// FNV-1a of the characters, then the scale and justification
+	UInt64 key = 14695981039346656037ULL;
+	for (const wchar_t c : text)
+		key = (key ^ (UInt64)c) * 1099511628211ULL;
+	UInt32 scale_bits;
+	memcpy(&scale_bits, &scale, sizeof(float));
+	key = (key ^ scale_bits) * 1099511628211ULL;
+	key = (key ^ (UInt64)justification) * 1099511628211ULL;
+
+	std::unordered_map<UInt64, TextLayout>::iterator layout_iter = layout_cache_.find(key);
+	if (layout_iter != layout_cache_.end())
+	{
+		TextLayout& layout = layout_iter->second;
+		if (layout.scale == scale && layout.justification == justification && layout.text == text)
+		{
+			if (glyph_atlas_ == NULL)
+				return layout;
 
-	Vector2 cursor = Vector2(pos.x(), pos.y());
+			// a glyph moves if it is replaced in the atlas and added again, so the layout is only reused if none of its glyphs have been
+			bool glyphs_valid = layout.complete;
+			for (UInt32 glyph_num = 0; glyph_num < layout.atlas_glyphs.size() && glyphs_valid; ++glyph_num)
+				glyphs_valid = glyph_atlas_->Touch(layout.atlas_glyphs[glyph_num]);
+			if (glyphs_valid)
+				return layout;
+		}
+	}
+	else
+	{
+		if (layout_cache_.size() >= max_cached_layouts_)
+			layout_cache_.clear();
+		layout_iter = layout_cache_.insert(std::make_pair(key, TextLayout())).first;
+	}
+
+	// new string, a different string with the same hash which replaces the old one, or glyphs moved in the atlas
+	TextLayout& layout = layout_iter->second;
+	layout.text = text;
+	layout.scale = scale;
+	layout.justification = justification;
+	BuildLayout(layout);
 
-	switch(justification)
+	// glyphs added to the atlas are copied to its texture before anything can draw them
+	if (glyph_atlas_ != NULL)
+		glyph_atlas_->Upload();
+	return layout;
+}
+
+void Font::BuildLayout(TextLayout& layout) const
+{
+	const float scale = layout.scale;
+	layout.length = GetStringLength(layout.text);
+	layout.quads.clear();
+	layout.quads.reserve(layout.text.size());
+	layout.atlas_glyphs.clear();
+	layout.complete = true;
+
+	float cursor_x = 0.0f;
+	switch(layout.justification)
 	{
 	case TextJustification::TJ_CENTRE:
-		cursor.x -= string_length*0.5f*scale;
+		cursor_x -= layout.length*0.5f*scale;
 		break;
 	case TextJustification::TJ_RIGHT:
-		cursor.x -= string_length*scale;
+		cursor_x -= layout.length*scale;
 		break;
 	default:
 		break;
 	}
 
+	const Glyph* previous_glyph = &glyphs_[0];
+	for (const wchar_t c : layout.text)
+	{
+		const Glyph& glyph = GetGlyph(static_cast<UInt32>(c));
+		cursor_x += GetKerning(*previous_glyph, static_cast<UInt32>(c))*scale;
+		previous_glyph = &glyph;
+
+		// characters with no pixels, e.g. spaces, only move the pen
+		if (glyph.width > 0.0f && glyph.height > 0.0f)
+		{
+			GlyphQuad quad;
+			quad.width = glyph.width*scale;
+			quad.height = glyph.height*scale;
+			quad.x = cursor_x + glyph.offset_x*scale + quad.width*0.5f;
+			quad.y = scale*(glyph.height*0.5f + glyph.offset_y);
+			if (glyph_atlas_ == NULL)
+			{
+				quad.uv_position = glyph.uv_position;
+				quad.uv_width = glyph.uv_width;
+				quad.uv_height = glyph.uv_height;
+				quad.texture = page_texture(glyph.page);
+				layout.quads.push_back(quad);
+			}
+			else if (const GlyphAtlas::Entry* entry = glyph_atlas_->GetEntry(static_cast<UInt32>(c)))
+			{
+				quad.uv_position = entry->uv_position;
+				quad.uv_width = entry->uv_width;
+				quad.uv_height = entry->uv_height;
+				quad.texture = glyph_atlas_->texture();
+				layout.quads.push_back(quad);
+				layout.atlas_glyphs.push_back(entry->handle);
+			}
+			else
+			{
+				// every cell holds a glyph drawn this frame or the glyph is too big for a cell, it is left out
+				layout.complete = false;
+			}
+		}
+		cursor_x += glyph.advance*scale;
+	}
+}
+
+void Font::ClearLayoutCache()
+{
+	layout_cache_.clear();
+}
+
+void Font::RenderText(SpriteRenderer* renderer, const class Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, const std::wstring& string) const
+{
+	if(string.empty())
+		return;
+
+	const TextLayout& layout = LayoutText(string, scale, justification);
+
 	Sprite sprite;
-	sprite.set_texture(font_texture_);
-	for (const wchar_t c : string)
-	{
-		CharDescriptor desc = character_set.Chars.at(static_cast<UInt32>(c));
-		Int32 CharX = desc.x;
-		Int32 CharY = desc.y;
-		Int32 Width = desc.Width;
-		Int32 Height = desc.Height;
-		Int32 OffsetX = desc.XOffset;
-		Int32 OffsetY = desc.YOffset;
-
-		Vector2 uv_pos((float) CharX / (float) character_set.Width,  ((float) (CharY) / (float) character_set.Height));
-		Vector2 uv_size((float) (Width) / (float) character_set.Width, (float)(Height) / (float) character_set.Height);
-		Vector2 size(((float)Width)*scale, ((float)Height)*scale);
-		Vector4 sprite_position = Vector4(cursor.x+((float)OffsetX*scale)+size.x*0.5f, cursor.y + scale*((float)Height*0.5f +  (float)OffsetY), pos.z());
-
-		sprite.set_position(sprite_position);
-		sprite.set_width(size.x);
-		sprite.set_height(size.y);
-		sprite.set_uv_position(uv_pos);
-		sprite.set_uv_width(uv_size.x);
-		sprite.set_uv_height(uv_size.y);
-		sprite.set_colour(colour);
+	sprite.set_colour(colour);
+	for (const GlyphQuad& quad : layout.quads)
+	{
+		sprite.set_texture(quad.texture);
+		sprite.set_position(pos.x() + quad.x, pos.y() + quad.y, pos.z());
+		sprite.set_width(quad.width);
+		sprite.set_height(quad.height);
+		sprite.set_uv_position(quad.uv_position);
+		sprite.set_uv_width(quad.uv_width);
+		sprite.set_uv_height(quad.uv_height);
 		renderer->DrawSprite(sprite);
-		cursor.x += ((float)desc.XAdvance)*scale;
 	}
 }
 
-float Font::GetStringLength(std::wstring& text) const
+float Font::GetStringLength(const std::wstring& text) const
 {
 	float length = 0.0f;
+	const Glyph* previous_glyph = &glyphs_[0];
 	for(const wchar_t c : text){
-		length += ((float)character_set.Chars.at(static_cast<UInt32>(c)).XAdvance);
+		const Glyph& glyph = GetGlyph(static_cast<UInt32>(c));
+		length += GetKerning(*previous_glyph, static_cast<UInt32>(c)) + glyph.advance;
+		previous_glyph = &glyph;
 	}
 	return length;
 }
@@ -234,4 +732,4 @@ float Font::GetStringLength(std::wstring& text) const
 float Font::GetLineHeight() const {
 	return character_set.LineHeight;
 }
-}
+}
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define _GEF_FONT_H
 
 #include <gef.h>
-#include <istream>
+#include <maths/vector2.h>
+#include <ostream>
 #include <unordered_map>
+#include <vector>
 #include <string>
 
 namespace gef
@@ -13,6 +15,7 @@ namespace gef
 	class Texture;
 	class Platform;
 	class Vector4;
+	class GlyphAtlas;
 
 	enum class TextJustification
 	{
@@ -24,41 +27,183 @@ namespace gef
 	class Font
 	{
 	public:
+		/// @brief A character ready to draw, with the texture coordinates and sizes precalculated.
+		struct Glyph
+		{
+			Vector2 uv_position;
+			float uv_width;
+			float uv_height;
+			/// Size in pixels.
+			float width;
+			float height;
+			/// Offset of the top left corner from the pen position, in pixels.
+			float offset_x;
+			float offset_y;
+			/// Distance the pen moves after the character, in pixels.
+			float advance;
+			UInt32 page;
+			/// Range of the kerning pairs that have this glyph as the first character.
+			UInt32 kerning_begin;
+			UInt32 kerning_count;
+		};
+
+		/// @brief A glyph placed relative to the pen position a string starts at, scaled and justified.
+		struct GlyphQuad
+		{
+			/// Centre of the quad.
+			float x;
+			float y;
+			float width;
+			float height;
+			Vector2 uv_position;
+			float uv_width;
+			float uv_height;
+			/// A page texture of the font, or the texture of its glyph atlas.
+			const Texture* texture;
+		};
+
+		/// @brief The glyph quads of a string.
+		struct TextLayout
+		{
+			std::wstring text;
+			float scale;
+			TextJustification justification;
+			std::vector<GlyphQuad> quads;
+			/// Unscaled length of the string, as GetStringLength.
+			float length;
+			/// Glyph atlas handles of the glyphs of the quads, the layout is built again if any stop being valid.
+			std::vector<UInt64> atlas_glyphs;
+			/// false if some glyphs were left out because the glyph atlas was full, so the layout is built again next time.
+			bool complete;
+		};
+
+		/// @brief The number of layouts kept by default before the layout cache is cleared.
+		static const UInt32 kDefaultMaxCachedLayouts = 256;
+
 		Font(Platform& platform);
 		~Font();
-		bool Load(const char* font_name);
-		void RenderText(SpriteRenderer* renderer, const Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, std::wstring&) const;
-		float GetStringLength(std::wstring&) const;
+		/// @brief Loads font_name.fntb if it exists, otherwise the BMFont text file font_name.fnt,
+		/// then the page images font_name_0.png, font_name_1.png...
+		/// @param[in] load_page_textures	false to load no page textures, for fonts drawn through a GlyphAtlas.
+		bool Load(const char* font_name, bool load_page_textures = true);
+		void RenderText(SpriteRenderer* renderer, const Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, const std::wstring&) const;
+		float GetStringLength(const std::wstring&) const;
 		float GetLineHeight() const;
 		inline Texture* font_texture() { return font_texture_; }
+		/// @brief Gets the texture of a font page. Glyph::page is the page a glyph is on.
+		/// @return The texture, or NULL if the page does not exist or its image could not be loaded.
+		inline Texture* page_texture(UInt32 page) const { return page < page_textures_.size() ? page_textures_[page] : NULL; }
+		inline UInt32 num_pages() const { return (UInt32)page_textures_.size(); }
+
+		/// @brief Finds the glyph of a character.
+		/// Characters in the basic multilingual plane are found with one table lookup.
+		/// @return The glyph, or an empty glyph with no size or advance if the font does not have the character.
+		const Glyph& GetGlyph(UInt32 character) const;
+
+		/// @brief Gets the kerning between two characters.
+		/// @return The distance in pixels to move the second character, usually negative, 0 if the pair has no kerning.
+		float GetKerning(UInt32 first, UInt32 second) const;
+
+		/// @brief Converts a BMFont text file to the binary font format Load reads first.
+		/// Needs no platform, so fonts can be converted offline.
+		static bool ConvertToBinary(const char* text_filename, const char* binary_filename);
+
+		/// @brief Gets the glyph quads of a string, laying it out if it is not in the layout cache.
+		/// Strings that are drawn every frame are only laid out once.
+		/// The cache is not thread safe, lay out text on one thread at a time.
+		/// @return The layout, valid until the cache is cleared or another string is laid out.
+		const TextLayout& LayoutText(const std::wstring& text, const float scale, const TextJustification justification) const;
+
+		/// @brief Removes all layouts from the layout cache.
+		void ClearLayoutCache();
+		/// @brief Sets the number of layouts kept. The cache is cleared when it is full.
+		inline void set_max_cached_layouts(UInt32 max_cached_layouts) { max_cached_layouts_ = max_cached_layouts; }
+		inline UInt32 max_cached_layouts() const { return max_cached_layouts_; }
+		inline UInt32 num_cached_layouts() const { return (UInt32)layout_cache_.size(); }
+
+		/// @brief Draws the glyphs from a glyph atlas instead of the page textures, adding them to it as they are laid out.
+		/// The atlas is not owned and can be shared by fonts with the same glyphs. NULL to use the page textures again.
+		inline void set_glyph_atlas(GlyphAtlas* glyph_atlas) { glyph_atlas_ = glyph_atlas; ClearLayoutCache(); }
+		inline GlyphAtlas* glyph_atlas() const { return glyph_atlas_; }
+
 	protected:
 		struct CharDescriptor
 		{
-			//clean 16 bytes
+			UInt32 Id;
 			Int32 x, y;
 			Int32 Width, Height;
 			Int32 XOffset, YOffset;
 			Int32 XAdvance;
 			Int32 Page;
 
-			CharDescriptor() : x( 0 ), y( 0 ), Width( 0 ), Height( 0 ), XOffset( 0 ), YOffset( 0 ),
+			CharDescriptor() : Id( 0 ), x( 0 ), y( 0 ), Width( 0 ), Height( 0 ), XOffset( 0 ), YOffset( 0 ),
 				XAdvance( 0 ), Page( 0 )
 			{ }
 		};
 
+		struct KerningPair
+		{
+			UInt32 First;
+			UInt32 Second;
+			Int32 Amount;
+		};
+
 		struct Charset
 		{
 			UInt16 LineHeight;
 			UInt16 Base;
 			UInt16 Width, Height;
 			UInt16 Pages;
-			std::unordered_map<UInt32, CharDescriptor> Chars;
+			std::vector<CharDescriptor> Chars;
+			/// Sorted by first then second character.
+			std::vector<KerningPair> Kernings;
+
+			Charset() : LineHeight( 0 ), Base( 0 ), Width( 0 ), Height( 0 ), Pages( 0 )
+			{ }
 		};
 
-		bool ParseFont( std::istream& Stream, Font::Charset& CharsetDesc );
+		/// @brief Parses a BMFont text file in place, without allocating per line or per value.
+		static bool ParseFont( const char* data, UInt32 size, Font::Charset& CharsetDesc );
+		/// @brief Reads a binary font, building the glyph table straight from the glyph records in the data.
+		/// Only the kerning pairs are copied. The font is unchanged if the data is not a binary font.
+		/// @param[in] data	The file data, four byte aligned, e.g. as returned by malloc.
+		bool ReadBinaryFont( const void* data, UInt32 size );
+		static bool WriteBinaryFont( std::ostream& stream, const Font::Charset& CharsetDesc );
+		// reads font_name.fntb into the glyph table, or font_name.fnt if there is no binary font
+		bool LoadGlyphs( const char* font_name );
+
+		void ReleasePageTextures();
+		// builds the glyph table from the characters of a parsed text font
+		void BuildGlyphTable();
+		// clears the glyph table, leaving the empty glyph and room for num_glyphs more
+		void ResetGlyphTable(UInt32 num_glyphs);
+		void AddGlyph(UInt32 character, const Glyph& glyph);
+		// sets the kerning range of each glyph from the sorted kerning pairs
+		void SetGlyphKernings();
+		void BuildLayout(TextLayout& layout) const;
+		float GetKerning(const Glyph& first_glyph, UInt32 second) const;
+		// index in glyphs_ of a character, 0 if the font does not have it
+		UInt32 FindGlyphIndex(UInt32 character) const;
+
+		/// The number of characters in the basic multilingual plane, all of which are in the glyph index table.
+		static const UInt32 kNumTableCharacters = 0x10000;
 
 		Charset character_set;
 		class Texture* font_texture_;
+		// one texture per page, font_texture_ is page 0
+		std::vector<Texture*> page_textures_;
+
+		// glyph 0 is the empty glyph, used for characters the font does not have
+		std::vector<Glyph> glyphs_;
+		// glyph index of every character in the basic multilingual plane
+		std::vector<UInt16> glyph_indices_;
+		// glyph indices of characters outside the basic multilingual plane
+		std::unordered_map<UInt32, UInt32> extended_glyph_indices_;
+
+		// layouts keyed by a hash of their text, scale and justification
+		mutable std::unordered_map<UInt64, TextLayout> layout_cache_;
+		UInt32 max_cached_layouts_;
+		GlyphAtlas* glyph_atlas_;
 
 		Platform& platform_;
 	};
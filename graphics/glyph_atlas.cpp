@@ -0,0 +1,208 @@
+#include <graphics/glyph_atlas.h>
+#include <graphics/texture.h>
+#include <graphics/image_data.h>
+#include <algorithm>
+#include <cstring>
+
+namespace gef
+{
+	namespace
+	{
+		const UInt32 kBytesPerPixel = 4;
+	}
+
+	GlyphAtlas::GlyphAtlas(Platform& platform, GlyphSource& source, UInt32 width, UInt32 height, UInt32 cell_width, UInt32 cell_height) :
+		platform_(platform),
+		source_(source),
+		texture_(NULL),
+		width_(width),
+		height_(height),
+		cell_width_(cell_width),
+		cell_height_(cell_height),
+		cells_per_row_(cell_width > 0 ? width / cell_width : 0),
+		lru_front_(kNoSlot),
+		lru_back_(kNoSlot),
+		frame_(1)
+	{
+		pixels_.resize(width_ * height_ * kBytesPerPixel, 0);
+
+		// the texture makes its own copy of the image, so the image is not handed over
+		ImageData image_data;
+		image_data.set_image(pixels_.data());
+		image_data.set_width(width_);
+		image_data.set_height(height_);
+		texture_ = Texture::Create(platform_, image_data);
+		image_data.set_image(NULL);
+
+		const UInt32 num_rows = cell_height > 0 ? height / cell_height : 0;
+		Slot empty_slot = {};
+		slots_.resize(cells_per_row_ * num_rows, empty_slot);
+		dirty_begin_.resize(num_rows, 0);
+		dirty_end_.resize(num_rows, 0);
+		Clear();
+	}
+
+	GlyphAtlas::~GlyphAtlas()
+	{
+		delete texture_;
+	}
+
+	void GlyphAtlas::Clear()
+	{
+		const UInt32 num_slots = (UInt32)slots_.size();
+		for (UInt32 slot_num = 0; slot_num < num_slots; ++slot_num)
+		{
+			Slot& slot = slots_[slot_num];
+			slot.entry.uv_position = Vector2(
+				(float)((slot_num % cells_per_row_) * cell_width_) / (float)width_,
+				(float)((slot_num / cells_per_row_) * cell_height_) / (float)height_);
+			slot.entry.uv_width = 0.0f;
+			slot.entry.uv_height = 0.0f;
+			slot.character = 0;
+			slot.last_used_frame = 0;
+			// removed glyphs stay in the texture until their cells are used again, nothing draws them
+			if (slot.in_use)
+				++slot.generation;
+			slot.entry.handle = MakeHandle(slot_num, slot.generation);
+			slot.in_use = false;
+			slot.previous = slot_num > 0 ? slot_num - 1 : kNoSlot;
+			slot.next = slot_num + 1 < num_slots ? slot_num + 1 : kNoSlot;
+		}
+		lru_front_ = num_slots > 0 ? 0 : kNoSlot;
+		lru_back_ = num_slots > 0 ? num_slots - 1 : kNoSlot;
+		slot_indices_.clear();
+	}
+
+	void GlyphAtlas::MoveToFront(UInt32 slot_num)
+	{
+		if (slot_num == lru_front_)
+			return;
+
+		Slot& slot = slots_[slot_num];
+		slots_[slot.previous].next = slot.next;
+		if (slot.next != kNoSlot)
+			slots_[slot.next].previous = slot.previous;
+		else
+			lru_back_ = slot.previous;
+
+		slot.previous = kNoSlot;
+		slot.next = lru_front_;
+		slots_[lru_front_].previous = slot_num;
+		lru_front_ = slot_num;
+	}
+
+	const GlyphAtlas::Entry* GlyphAtlas::GetEntry(UInt32 character)
+	{
+		std::unordered_map<UInt32, UInt32>::const_iterator slot_iter = slot_indices_.find(character);
+		if (slot_iter != slot_indices_.end())
+		{
+			TouchSlot(slot_iter->second);
+			return &slots_[slot_iter->second].entry;
+		}
+
+		// the back of the list is an unused cell or the glyph drawn longest ago
+		if (lru_back_ == kNoSlot)
+			return NULL;
+		const UInt32 slot_num = lru_back_;
+		Slot& slot = slots_[slot_num];
+		if (slot.in_use && slot.last_used_frame == frame_)
+			return NULL;
+
+		GlyphSource::Bitmap bitmap;
+		if (!source_.GetBitmap(character, bitmap) || bitmap.width >= cell_width_ || bitmap.height >= cell_height_)
+			return NULL;
+
+		// only layouts that used the replaced glyph have to be built again
+		if (slot.in_use)
+		{
+			slot_indices_.erase(slot.character);
+			++slot.generation;
+			slot.entry.handle = MakeHandle(slot_num, slot.generation);
+		}
+		slot.character = character;
+		slot.in_use = true;
+		slot_indices_[character] = slot_num;
+		CopyGlyph(slot_num, bitmap);
+		TouchSlot(slot_num);
+		return &slot.entry;
+	}
+
+	void GlyphAtlas::CopyGlyph(UInt32 slot_num, const GlyphSource::Bitmap& bitmap)
+	{
+		Slot& slot = slots_[slot_num];
+		slot.entry.uv_width = (float)bitmap.width / (float)width_;
+		slot.entry.uv_height = (float)bitmap.height / (float)height_;
+
+		const UInt32 cell_x = (slot_num % cells_per_row_) * cell_width_;
+		const UInt32 cell_y = (slot_num / cells_per_row_) * cell_height_;
+		const UInt32 pitch = width_ * kBytesPerPixel;
+		const UInt32 glyph_row_size = bitmap.width * kBytesPerPixel;
+		const UInt32 padding_size = (cell_width_ - bitmap.width) * kBytesPerPixel;
+
+		// the whole cell is written, so nothing of a larger glyph it held before is left around the new one
+		for (UInt32 row = 0; row < cell_height_; ++row)
+		{
+			UInt8* cell_row = &pixels_[(cell_y + row) * pitch + cell_x * kBytesPerPixel];
+			if (row >= bitmap.height)
+			{
+				memset(cell_row, 0, cell_width_ * kBytesPerPixel);
+				continue;
+			}
+
+			const UInt8* glyph_row = bitmap.pixels + row * bitmap.row_pitch;
+			if (bitmap.format == GlyphSource::kRGBA)
+			{
+				memcpy(cell_row, glyph_row, glyph_row_size);
+			}
+			else
+			{
+				for (UInt32 column = 0; column < bitmap.width; ++column)
+				{
+					cell_row[column * kBytesPerPixel + 0] = 255;
+					cell_row[column * kBytesPerPixel + 1] = 255;
+					cell_row[column * kBytesPerPixel + 2] = 255;
+					cell_row[column * kBytesPerPixel + 3] = glyph_row[column];
+				}
+			}
+			memset(cell_row + glyph_row_size, 0, padding_size);
+		}
+
+		MarkDirty(slot_num);
+	}
+
+	void GlyphAtlas::MarkDirty(UInt32 slot_num)
+	{
+		const UInt32 row = slot_num / cells_per_row_;
+		const UInt32 column = slot_num % cells_per_row_;
+		if (dirty_begin_[row] == dirty_end_[row])
+		{
+			dirty_begin_[row] = column;
+			dirty_end_[row] = column + 1;
+		}
+		else
+		{
+			dirty_begin_[row] = std::min(dirty_begin_[row], column);
+			dirty_end_[row] = std::max(dirty_end_[row], column + 1);
+		}
+	}
+
+	bool GlyphAtlas::Upload()
+	{
+		// one update per row of cells, covering the changed cells of the row
+		bool success = true;
+		const UInt32 pitch = width_ * kBytesPerPixel;
+		for (UInt32 row = 0; row < (UInt32)dirty_begin_.size(); ++row)
+		{
+			if (dirty_begin_[row] == dirty_end_[row])
+				continue;
+
+			const UInt32 x = dirty_begin_[row] * cell_width_;
+			const UInt32 y = row * cell_height_;
+			const UInt32 width = (dirty_end_[row] - dirty_begin_[row]) * cell_width_;
+			if (texture_ == NULL || !texture_->Update(platform_, x, y, width, cell_height_, &pixels_[y * pitch + x * kBytesPerPixel], pitch))
+				success = false;
+			dirty_begin_[row] = dirty_end_[row] = 0;
+		}
+		return success;
+	}
+}
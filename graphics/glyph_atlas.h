@@ -0,0 +1,147 @@
+#ifndef _GEF_GLYPH_ATLAS_H
+#define _GEF_GLYPH_ATLAS_H
+
+#include <gef.h>
+#include <graphics/glyph_source.h>
+#include <maths/vector2.h>
+#include <unordered_map>
+#include <vector>
+
+namespace gef
+{
+	class Platform;
+	class Texture;
+
+	/**
+	A texture that glyphs are added to when they are drawn, for fonts with too many glyphs to keep
+	every page as a texture, e.g. CJK fonts.
+	The texture is split into cells of the same size, one glyph per cell. When every cell is in use,
+	the glyph that has gone longest without being drawn is replaced, so memory stays at the size of the atlas
+	and only the characters that are actually displayed are loaded.
+	Glyphs drawn in the current frame are never replaced. If a frame needs more glyphs than there are cells,
+	the extra glyphs are not drawn until a later frame has room for them.
+	Added glyphs are copied to a CPU image, and only the changed cells of it are copied to the texture.
+	Set the atlas on a Font with Font::set_glyph_atlas.
+	*/
+	class GlyphAtlas
+	{
+	public:
+		/// @brief Where a glyph is in the atlas texture.
+		struct Entry
+		{
+			Vector2 uv_position;
+			float uv_width;
+			float uv_height;
+			/// Identifies the glyph in its cell, for Touch. Stops being valid when the glyph is replaced or removed.
+			UInt64 handle;
+		};
+
+		static const UInt32 kDefaultSize = 1024;
+		static const UInt32 kDefaultCellSize = 32;
+
+		/// @param[in] source						Provides the pixels of glyphs. Must outlive the atlas.
+		/// @param[in] width, height				Size of the atlas texture in pixels.
+		/// @param[in] cell_width, cell_height		Size of a cell in pixels. A glyph must be at least one pixel
+		///											smaller than a cell in each direction, the spare pixels stop filtering
+		///											blending neighbouring glyphs.
+		GlyphAtlas(Platform& platform, GlyphSource& source, UInt32 width = kDefaultSize, UInt32 height = kDefaultSize,
+			UInt32 cell_width = kDefaultCellSize, UInt32 cell_height = kDefaultCellSize);
+		~GlyphAtlas();
+		// the texture and the map from characters to cells are owned
+		GlyphAtlas(const GlyphAtlas&) = delete;
+		GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+		/// @brief Finds the glyph of a character, adding it to the atlas if it is not in it, and marks it as drawn this frame.
+		/// @return The entry, or NULL if the source has no pixels for the character, the glyph does not fit
+		/// in a cell, or every cell holds a glyph drawn this frame.
+		const Entry* GetEntry(UInt32 character);
+
+		/// @brief Marks a glyph as drawn this frame, without looking up its character.
+		/// @param[in] handle	The handle of an entry got from GetEntry.
+		/// @return false if the glyph has been replaced or removed since, so the entry may have moved.
+		inline bool Touch(UInt64 handle)
+		{
+			const UInt32 slot = (UInt32)handle;
+			if (slot >= slots_.size() || slots_[slot].generation != (UInt32)(handle >> 32))
+				return false;
+			TouchSlot(slot);
+			return true;
+		}
+
+		/// @brief Copies the cells changed since the last upload to the texture.
+		/// Font::LayoutText uploads after laying out text, so glyphs are in the texture before they are drawn.
+		/// @return false if the texture could not be updated.
+		bool Upload();
+
+		/// @brief Starts a new frame. Call once per frame, before any text is laid out.
+		/// Glyphs not drawn since can then be replaced.
+		inline void NextFrame() { ++frame_; }
+
+		/// @brief Removes every glyph.
+		void Clear();
+
+		inline const Texture* texture() const { return texture_; }
+		inline UInt32 num_slots() const { return (UInt32)slots_.size(); }
+		inline UInt32 num_glyphs() const { return (UInt32)slot_indices_.size(); }
+		inline UInt32 width() const { return width_; }
+		inline UInt32 height() const { return height_; }
+
+	private:
+		static const UInt32 kNoSlot = 0xFFFFFFFF;
+
+		struct Slot
+		{
+			Entry entry;
+			UInt32 character;
+			UInt32 last_used_frame;
+			// changes every time the glyph in the cell is replaced or removed, so old handles to the cell stop being valid
+			UInt32 generation;
+			bool in_use;
+			// neighbours in the least recently used list
+			UInt32 previous;
+			UInt32 next;
+		};
+
+		static UInt64 MakeHandle(UInt32 slot, UInt32 generation) { return ((UInt64)generation << 32) | slot; }
+
+		inline void TouchSlot(UInt32 slot)
+		{
+			if (slots_[slot].last_used_frame != frame_)
+			{
+				slots_[slot].last_used_frame = frame_;
+				MoveToFront(slot);
+			}
+		}
+		// moves a cell to the front of the least recently used list
+		void MoveToFront(UInt32 slot);
+		// copies a glyph into a cell of the atlas image and marks the cell as changed
+		void CopyGlyph(UInt32 slot, const GlyphSource::Bitmap& bitmap);
+		void MarkDirty(UInt32 slot);
+
+		Platform& platform_;
+		GlyphSource& source_;
+		Texture* texture_;
+
+		UInt32 width_;
+		UInt32 height_;
+		UInt32 cell_width_;
+		UInt32 cell_height_;
+		UInt32 cells_per_row_;
+
+		std::vector<Slot> slots_;
+		// the most recently drawn cell is at the front, the next to be replaced at the back
+		UInt32 lru_front_;
+		UInt32 lru_back_;
+		std::unordered_map<UInt32, UInt32> slot_indices_;
+
+		// copy of the texture, four bytes per pixel
+		std::vector<UInt8> pixels_;
+		// changed columns of each row of cells, from dirty_begin_ up to dirty_end_, empty when they are equal
+		std::vector<UInt32> dirty_begin_;
+		std::vector<UInt32> dirty_end_;
+
+		UInt32 frame_;
+	};
+}
+
+#endif // _GEF_GLYPH_ATLAS_H
@@ -0,0 +1,64 @@
+#include <graphics/glyph_source.h>
+#include <graphics/font.h>
+#include <graphics/image_data.h>
+
+namespace gef
+{
+	FontPageGlyphSource::FontPageGlyphSource(const Font& font, const char* font_name) :
+		font_(font),
+		font_name_(font_name),
+		num_loaded_pages_(0)
+	{
+	}
+
+	FontPageGlyphSource::~FontPageGlyphSource()
+	{
+	}
+
+	const ImageData* FontPageGlyphSource::GetPage(UInt32 page)
+	{
+		if (page >= pages_.size())
+			pages_.resize(page + 1);
+
+		// a page that failed to load is kept with no image, so it is only tried once
+		if (!pages_[page])
+		{
+			const std::string page_filename = font_name_ + "_" + std::to_string(page) + ".png";
+			pages_[page].reset(new ImageData(page_filename.c_str()));
+			++num_loaded_pages_;
+		}
+		return pages_[page]->image() != NULL ? pages_[page].get() : NULL;
+	}
+
+	bool FontPageGlyphSource::GetBitmap(UInt32 character, Bitmap& bitmap)
+	{
+		const Font::Glyph& glyph = font_.GetGlyph(character);
+		if (glyph.width <= 0.0f || glyph.height <= 0.0f)
+			return false;
+
+		const ImageData* page = GetPage(glyph.page);
+		if (page == NULL)
+			return false;
+
+		// the glyph uvs are relative to the page size, so they give back the pixel rectangle
+		const UInt32 x = (UInt32)(glyph.uv_position.x * (float)page->width() + 0.5f);
+		const UInt32 y = (UInt32)(glyph.uv_position.y * (float)page->height() + 0.5f);
+		const UInt32 width = (UInt32)glyph.width;
+		const UInt32 height = (UInt32)glyph.height;
+		if (x + width > page->width() || y + height > page->height())
+			return false;
+
+		bitmap.width = width;
+		bitmap.height = height;
+		bitmap.row_pitch = page->width() * 4;
+		bitmap.pixels = page->image() + y * bitmap.row_pitch + x * 4;
+		bitmap.format = kRGBA;
+		return true;
+	}
+
+	void FontPageGlyphSource::ReleasePages()
+	{
+		pages_.clear();
+		num_loaded_pages_ = 0;
+	}
+}
@@ -0,0 +1,80 @@
+#ifndef _GEF_GLYPH_SOURCE_H
+#define _GEF_GLYPH_SOURCE_H
+
+#include <gef.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gef
+{
+	class Font;
+	class ImageData;
+
+	/**
+	Provides the pixels of glyphs to a GlyphAtlas when they are first drawn.
+	Implement it to rasterize glyphs with a font engine, or use FontPageGlyphSource
+	to copy them from the page images of a BMFont font.
+	*/
+	class GlyphSource
+	{
+	public:
+		enum PixelFormat
+		{
+			/// Four bytes per pixel, red, green, blue then alpha.
+			kRGBA,
+			/// One byte per pixel, the coverage of the glyph. Drawn as white with the coverage as alpha.
+			kAlpha
+		};
+
+		/// @brief The pixels of one glyph. Only need to stay valid until GetBitmap is called again.
+		struct Bitmap
+		{
+			UInt32 width;
+			UInt32 height;
+			const UInt8* pixels;
+			/// Bytes from one row of pixels to the next.
+			UInt32 row_pitch;
+			PixelFormat format;
+		};
+
+		virtual ~GlyphSource() {}
+
+		/// @brief Gets the pixels of the glyph of a character.
+		/// @return false if there is no glyph with pixels for the character.
+		virtual bool GetBitmap(UInt32 character, Bitmap& bitmap) = 0;
+	};
+
+	/**
+	Copies glyphs out of the page images of a font, for fonts with more pages than should be kept as textures.
+	Load the font without its page textures, and set a GlyphAtlas that uses this source on it.
+	A page image is only loaded when a glyph on it is first needed.
+	*/
+	class FontPageGlyphSource : public GlyphSource
+	{
+	public:
+		/// @param[in] font			The font the glyphs are from. Must stay loaded while the source is used.
+		/// @param[in] font_name	The name the font was loaded with, the pages are font_name_0.png, font_name_1.png...
+		FontPageGlyphSource(const Font& font, const char* font_name);
+		~FontPageGlyphSource();
+
+		bool GetBitmap(UInt32 character, Bitmap& bitmap);
+
+		/// @brief Releases the page images that have been loaded, they are loaded again when needed.
+		/// Once the glyphs that are drawn are all in the atlas, the pages are not needed.
+		void ReleasePages();
+
+		inline UInt32 num_loaded_pages() const { return num_loaded_pages_; }
+
+	private:
+		const ImageData* GetPage(UInt32 page);
+
+		const Font& font_;
+		std::string font_name_;
+		// pages that have been loaded, NULL for pages that have not been needed yet
+		std::vector<std::unique_ptr<ImageData>> pages_;
+		UInt32 num_loaded_pages_;
+	};
+}
+
+#endif // _GEF_GLYPH_SOURCE_H
@@ -0,0 +1,134 @@
+#include <graphics/light_block.h>
+#include <graphics/light_data.h>
+#include <graphics/light_clusters.h>
+#include <cstring>
+
+namespace gef
+{
+	namespace
+	{
+		// cluster params with clustering disabled, the shader considers every light
+		const LightClusters::Params kNoClusters =
+		{
+			{ LightClusters::kNumClustersX, LightClusters::kNumClustersY, LightClusters::kNumClustersZ, 0 },
+			0.0f, 0.0f, 0.0f, 0.0f
+		};
+	}
+
+	LightBlock::LightBlock() :
+		viewer_position_variable_index_{0},
+		ambient_light_colour_variable_index_{0},
+		light_data_variable_index_{0},
+		cluster_params_variable_index_{0},
+		cluster_depth_params_variable_index_{0},
+		cluster_ranges_variable_index_{0},
+		cluster_light_indices_variable_index_{0},
+		scene_light_data_(NULL),
+		scene_light_data_version_(0),
+		light_data_(NULL),
+		light_data_version_(0),
+		terminator_index_(MAX_LIGHTS),
+		light_clusters_(NULL),
+		light_clusters_version_(0),
+		clusters_enabled_(false),
+		scene_data_valid_(false)
+	{
+	}
+
+	void LightBlock::AddVariables(ShaderInterface& device_interface)
+	{
+		viewer_position_variable_index_ = device_interface.AddLightShaderVariable("viewer_position", ShaderInterface::kVector4);
+		ambient_light_colour_variable_index_ = device_interface.AddLightShaderVariable("ambient_light_colour", ShaderInterface::kVector4);
+		light_data_variable_index_ = device_interface.AddLightShaderVariable("lights", ShaderInterface::kLightData, MAX_LIGHTS);
+		cluster_params_variable_index_ = device_interface.AddLightShaderVariable("cluster_params", ShaderInterface::kUInt4);
+		cluster_depth_params_variable_index_ = device_interface.AddLightShaderVariable("cluster_depth_params", ShaderInterface::kVector4);
+		cluster_ranges_variable_index_ = device_interface.AddLightShaderVariable("cluster_ranges", ShaderInterface::kUInt4, LightClusters::kNumClusters / 4);
+		cluster_light_indices_variable_index_ = device_interface.AddLightShaderVariable("cluster_light_indices", ShaderInterface::kUInt4, LightClusters::kMaxLightIndices / 8);
+	}
+
+	void LightBlock::SetSceneData(ShaderInterface& device_interface, const LightData& light_data, const LightClusters* light_clusters, const Matrix44& view_matrix, const Matrix44& projection_matrix)
+	{
+		// the light block is per frame data, only update it when the camera or lights have changed
+		const bool camera_changed = !scene_data_valid_ || memcmp(&view_matrix, &view_matrix_, sizeof(Matrix44)) != 0 || memcmp(&projection_matrix, &projection_matrix_, sizeof(Matrix44)) != 0;
+		const bool lights_changed = !scene_data_valid_ || &light_data != scene_light_data_ || light_data.version() != scene_light_data_version_;
+
+		if (camera_changed)
+		{
+			view_matrix_ = view_matrix;
+			projection_matrix_ = projection_matrix;
+			view_projection_matrix_ = view_matrix * projection_matrix;
+			Matrix44 inverse_vp{};
+			inverse_vp.Inverse(view_projection_matrix_);
+			Vector4 viewer_position{ inverse_vp.GetRow(3) };
+			viewer_position *= 1/viewer_position.w();
+			viewer_position.set_w(1);
+			device_interface.SetLightShaderVariable(viewer_position_variable_index_, (void*)&viewer_position);
+		}
+
+		if (lights_changed)
+		{
+			Vector4 ambient_light_colour = light_data.AmbientLightColour().GetRGBAasVector4();
+			device_interface.SetLightShaderVariable(ambient_light_colour_variable_index_, (void*)&ambient_light_colour);
+
+			// light data without lights only needs the end of list marker, the lights already in the block stay behind it
+			const Int32 num_lights = light_data.num_lights() < MAX_LIGHTS ? light_data.num_lights() : MAX_LIGHTS;
+			if (num_lights > 0 || light_data_ == &light_data)
+			{
+				// only copy the lights modified since the last upload, unless this is different light data
+				Int32 begin = 0, end = num_lights;
+				if (light_data_ == &light_data)
+				{
+					if (!light_data.GetModifiedRange(light_data_version_, begin, end))
+						begin = end = 0;
+					if (end > num_lights)
+						end = num_lights;
+				}
+				if (begin < end)
+					device_interface.SetLightShaderVariable(light_data_variable_index_, &light_data.GetLights()[begin], begin, end - begin);
+
+				// put back the light the end of list marker was written over
+				if (terminator_index_ < num_lights && (terminator_index_ < begin || terminator_index_ >= end))
+					device_interface.SetLightShaderVariable(light_data_variable_index_, &light_data.GetLights()[terminator_index_], terminator_index_, 1);
+
+				light_data_ = &light_data;
+				light_data_version_ = light_data.version();
+			}
+
+			//A Radius that is -1 is to determine end of lights in shader
+			if (terminator_index_ != num_lights)
+			{
+				if (num_lights < MAX_LIGHTS)
+				{
+					LightData::Light terminator;
+					terminator.radius_ = -1.f;
+					device_interface.SetLightShaderVariable(light_data_variable_index_, &terminator, num_lights, 1);
+				}
+				terminator_index_ = num_lights;
+			}
+
+			scene_light_data_ = &light_data;
+			scene_light_data_version_ = light_data.version();
+		}
+
+		// the cluster lists are only copied when they have been rebuilt, turning clustering off for full bright lighting leaves them in place
+		const bool use_clusters = light_clusters != NULL && light_clusters->enabled();
+		bool cluster_params_changed = !scene_data_valid_ || use_clusters != clusters_enabled_;
+		if (use_clusters && (light_clusters != light_clusters_ || light_clusters->version() != light_clusters_version_))
+		{
+			device_interface.SetLightShaderVariable(cluster_ranges_variable_index_, light_clusters->cluster_ranges());
+			device_interface.SetLightShaderVariable(cluster_light_indices_variable_index_, light_clusters->light_indices());
+			light_clusters_ = light_clusters;
+			light_clusters_version_ = light_clusters->version();
+			cluster_params_changed = true;
+		}
+		if (cluster_params_changed)
+		{
+			const LightClusters::Params& params = use_clusters ? light_clusters->params() : kNoClusters;
+			device_interface.SetLightShaderVariable(cluster_params_variable_index_, params.num_clusters);
+			device_interface.SetLightShaderVariable(cluster_depth_params_variable_index_, &params.depth_scale);
+			clusters_enabled_ = use_clusters;
+		}
+
+		scene_data_valid_ = true;
+	}
+}
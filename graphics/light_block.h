@@ -0,0 +1,64 @@
+#ifndef _GEF_LIGHT_BLOCK_H
+#define _GEF_LIGHT_BLOCK_H
+
+#include <gef.h>
+#include <graphics/shader_interface.h>
+#include <maths/matrix44.h>
+
+namespace gef
+{
+	class LightData;
+	class LightClusters;
+
+	/**
+	The light block of the default 3D shaders: the viewer position, the ambient colour, the lights and the light clusters.
+	Remembers the scene data it last copied into the block, so only lights modified since then are copied,
+	and the cluster lists are only copied when they have been rebuilt.
+	Light data without lights, such as full bright lighting, only writes the end of list marker, so the lights
+	already in the block are kept behind it and switching back to them does not copy them again.
+	Each shader owns one, as each shader has its own light block. The clusters are built by Renderer3D and shared.
+	*/
+	class LightBlock
+	{
+	public:
+		LightBlock();
+
+		/// @brief Adds the light block variables to a shader. Call before the program is created.
+		void AddVariables(ShaderInterface& device_interface);
+
+		/// @brief Copies the scene data that has changed since the last call into the light block.
+		/// @param[in] device_interface	The shader interface AddVariables was called with.
+		/// @param[in] light_clusters	The clusters of the lights, or NULL to disable clustering.
+		void SetSceneData(ShaderInterface& device_interface, const LightData& light_data, const LightClusters* light_clusters, const Matrix44& view_matrix, const Matrix44& projection_matrix);
+
+		/// @return The view matrix multiplied by the projection matrix of the last scene data.
+		inline const Matrix44& view_projection_matrix() const { return view_projection_matrix_; }
+
+	private:
+		ShaderInterface::LVIndex viewer_position_variable_index_;
+		ShaderInterface::LVIndex ambient_light_colour_variable_index_;
+		ShaderInterface::LVIndex light_data_variable_index_;
+		ShaderInterface::LVIndex cluster_params_variable_index_;
+		ShaderInterface::LVIndex cluster_depth_params_variable_index_;
+		ShaderInterface::LVIndex cluster_ranges_variable_index_;
+		ShaderInterface::LVIndex cluster_light_indices_variable_index_;
+
+		// scene data currently in the light block
+		Matrix44 view_matrix_;
+		Matrix44 projection_matrix_;
+		Matrix44 view_projection_matrix_;
+		const LightData* scene_light_data_;
+		UInt32 scene_light_data_version_;
+		// the light data whose lights are in the light array, and the index of the end of list marker
+		const LightData* light_data_;
+		UInt32 light_data_version_;
+		Int32 terminator_index_;
+		// the clusters whose lists are in the block, and whether the cluster params enable them
+		const LightClusters* light_clusters_;
+		UInt32 light_clusters_version_;
+		bool clusters_enabled_;
+		bool scene_data_valid_;
+	};
+}
+
+#endif // _GEF_LIGHT_BLOCK_H
@@ -0,0 +1,246 @@
+#include <graphics/light_clusters.h>
+#include <math.h>
+#include <algorithm>
+
+namespace gef
+{
+	LightClusters::LightClusters() :
+		num_light_indices_(0),
+		version_(0)
+	{
+		cluster_ranges_.resize(kNumClusters, 0);
+		light_indices_.resize(kMaxLightIndices, 0);
+		cluster_counts_.resize(kNumClusters, 0);
+		view_matrix_.SetIdentity();
+		projection_matrix_.SetIdentity();
+		Disable();
+	}
+
+	void LightClusters::Disable()
+	{
+		params_.num_clusters[0] = kNumClustersX;
+		params_.num_clusters[1] = kNumClustersY;
+		params_.num_clusters[2] = kNumClustersZ;
+		params_.num_clusters[3] = 0;
+		params_.depth_scale = 0.0f;
+		params_.depth_bias = 0.0f;
+		params_.near_distance = 0.0f;
+		params_.far_distance = 0.0f;
+		num_light_indices_ = 0;
+	}
+
+	Int32 LightClusters::GetDepthSlice(float view_depth) const
+	{
+		Int32 slice = (Int32)floorf(logf(view_depth) * params_.depth_scale + params_.depth_bias);
+		if (slice < 0)
+			return 0;
+		if (slice >= kNumClustersZ)
+			return kNumClustersZ - 1;
+		return slice;
+	}
+
+	static Int32 GetTile(float ndc, Int32 num_tiles)
+	{
+		Int32 tile = (Int32)floorf((ndc * 0.5f + 0.5f) * (float)num_tiles);
+		if (tile < 0)
+			return 0;
+		if (tile >= num_tiles)
+			return num_tiles - 1;
+		return tile;
+	}
+
+	bool LightClusters::CalculateLightBounds(const LightData::Light& light, ClusterBounds& bounds) const
+	{
+		const float radius = light.radius_;
+		if (radius <= 0.0f)
+			return false;
+
+		// view space looks down the negative z axis
+		const Vector4 world_position(light.position_.x(), light.position_.y(), light.position_.z(), 1.0f);
+		const Vector4 view_position = world_position.TransformW(view_matrix_);
+		const float view_depth = -view_position.z();
+		if (view_depth + radius < params_.near_distance || view_depth - radius > params_.far_distance)
+			return false;
+
+		bounds.min_z = GetDepthSlice(view_depth - radius > params_.near_distance ? view_depth - radius : params_.near_distance);
+		bounds.max_z = GetDepthSlice(view_depth + radius < params_.far_distance ? view_depth + radius : params_.far_distance);
+
+		if (view_depth - radius <= params_.near_distance)
+		{
+			// sphere crosses the near plane, its projection is unbounded
+			bounds.min_x = 0;
+			bounds.min_y = 0;
+			bounds.max_x = kNumClustersX - 1;
+			bounds.max_y = kNumClustersY - 1;
+			return true;
+		}
+
+		// project the corners of the view space box around the sphere, all of them are in front of the near plane
+		float min_ndc_x = 1e30f, min_ndc_y = 1e30f;
+		float max_ndc_x = -1e30f, max_ndc_y = -1e30f;
+		for (int corner_num = 0; corner_num < 8; ++corner_num)
+		{
+			const Vector4 corner(
+				view_position.x() + ((corner_num & 1) ? radius : -radius),
+				view_position.y() + ((corner_num & 2) ? radius : -radius),
+				view_position.z() + ((corner_num & 4) ? radius : -radius),
+				1.0f);
+			const Vector4 clip_position = corner.TransformW(projection_matrix_);
+			const float ndc_x = clip_position.x() / clip_position.w();
+			const float ndc_y = clip_position.y() / clip_position.w();
+			min_ndc_x = ndc_x < min_ndc_x ? ndc_x : min_ndc_x;
+			min_ndc_y = ndc_y < min_ndc_y ? ndc_y : min_ndc_y;
+			max_ndc_x = ndc_x > max_ndc_x ? ndc_x : max_ndc_x;
+			max_ndc_y = ndc_y > max_ndc_y ? ndc_y : max_ndc_y;
+		}
+
+		if (max_ndc_x < -1.0f || min_ndc_x > 1.0f || max_ndc_y < -1.0f || min_ndc_y > 1.0f)
+			return false;
+
+		bounds.min_x = GetTile(min_ndc_x, kNumClustersX);
+		bounds.min_y = GetTile(min_ndc_y, kNumClustersY);
+		bounds.max_x = GetTile(max_ndc_x, kNumClustersX);
+		bounds.max_y = GetTile(max_ndc_y, kNumClustersY);
+		return true;
+	}
+
+	bool LightClusters::Build(const LightData::Light* lights, Int32 num_lights, const Matrix44& view_matrix, const Matrix44& projection_matrix)
+	{
+		Disable();
+		++version_;
+
+		// only Direct3D style perspective projections are supported
+		if (projection_matrix.m(2, 3) != -1.0f || projection_matrix.m(3, 3) != 0.0f || projection_matrix.m(2, 2) == 0.0f || projection_matrix.m(2, 2) == -1.0f)
+			return false;
+
+		const float near_distance = projection_matrix.m(3, 2) / projection_matrix.m(2, 2);
+		const float far_distance = projection_matrix.m(3, 2) / (projection_matrix.m(2, 2) + 1.0f);
+		if (near_distance <= 0.0f || far_distance <= near_distance)
+			return false;
+
+		view_matrix_ = view_matrix;
+		projection_matrix_ = projection_matrix;
+
+		const float log_depth_range = logf(far_distance / near_distance);
+		params_.depth_scale = (float)kNumClustersZ / log_depth_range;
+		params_.depth_bias = -(float)kNumClustersZ * logf(near_distance) / log_depth_range;
+		params_.near_distance = near_distance;
+		params_.far_distance = far_distance;
+
+		// count the lights in each cluster
+		light_bounds_.resize(num_lights);
+		std::fill(cluster_counts_.begin(), cluster_counts_.end(), 0);
+		UInt32 total_count = 0;
+		for (Int32 light_num = 0; light_num < num_lights; ++light_num)
+		{
+			ClusterBounds& bounds = light_bounds_[light_num];
+			if (!CalculateLightBounds(lights[light_num], bounds))
+			{
+				bounds.min_x = bounds.min_y = bounds.min_z = 0;
+				bounds.max_x = bounds.max_y = bounds.max_z = -1;
+				continue;
+			}
+
+			for (Int32 z = bounds.min_z; z <= bounds.max_z; ++z)
+				for (Int32 y = bounds.min_y; y <= bounds.max_y; ++y)
+					for (Int32 x = bounds.min_x; x <= bounds.max_x; ++x)
+						cluster_counts_[(z * kNumClustersY + y) * kNumClustersX + x]++;
+
+			total_count += (bounds.max_x - bounds.min_x + 1) * (bounds.max_y - bounds.min_y + 1) * (bounds.max_z - bounds.min_z + 1);
+		}
+
+		// not enough room in the index list, the shader falls back to considering all lights
+		if (total_count > (UInt32)kMaxLightIndices)
+			return false;
+
+		// each cluster's range starts where the previous one ended, the count is used as a write cursor while filling
+		UInt32 offset = 0;
+		for (Int32 cluster_num = 0; cluster_num < kNumClusters; ++cluster_num)
+		{
+			cluster_ranges_[cluster_num] = offset << 16;
+			offset += cluster_counts_[cluster_num];
+		}
+
+		for (Int32 light_num = 0; light_num < num_lights; ++light_num)
+		{
+			const ClusterBounds& bounds = light_bounds_[light_num];
+			for (Int32 z = bounds.min_z; z <= bounds.max_z; ++z)
+			{
+				for (Int32 y = bounds.min_y; y <= bounds.max_y; ++y)
+				{
+					for (Int32 x = bounds.min_x; x <= bounds.max_x; ++x)
+					{
+						UInt32& range = cluster_ranges_[(z * kNumClustersY + y) * kNumClustersX + x];
+						light_indices_[(range >> 16) + (range & 0xffff)] = (UInt16)light_num;
+						range++;
+					}
+				}
+			}
+		}
+
+		num_light_indices_ = total_count;
+		params_.num_clusters[3] = 1;
+		return true;
+	}
+
+	Int32 LightClusters::GetClusterIndex(const Vector4& world_position) const
+	{
+		if (!enabled())
+			return -1;
+
+		const Vector4 position(world_position.x(), world_position.y(), world_position.z(), 1.0f);
+		const Vector4 view_position = position.TransformW(view_matrix_);
+		const float view_depth = -view_position.z();
+		if (view_depth < params_.near_distance || view_depth > params_.far_distance)
+			return -1;
+
+		const Vector4 clip_position = view_position.TransformW(projection_matrix_);
+		const float ndc_x = clip_position.x() / clip_position.w();
+		const float ndc_y = clip_position.y() / clip_position.w();
+		if (ndc_x < -1.0f || ndc_x > 1.0f || ndc_y < -1.0f || ndc_y > 1.0f)
+			return -1;
+
+		const Int32 x = GetTile(ndc_x, kNumClustersX);
+		const Int32 y = GetTile(ndc_y, kNumClustersY);
+		const Int32 z = GetDepthSlice(view_depth);
+		return (z * kNumClustersY + y) * kNumClustersX + x;
+	}
+
+	UInt32 LightClusters::GetClusterLights(Int32 cluster_index, const UInt16** light_indices) const
+	{
+		const UInt32 range = cluster_ranges_[cluster_index];
+		*light_indices = &light_indices_[range >> 16];
+		return range & 0xffff;
+	}
+
+	bool LightClusters::LightAffectsPoint(const LightData::Light& light, const Vector4& world_position)
+	{
+		const Vector4 offset = world_position - light.position_;
+		return offset.LengthSqr() <= light.radius_ * light.radius_;
+	}
+
+	UInt32 LightClusters::GatherLights(const LightData::Light* lights, Int32 num_lights, const Vector4& world_position, UInt16* light_indices, UInt32 max_light_indices) const
+	{
+		UInt32 num_affecting = 0;
+		const Int32 cluster_index = GetClusterIndex(world_position);
+		if (cluster_index == -1)
+		{
+			for (Int32 light_num = 0; light_num < num_lights && num_affecting < max_light_indices; ++light_num)
+			{
+				if (lights[light_num].radius_ > 0.0f && LightAffectsPoint(lights[light_num], world_position))
+					light_indices[num_affecting++] = (UInt16)light_num;
+			}
+			return num_affecting;
+		}
+
+		const UInt16* cluster_lights;
+		const UInt32 num_cluster_lights = GetClusterLights(cluster_index, &cluster_lights);
+		for (UInt32 index_num = 0; index_num < num_cluster_lights && num_affecting < max_light_indices; ++index_num)
+		{
+			const UInt16 light_num = cluster_lights[index_num];
+			if (LightAffectsPoint(lights[light_num], world_position))
+				light_indices[num_affecting++] = light_num;
+		}
+		return num_affecting;
+	}
+}
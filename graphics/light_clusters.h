@@ -0,0 +1,113 @@
+#ifndef _GEF_LIGHT_CLUSTERS_H
+#define _GEF_LIGHT_CLUSTERS_H
+
+#include <gef.h>
+#include <graphics/light_data.h>
+#include <maths/matrix44.h>
+#include <vector>
+
+namespace gef
+{
+	/**
+	Clustered light assignment.
+	The view frustum is divided into a grid of clusters, kNumClustersX by kNumClustersY tiles in normalised device coordinates
+	and kNumClustersZ slices in view depth, spaced exponentially between the near and far planes.
+	Each light is added to the list of every cluster its bounding sphere may touch, so shading a point only needs to
+	consider the lights listed for the cluster containing it.
+	The cluster data is laid out to be copied straight into shader constant buffers.
+	*/
+	class LightClusters
+	{
+	public:
+		static const Int32 kNumClustersX = 16;
+		static const Int32 kNumClustersY = 8;
+		static const Int32 kNumClustersZ = 16;
+		static const Int32 kNumClusters = kNumClustersX * kNumClustersY * kNumClustersZ;
+		/// Size of the light index list, shared by all clusters.
+		/// Fills what is left of the 64 KB constant buffer limit after the lights and cluster ranges.
+		static const Int32 kMaxLightIndices = 12256;
+
+		/// Shader constants describing the cluster grid.
+		struct Params
+		{
+			/// kNumClustersX, kNumClustersY, kNumClustersZ and 1 if clustering is enabled, otherwise 0.
+			UInt32 num_clusters[4];
+			/// slice = log(view depth) * depth_scale + depth_bias, followed by the near and far plane distances.
+			float depth_scale;
+			float depth_bias;
+			float near_distance;
+			float far_distance;
+		};
+
+		LightClusters();
+
+		/// @brief Assign lights to clusters.
+		/// @param[in] lights			The lights, as packed by LightData::PackLights. Indices in the cluster lists refer to this array.
+		/// @param[in] num_lights		The number of lights.
+		/// @param[in] view_matrix		The camera view matrix.
+		/// @param[in] projection_matrix	The camera projection matrix. Must be a Direct3D style perspective projection.
+		/// @return true if the lights were clustered. false if the projection is not a perspective projection or
+		/// the cluster lists overflowed, in which case enabled() is false and every light must be considered for every point.
+		bool Build(const LightData::Light* lights, Int32 num_lights, const Matrix44& view_matrix, const Matrix44& projection_matrix);
+
+		/// @brief Find the cluster containing a point.
+		/// @param[in] world_position	The point in world space.
+		/// @return The cluster index, or -1 if the point is outside the view frustum.
+		Int32 GetClusterIndex(const Vector4& world_position) const;
+
+		/// @brief Get the lights listed for a cluster.
+		/// @param[in] cluster_index	The cluster index.
+		/// @param[out] light_indices	Receives a pointer to the light indices for the cluster.
+		/// @return The number of light indices.
+		UInt32 GetClusterLights(Int32 cluster_index, const UInt16** light_indices) const;
+
+		/// @brief CPU reference of the shader light loop. Find the lights whose radius contains a point, using the cluster lists.
+		/// @param[in] lights			The lights passed to Build.
+		/// @param[in] num_lights		The number of lights passed to Build.
+		/// @param[in] world_position	The point in world space.
+		/// @param[out] light_indices	Receives the indices of the lights affecting the point, in cluster list order.
+		/// @param[in] max_light_indices	The size of the light_indices array.
+		/// @return The number of lights affecting the point.
+		/// @note Falls back to testing every light if clustering is disabled or the point is outside the view frustum.
+		UInt32 GatherLights(const LightData::Light* lights, Int32 num_lights, const Vector4& world_position, UInt16* light_indices, UInt32 max_light_indices) const;
+
+		/// @brief Test if a point is within the radius of a light.
+		static bool LightAffectsPoint(const LightData::Light& light, const Vector4& world_position);
+
+		inline bool enabled() const { return params_.num_clusters[3] != 0; }
+		inline const Params& params() const { return params_; }
+		/// @brief Changes every time Build is called, so copies of the cluster lists can tell when they are out of date.
+		inline UInt32 version() const { return version_; }
+
+		/// @brief Get the per cluster ranges, one UInt32 per cluster with the offset into the light index list in the upper
+		/// 16 bits and the light count in the lower 16 bits. Four clusters fit in each uint4 of a constant buffer.
+		inline const UInt32* cluster_ranges() const { return cluster_ranges_.data(); }
+
+		/// @brief Get the light index list. Eight indices fit in each uint4 of a constant buffer.
+		inline const UInt16* light_indices() const { return light_indices_.data(); }
+		inline UInt32 num_light_indices() const { return num_light_indices_; }
+
+	private:
+		struct ClusterBounds
+		{
+			Int32 min_x, min_y, min_z;
+			Int32 max_x, max_y, max_z;
+		};
+
+		bool CalculateLightBounds(const LightData::Light& light, ClusterBounds& bounds) const;
+		Int32 GetDepthSlice(float view_depth) const;
+		void Disable();
+
+		Params params_;
+		Matrix44 view_matrix_;
+		Matrix44 projection_matrix_;
+		std::vector<UInt32> cluster_ranges_;
+		std::vector<UInt16> light_indices_;
+		UInt32 num_light_indices_;
+		std::vector<ClusterBounds> light_bounds_;
+		std::vector<UInt32> cluster_counts_;
+		UInt32 version_;
+	};
+}
+
+#endif // _GEF_LIGHT_CLUSTERS_H
@@ -1,4 +1,7 @@
 #include <graphics/light_data.h>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
 
 namespace gef
 {
@@ -17,30 +20,99 @@ namespace gef
 	{
 	}
 	
-	LightData::LightData() : ambient_light_colour_{1.0,1.0,1.0}, next_light_id_{1}
+	// shared by all LightData objects so a version identifies both the object and its contents
+	static std::atomic<UInt32> next_version{1};
+
+	LightData::LightData() : ambient_light_colour_{1.0,1.0,1.0}, version_{next_version++}, ambient_version_{version_}
+	{
+	}
+	void LightData::MarkModified()
+	{
+		version_ = next_version++;
+	}
+	void LightData::MarkLightModified(Int32 dense_index)
+	{
+		MarkModified();
+		light_versions_[dense_index] = version_;
+	}
+	Int32 LightData::FindDenseIndex(const UInt64 light_handle) const
 	{
+		const UInt32 slot_index = (UInt32)(light_handle & 0xffffffff);
+		const UInt32 generation = (UInt32)(light_handle >> 32);
+		if (slot_index >= slots_.size() || slots_[slot_index].generation != generation)
+			return -1;
+		return (Int32)slots_[slot_index].dense_index;
 	}
 	UInt64 LightData::AddLight(const Light& point_light)
 	{
-		lights_[next_light_id_] = point_light;
-		next_light_id_++;
-		return next_light_id_-1;
+		UInt32 slot_index;
+		if (free_slots_.empty())
+		{
+			slot_index = (UInt32)slots_.size();
+			// generations start at 1 so 0 is never a valid handle
+			slots_.push_back(Slot{ 0, 1 });
+		}
+		else
+		{
+			slot_index = free_slots_.back();
+			free_slots_.pop_back();
+		}
+
+		Slot& slot = slots_[slot_index];
+		slot.dense_index = (UInt32)lights_.size();
+		lights_.push_back(point_light);
+		light_slots_.push_back(slot_index);
+		light_versions_.push_back(0);
+		MarkLightModified((Int32)slot.dense_index);
+		return MakeHandle(slot_index, slot.generation);
 	}
-	void LightData::RemoveLight(UInt64 key)
+	void LightData::RemoveLight(UInt64 light_handle)
 	{
-		lights_.erase(key);
+		const Int32 dense_index = FindDenseIndex(light_handle);
+		if (dense_index < 0)
+			return;
+
+		const UInt32 slot_index = (UInt32)(light_handle & 0xffffffff);
+		const Int32 last_index = (Int32)lights_.size() - 1;
+		if (dense_index != last_index)
+		{
+			// move the last light into the gap to keep the array dense
+			lights_[dense_index] = lights_[last_index];
+			light_slots_[dense_index] = light_slots_[last_index];
+			slots_[light_slots_[dense_index]].dense_index = (UInt32)dense_index;
+		}
+		lights_.pop_back();
+		light_slots_.pop_back();
+		light_versions_.pop_back();
+
+		// invalidate any handles to the removed light
+		Slot& slot = slots_[slot_index];
+		slot.generation = slot.generation == 0xffffffff ? 1 : slot.generation + 1;
+		free_slots_.push_back(slot_index);
+
+		if (dense_index != last_index)
+			MarkLightModified(dense_index);
+		else
+			MarkModified();
 	}
-	const LightData::Light& LightData::GetLight(const UInt64 key) const
+	bool LightData::IsValid(const UInt64 light_handle) const
 	{
-		return lights_.at(key);
+		return FindDenseIndex(light_handle) >= 0;
 	}
-	LightData::Light& LightData::GetLight(const UInt64 key)
+	const LightData::Light& LightData::GetLight(const UInt64 light_handle) const
 	{
-		return lights_.at(key);
+		const Int32 dense_index = FindDenseIndex(light_handle);
+		if (dense_index < 0)
+			throw std::out_of_range("LightData::GetLight invalid light handle");
+		return lights_[dense_index];
 	}
-	const std::unordered_map<UInt64, LightData::Light>& LightData::GetLights() const
+	LightData::Light& LightData::GetLight(const UInt64 light_handle)
 	{
-		return lights_;
+		const Int32 dense_index = FindDenseIndex(light_handle);
+		if (dense_index < 0)
+			throw std::out_of_range("LightData::GetLight invalid light handle");
+		MarkLightModified(dense_index);
+		return lights_[dense_index];
 	}
 	const Colour& LightData::AmbientLightColour() const
 	{
@@ -48,10 +120,47 @@ namespace gef
 	}
 	void LightData::SetAmbientLightColour(const Colour& colour)
 	{
+		MarkModified();
+		ambient_version_ = version_;
 		ambient_light_colour_ = colour;
 	}
 	void LightData::ClearLights() {
-		next_light_id_ = 1;
+		MarkModified();
 		lights_.clear();
+		light_slots_.clear();
+		light_versions_.clear();
+		// keep the slots so handles to the cleared lights stay invalid
+		free_slots_.clear();
+		for (UInt32 slot_index = 0; slot_index < slots_.size(); ++slot_index)
+		{
+			Slot& slot = slots_[slot_index];
+			slot.generation = slot.generation == 0xffffffff ? 1 : slot.generation + 1;
+			free_slots_.push_back(slot_index);
+		}
+	}
+	bool LightData::GetModifiedRange(UInt32 since_version, Int32& begin, Int32& end) const
+	{
+		begin = (Int32)lights_.size();
+		end = 0;
+		for (Int32 light_num = 0; light_num < (Int32)light_versions_.size(); ++light_num)
+		{
+			if (light_versions_[light_num] > since_version)
+			{
+				if (light_num < begin)
+					begin = light_num;
+				end = light_num + 1;
+			}
+		}
+		return begin < end;
+	}
+	Int32 LightData::PackLights(Light* lights, Int32 max_lights) const
+	{
+		Int32 num_lights = (Int32)lights_.size() < max_lights ? (Int32)lights_.size() : max_lights;
+		if (num_lights > 0)
+			memcpy(lights, lights_.data(), num_lights * sizeof(Light));
+		//A Radius that is -1 is to determine end of lights in shader
+		if (num_lights < max_lights)
+			lights[num_lights].radius_ = -1.f;
+		return num_lights;
 	}
 }
@@ -4,7 +4,6 @@
 #include <graphics/colour.h>
 #include <vector>
 #include <graphics/point_light.h>
-#include <unordered_map>
 
 constexpr int MAX_LIGHTS = 512;
 
@@ -28,18 +27,81 @@ namespace gef
 		static_assert(sizeof(Light) == 16 * 4, "LightData::Light is the wrong size for HLSL!");
 
 		LightData();
+
+		/// @brief Add a light.
+		/// @param[in] point_light	The light.
+		/// @return A handle used to access the light. Handles stay valid until the light is removed, even when other lights are removed.
 		UInt64 AddLight(const Light& point_light);
-		void RemoveLight(UInt64);
-		const Light& GetLight(const UInt64 light_num) const;
-		Light& GetLight(const UInt64 light_num);
-		const std::unordered_map<UInt64, Light>& GetLights() const;
+
+		/// @brief Remove a light. Does nothing if the handle is not valid.
+		/// @param[in] light_handle	The handle returned by AddLight.
+		/// @note The last light in the dense array is moved into the removed light's place.
+		void RemoveLight(UInt64 light_handle);
+
+		/// @brief Get a light.
+		/// @param[in] light_handle	The handle returned by AddLight.
+		/// @return The light.
+		/// @note Throws std::out_of_range if the handle is not valid, the same as the previous map based storage.
+		const Light& GetLight(const UInt64 light_handle) const;
+		Light& GetLight(const UInt64 light_handle);
+
+		/// @brief Check if a handle refers to a light that has not been removed.
+		bool IsValid(const UInt64 light_handle) const;
+
+		/// @brief Get all lights, stored contiguously. The order changes when lights are removed.
+		inline const std::vector<Light>& GetLights() const { return lights_; }
+		inline Int32 num_lights() const { return (Int32)lights_.size(); }
+
 		const Colour& AmbientLightColour() const;
 		void SetAmbientLightColour(const Colour& colour);
 		void ClearLights();
+
+		/// @brief Copy the lights into an array laid out for the shader light constant buffer.
+		/// @param[out] lights		Receives the lights. Must have room for max_lights entries.
+		/// @param[in] max_lights	The size of the lights array.
+		/// @return The number of lights written. If there is room, the entry after the last light is marked with a radius of -1.
+		Int32 PackLights(Light* lights, Int32 max_lights) const;
+
+		/// @brief Get the version of the light data.
+		/// @return A value that changes every time the light data is modified. Versions are unique across all LightData objects.
+		/// @note Requesting a non-const reference to a light with GetLight counts as a modification.
+		inline UInt32 version() const { return version_; }
+
+		/// @brief Get the version of the ambient light colour, changes only when the ambient light colour is set.
+		inline UInt32 ambient_version() const { return ambient_version_; }
+
+		/// @brief Find the range of lights in the dense array modified after a version.
+		/// @param[in] since_version	A version previously returned by version().
+		/// @param[out] begin			Receives the index of the first modified light.
+		/// @param[out] end				Receives one past the index of the last modified light.
+		/// @return false if no lights were modified after since_version.
+		/// @note Removing lights reduces the light count without marking the old tail, so callers should also compare num_lights.
+		bool GetModifiedRange(UInt32 since_version, Int32& begin, Int32& end) const;
+
+		/// @brief Force the version to change, e.g. after modifying a light through a reference that was held on to.
+		void MarkModified();
 	private:
+		struct Slot
+		{
+			UInt32 dense_index;
+			UInt32 generation;
+		};
+
+		static UInt64 MakeHandle(UInt32 slot_index, UInt32 generation) { return ((UInt64)generation << 32) | slot_index; }
+		Int32 FindDenseIndex(const UInt64 light_handle) const;
+		void MarkLightModified(Int32 dense_index);
+
 		Colour ambient_light_colour_;
-		std::unordered_map<UInt64, Light> lights_;
-		UInt64 next_light_id_;
+		// dense light storage and the slot each light belongs to
+		std::vector<Light> lights_;
+		std::vector<UInt32> light_slots_;
+		// version when each light was last modified, parallel to lights_
+		std::vector<UInt32> light_versions_;
+		// handle lookup, a handle is the slot index in the lower 32 bits and the slot generation in the upper 32 bits
+		std::vector<Slot> slots_;
+		std::vector<UInt32> free_slots_;
+		UInt32 version_;
+		UInt32 ambient_version_;
 	};
 }
 #endif // _GEF_DEFAULT_3D_SHADER_H
@@ -1,22 +1,28 @@
 #include "material.h"
 #include <stdlib.h>
+#include <atomic>
 #include <graphics/colour.h>
 
 namespace gef
 {
-	Material::Material() : 
-		texture_diffuse_{nullptr},
-		texture_specular_{nullptr},
-		texture_normal_{nullptr},
-		ambient_{0,0,0},
-		diffuse_{1,1,1,1},
-		specular_{0,0,0},
-		shininess_{1}
+	// shared by all Material objects so a version identifies both the object and its contents
+	static std::atomic<UInt32> next_version{1};
+
+	Material::Material() :
+		constants_{{0,0,0},{1,1,1,1},{0,0,0},1,{0,0,0}},
+		textures_{nullptr, nullptr, nullptr},
+		version_{next_version++}
 	{
 	}
+
 	void Material::SetDiffuse(UInt32 abgr) {
 		gef::Colour colour{};
 		colour.SetFromAGBR(abgr);
-		diffuse_ = colour.GetRGBAasVector4();
+		set_diffuse(colour.GetRGBAasVector4());
+	}
+
+	void Material::MarkModified()
+	{
+		version_ = next_version++;
 	}
-}
\ No newline at end of file
+}
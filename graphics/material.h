@@ -8,19 +8,66 @@ namespace gef
 {
 	class Texture;
 
+	/**
+	Surface properties used by the default 3D shaders.
+	The constants are stored pre-packed in the layout of the shader constant buffer and the textures as one binding set,
+	so a shader can bind a material with a single block copy. Every modification changes the material version,
+	which lets shaders skip binding a material that is already bound and unchanged.
+	*/
 	class Material
 	{
 	public:
+		/// @brief The material constants, in the layout of the default shaders' pixel shader variables.
+		struct ConstantBlock
+		{
+			Vector4 ambient;
+			Vector4 diffuse;
+			Vector4 specular;
+			float shininess;
+			float padding[3];
+		};
+
+		/// @brief The textures bound with the material. NULL entries use the shader's default texture.
+		struct TextureSet
+		{
+			Texture* diffuse;
+			Texture* specular;
+			Texture* normal;
+		};
+
 		Material();
 		void SetDiffuse(UInt32 abgr);
-		Texture* texture_diffuse_;
-		Texture* texture_specular_;
-		Texture* texture_normal_;
-		gef::Vector4 ambient_;
-		gef::Vector4 diffuse_;
-		gef::Vector4 specular_;
-		float shininess_;
+
+		inline void set_ambient(const Vector4& ambient) { constants_.ambient = ambient; MarkModified(); }
+		inline const Vector4& ambient() const { return constants_.ambient; }
+		inline void set_diffuse(const Vector4& diffuse) { constants_.diffuse = diffuse; MarkModified(); }
+		inline const Vector4& diffuse() const { return constants_.diffuse; }
+		inline void set_specular(const Vector4& specular) { constants_.specular = specular; MarkModified(); }
+		inline const Vector4& specular() const { return constants_.specular; }
+		inline void set_shininess(float shininess) { constants_.shininess = shininess; MarkModified(); }
+		inline float shininess() const { return constants_.shininess; }
+
+		inline void set_texture_diffuse(Texture* texture) { textures_.diffuse = texture; MarkModified(); }
+		inline Texture* texture_diffuse() const { return textures_.diffuse; }
+		inline void set_texture_specular(Texture* texture) { textures_.specular = texture; MarkModified(); }
+		inline Texture* texture_specular() const { return textures_.specular; }
+		inline void set_texture_normal(Texture* texture) { textures_.normal = texture; MarkModified(); }
+		inline Texture* texture_normal() const { return textures_.normal; }
+
+		inline const ConstantBlock& constant_block() const { return constants_; }
+		inline const TextureSet& texture_set() const { return textures_; }
+
+		/// @brief Get the version of the material.
+		/// @return A value that changes every time the material is modified. Versions are unique across all Material objects.
+		inline UInt32 version() const { return version_; }
+
+	private:
+		void MarkModified();
+
+		ConstantBlock constants_;
+		TextureSet textures_;
+		UInt32 version_;
 	};
 }
 
-#endif // _MATERIAL_H
\ No newline at end of file
+#endif // _MATERIAL_H
@@ -1,11 +1,71 @@
 #include <graphics/mesh_instance.h>
+#include <graphics/mesh.h>
 #include <cstddef>
 
 namespace gef
 {
 	MeshInstance::MeshInstance() :
-		mesh_(NULL)
+		mesh_(NULL),
+		inv_world_transpose_dirty_(false),
+		world_aabb_dirty_(true),
+		transform_hierarchy_(NULL),
+		transform_node_(-1),
+		transform_node_version_(0)
 	{
 		transform_.SetIdentity();
+		inv_world_transpose_.SetIdentity();
+	}
+
+	void MeshInstance::set_transform_node(const TransformHierarchy* transform_hierarchy, const Int32 node)
+	{
+		if (transform_hierarchy == NULL)
+		{
+			set_transform(transform());
+			return;
+		}
+
+		transform_hierarchy_ = transform_hierarchy;
+		transform_node_ = node;
+		transform_node_version_ = transform_hierarchy->world_version(node);
+		inv_world_transpose_dirty_ = true;
+		world_aabb_dirty_ = true;
+	}
+
+	void MeshInstance::CheckTransformNodeVersion() const
+	{
+		if (transform_hierarchy_)
+		{
+			const UInt32 version = transform_hierarchy_->world_version(transform_node_);
+			if (version != transform_node_version_)
+			{
+				transform_node_version_ = version;
+				inv_world_transpose_dirty_ = true;
+				world_aabb_dirty_ = true;
+			}
+		}
+	}
+
+	const Matrix44& MeshInstance::inv_world_transpose() const
+	{
+		CheckTransformNodeVersion();
+		if (inv_world_transpose_dirty_)
+		{
+			inv_world_transpose_.InverseTranspose(transform());
+			inv_world_transpose_dirty_ = false;
+		}
+
+		return inv_world_transpose_;
+	}
+
+	const Aabb& MeshInstance::world_aabb() const
+	{
+		CheckTransformNodeVersion();
+		if (world_aabb_dirty_)
+		{
+			world_aabb_ = mesh_ ? mesh_->aabb().Transform(transform()) : Aabb();
+			world_aabb_dirty_ = false;
+		}
+
+		return world_aabb_;
 	}
 }
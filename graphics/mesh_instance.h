@@ -2,6 +2,9 @@
 #define _GEF_MESH_INSTANCE_H
 
 #include <maths/matrix44.h>
+#include <maths/aabb.h>
+#include <maths/transform_hierarchy.h>
+#include <cstddef>
 
 namespace gef
 {
@@ -9,6 +12,8 @@ namespace gef
 
 	/**
 	An instance of an object the visually represented by a Mesh and is placed in the world by its own transform.
+	Matrices and bounds derived from the transform are cached and only recalculated after the transform or mesh changes,
+	so static instances do not pay for them on every draw.
 	*/
 	class MeshInstance
 	{
@@ -18,11 +23,19 @@ namespace gef
 
 		/// @brief Get the transform
 		/// @return The transformation matrix
-		const Matrix44& transform() const {return transform_;}
+		/// @note If the mesh instance is attached to a TransformHierarchy node this is the world matrix of the node.
+		const Matrix44& transform() const { return transform_hierarchy_ ? transform_hierarchy_->world_matrix(transform_node_) : transform_; }
 
 		/// @brief Set the transform
 		/// @param[in] transform	the transformation matrix
-		void set_transform(const Matrix44& transform) { transform_ = transform; }
+		/// @note Detaches the mesh instance from any TransformHierarchy node.
+		void set_transform(const Matrix44& transform)
+		{
+			transform_ = transform;
+			transform_hierarchy_ = NULL;
+			inv_world_transpose_dirty_ = true;
+			world_aabb_dirty_ = true;
+		}
 
 		/// @brief Get the mesh
 		/// @return The mesh
@@ -32,16 +45,58 @@ namespace gef
 
 		/// @brief Set the mesh
 		/// @param[in] mesh		The mesh that visually represents this object
-		void set_mesh(const Mesh* mesh) { mesh_ = mesh; }
+		void set_mesh(const Mesh* mesh)
+		{
+			mesh_ = mesh;
+			world_aabb_dirty_ = true;
+		}
 
 		bool lit() const { return lit_; }
 		void set_lit(bool lit) {lit_ = lit;}
+
+		/// @brief Get the transpose of the inverse of the transform, used to transform normals.
+		/// @return The inverse transpose matrix. Recalculated only if the transform has changed since the last call.
+		/// @note Not safe to call from multiple threads while the cached value is dirty.
+		const Matrix44& inv_world_transpose() const;
+
+		/// @brief Get the bounds of the mesh in world space.
+		/// @return The mesh bounds transformed by the transform. Recalculated only if the transform or mesh has changed since the last call.
+		/// @note Not safe to call from multiple threads while the cached value is dirty.
+		const Aabb& world_aabb() const;
+
+		/// @brief Attach the mesh instance to a node in a transform hierarchy.
+		/// The transform of the mesh instance is then read from the world matrix of the node.
+		/// @param[in] transform_hierarchy	The hierarchy. Must outlive the mesh instance, or be detached with set_transform. NULL detaches.
+		/// @param[in] node					The index of the node in the hierarchy.
+		void set_transform_node(const TransformHierarchy* transform_hierarchy, const Int32 node);
+
+		inline const TransformHierarchy* transform_hierarchy() const { return transform_hierarchy_; }
+		inline Int32 transform_node() const { return transform_node_; }
+
+		/// @brief Force the cached bounds to be recalculated, e.g. after the bounds of the mesh have been modified.
+		inline void MarkBoundsDirty() { world_aabb_dirty_ = true; }
 	protected:
 		/// The transformation matrix.
 		Matrix44 transform_;
 		bool lit_;
 		/// The mesh
 		const Mesh* mesh_;
+
+		/// Cached transpose of the inverse transform.
+		mutable Matrix44 inv_world_transpose_;
+		/// Cached world space bounds.
+		mutable Aabb world_aabb_;
+		mutable bool inv_world_transpose_dirty_;
+		mutable bool world_aabb_dirty_;
+
+		/// Optional hierarchy node the transform is read from.
+		const TransformHierarchy* transform_hierarchy_;
+		Int32 transform_node_;
+		/// World version of the hierarchy node when the cached values were last checked.
+		mutable UInt32 transform_node_version_;
+
+	private:
+		void CheckTransformNodeVersion() const;
 	};
 }
 
@@ -0,0 +1,310 @@
+#include <graphics/occlusion_culler.h>
+#include <graphics/mesh_instance.h>
+#include <graphics/mesh.h>
+#include <maths/aabb.h>
+#include <system/parallel_for.h>
+#include <system/frame_allocator.h>
+#include <emmintrin.h>
+#include <math.h>
+#include <algorithm>
+
+namespace gef
+{
+	// clip space w below this is treated as crossing the near plane
+	static const float kMinClipW = 1e-5f;
+
+	OcclusionCuller::OcclusionCuller(Int32 width, Int32 height, UInt32 num_threads) :
+		num_threads_(num_threads),
+		frame_allocator_(NULL)
+	{
+		num_tiles_x_ = (width + kTileWidth - 1) / kTileWidth;
+		num_tiles_y_ = (height + kTileHeight - 1) / kTileHeight;
+		if (num_tiles_x_ < 1)
+			num_tiles_x_ = 1;
+		if (num_tiles_y_ < 1)
+			num_tiles_y_ = 1;
+		width_ = num_tiles_x_*kTileWidth;
+		height_ = num_tiles_y_*kTileHeight;
+
+		depth_buffer_.resize(width_*height_, 1.0f);
+		tile_bins_.resize(num_tiles_x_*num_tiles_y_);
+		view_projection_.SetIdentity();
+	}
+
+	void OcclusionCuller::Begin(const Matrix44& view_projection)
+	{
+		view_projection_ = view_projection;
+		std::fill(depth_buffer_.begin(), depth_buffer_.end(), 1.0f);
+		triangles_.clear();
+		for (auto& bin : tile_bins_)
+			bin.clear();
+	}
+
+	void OcclusionCuller::AddOccluder(const Vector4* positions, UInt32 num_vertices, const UInt32* indices, UInt32 num_indices, const Matrix44& transform)
+	{
+		const Matrix44 world_view_projection = transform * view_projection_;
+
+		std::vector<Vector4> heap_clip_positions;
+		Vector4* clip_positions = frame_allocator_ ? frame_allocator_->Allocate<Vector4>(num_vertices) : NULL;
+		if (clip_positions == NULL)
+		{
+			heap_clip_positions.resize(num_vertices);
+			clip_positions = heap_clip_positions.data();
+		}
+
+		for (UInt32 vertex_num = 0; vertex_num < num_vertices; ++vertex_num)
+		{
+			const Vector4& position = positions[vertex_num];
+			clip_positions[vertex_num] = Vector4(position.x(), position.y(), position.z(), 1.0f).TransformW(world_view_projection);
+		}
+
+		for (UInt32 index = 0; index + 2 < num_indices; index += 3)
+		{
+			if (indices[index] < num_vertices && indices[index + 1] < num_vertices && indices[index + 2] < num_vertices)
+				SetupTriangle(clip_positions[indices[index]], clip_positions[indices[index + 1]], clip_positions[indices[index + 2]]);
+		}
+	}
+
+	void OcclusionCuller::AddOccluder(const Aabb& box, const Matrix44& transform)
+	{
+		static const UInt32 box_indices[36] =
+		{
+			0, 1, 3, 0, 3, 2,	// -x
+			4, 6, 7, 4, 7, 5,	// +x
+			0, 4, 5, 0, 5, 1,	// -y
+			2, 3, 7, 2, 7, 6,	// +y
+			0, 2, 6, 0, 6, 4,	// -z
+			1, 5, 7, 1, 7, 3	// +z
+		};
+
+		Vector4 corners[8];
+		for (int corner_num = 0; corner_num < 8; ++corner_num)
+		{
+			corners[corner_num] = Vector4(
+				(corner_num & 4) ? box.max_vtx().x() : box.min_vtx().x(),
+				(corner_num & 2) ? box.max_vtx().y() : box.min_vtx().y(),
+				(corner_num & 1) ? box.max_vtx().z() : box.min_vtx().z());
+		}
+
+		AddOccluder(corners, 8, box_indices, 36, transform);
+	}
+
+	void OcclusionCuller::SetupTriangle(const Vector4& clip0, const Vector4& clip1, const Vector4& clip2)
+	{
+		const Vector4* clip[3] = { &clip0, &clip1, &clip2 };
+		float x[3], y[3], z[3];
+
+		for (int vertex_num = 0; vertex_num < 3; ++vertex_num)
+		{
+			const Vector4& position = *clip[vertex_num];
+
+			// drop triangles crossing the near plane rather than clipping them
+			// an occluder that is too small only means less gets culled
+			if (position.w() < kMinClipW || position.z() < 0.0f)
+				return;
+
+			float inv_w = 1.0f / position.w();
+			x[vertex_num] = (position.x()*inv_w*0.5f + 0.5f)*(float)width_;
+			y[vertex_num] = (0.5f - position.y()*inv_w*0.5f)*(float)height_;
+			z[vertex_num] = position.z()*inv_w;
+		}
+
+		float area = (x[1] - x[0])*(y[2] - y[0]) - (y[1] - y[0])*(x[2] - x[0]);
+		if (fabsf(area) < 1e-6f)
+			return;
+
+		// occluders are rasterized double sided, so make the winding consistent
+		if (area < 0.0f)
+		{
+			float temp;
+			temp = x[1]; x[1] = x[2]; x[2] = temp;
+			temp = y[1]; y[1] = y[2]; y[2] = temp;
+			temp = z[1]; z[1] = z[2]; z[2] = temp;
+			area = -area;
+		}
+
+		float min_x = fminf(x[0], fminf(x[1], x[2]));
+		float max_x = fmaxf(x[0], fmaxf(x[1], x[2]));
+		float min_y = fminf(y[0], fminf(y[1], y[2]));
+		float max_y = fmaxf(y[0], fmaxf(y[1], y[2]));
+
+		if (max_x < 0.0f || max_y < 0.0f || min_x >= (float)width_ || min_y >= (float)height_)
+			return;
+
+		ScreenTriangle triangle;
+		triangle.min_x = min_x < 0.0f ? 0 : (Int32)min_x;
+		triangle.min_y = min_y < 0.0f ? 0 : (Int32)min_y;
+		triangle.max_x = max_x >= (float)width_ ? width_ - 1 : (Int32)max_x;
+		triangle.max_y = max_y >= (float)height_ ? height_ - 1 : (Int32)max_y;
+
+		// edge i is opposite vertex i, so its value is the unnormalised barycentric weight of vertex i
+		const float inv_area = 1.0f / area;
+		triangle.z_a = 0.0f;
+		triangle.z_b = 0.0f;
+		triangle.z_c = 0.0f;
+		for (int edge_num = 0; edge_num < 3; ++edge_num)
+		{
+			const int a = (edge_num + 1) % 3;
+			const int b = (edge_num + 2) % 3;
+			triangle.edge_a[edge_num] = y[a] - y[b];
+			triangle.edge_b[edge_num] = x[b] - x[a];
+			triangle.edge_c[edge_num] = -(triangle.edge_a[edge_num]*x[a] + triangle.edge_b[edge_num]*y[a]);
+
+			triangle.z_a += triangle.edge_a[edge_num]*z[edge_num]*inv_area;
+			triangle.z_b += triangle.edge_b[edge_num]*z[edge_num]*inv_area;
+			triangle.z_c += triangle.edge_c[edge_num]*z[edge_num]*inv_area;
+		}
+
+		const UInt32 triangle_index = (UInt32)triangles_.size();
+		triangles_.push_back(triangle);
+
+		for (Int32 tile_y = triangle.min_y / kTileHeight; tile_y <= triangle.max_y / kTileHeight; ++tile_y)
+			for (Int32 tile_x = triangle.min_x / kTileWidth; tile_x <= triangle.max_x / kTileWidth; ++tile_x)
+				tile_bins_[tile_y*num_tiles_x_ + tile_x].push_back(triangle_index);
+	}
+
+	void OcclusionCuller::RasterizeOccluders()
+	{
+		ParallelFor((UInt32)tile_bins_.size(), num_threads_, [this](UInt32 begin, UInt32 end)
+		{
+			for (UInt32 tile_index = begin; tile_index < end; ++tile_index)
+				RasterizeTile(tile_index);
+		});
+	}
+
+	void OcclusionCuller::RasterizeTile(Int32 tile_index)
+	{
+		const Int32 tile_min_x = (tile_index % num_tiles_x_)*kTileWidth;
+		const Int32 tile_min_y = (tile_index / num_tiles_x_)*kTileHeight;
+		const Int32 tile_max_x = tile_min_x + kTileWidth - 1;
+		const Int32 tile_max_y = tile_min_y + kTileHeight - 1;
+
+		const __m128 pixel_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (UInt32 triangle_index : tile_bins_[tile_index])
+		{
+			const ScreenTriangle& triangle = triangles_[triangle_index];
+
+			// process 4 pixels at a time, tile bounds are always a multiple of 4
+			const Int32 min_x = (triangle.min_x > tile_min_x ? triangle.min_x : tile_min_x) & ~3;
+			const Int32 max_x = triangle.max_x < tile_max_x ? triangle.max_x : tile_max_x;
+			const Int32 min_y = triangle.min_y > tile_min_y ? triangle.min_y : tile_min_y;
+			const Int32 max_y = triangle.max_y < tile_max_y ? triangle.max_y : tile_max_y;
+
+			const __m128 edge_a0 = _mm_set1_ps(triangle.edge_a[0]);
+			const __m128 edge_a1 = _mm_set1_ps(triangle.edge_a[1]);
+			const __m128 edge_a2 = _mm_set1_ps(triangle.edge_a[2]);
+			const __m128 z_a = _mm_set1_ps(triangle.z_a);
+
+			for (Int32 y = min_y; y <= max_y; ++y)
+			{
+				const float pixel_y = (float)y + 0.5f;
+				const __m128 row_e0 = _mm_set1_ps(triangle.edge_b[0]*pixel_y + triangle.edge_c[0]);
+				const __m128 row_e1 = _mm_set1_ps(triangle.edge_b[1]*pixel_y + triangle.edge_c[1]);
+				const __m128 row_e2 = _mm_set1_ps(triangle.edge_b[2]*pixel_y + triangle.edge_c[2]);
+				const __m128 row_z = _mm_set1_ps(triangle.z_b*pixel_y + triangle.z_c);
+				float* depth_row = &depth_buffer_[y*width_];
+
+				for (Int32 x = min_x; x <= max_x; x += 4)
+				{
+					const __m128 pixel_x = _mm_add_ps(_mm_set1_ps((float)x), pixel_offsets);
+
+					const __m128 e0 = _mm_add_ps(_mm_mul_ps(edge_a0, pixel_x), row_e0);
+					const __m128 e1 = _mm_add_ps(_mm_mul_ps(edge_a1, pixel_x), row_e1);
+					const __m128 e2 = _mm_add_ps(_mm_mul_ps(edge_a2, pixel_x), row_e2);
+					const __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+					if (_mm_movemask_ps(inside) == 0)
+						continue;
+
+					const __m128 depth = _mm_add_ps(_mm_mul_ps(z_a, pixel_x), row_z);
+					const __m128 current_depth = _mm_loadu_ps(depth_row + x);
+					const __m128 nearest_depth = _mm_min_ps(current_depth, depth);
+					_mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(inside, nearest_depth), _mm_andnot_ps(inside, current_depth)));
+				}
+			}
+		}
+	}
+
+	bool OcclusionCuller::IsVisible(const Aabb& aabb, const Matrix44& transform) const
+	{
+		const Vector4& box_min = aabb.min_vtx();
+		const Vector4& box_max = aabb.max_vtx();
+
+		// uninitialised bounds, can't say anything about this object
+		if (box_min.x() > box_max.x() || box_min.y() > box_max.y() || box_min.z() > box_max.z())
+			return true;
+
+		const Matrix44 world_view_projection = transform * view_projection_;
+
+		float min_x = (float)width_, max_x = -1.0f;
+		float min_y = (float)height_, max_y = -1.0f;
+		float min_z = 1.0f;
+		for (int corner_num = 0; corner_num < 8; ++corner_num)
+		{
+			Vector4 corner(
+				(corner_num & 4) ? box_max.x() : box_min.x(),
+				(corner_num & 2) ? box_max.y() : box_min.y(),
+				(corner_num & 1) ? box_max.z() : box_min.z(),
+				1.0f);
+			Vector4 clip = corner.TransformW(world_view_projection);
+
+			// box crosses the near plane
+			if (clip.w() < kMinClipW || clip.z() < 0.0f)
+				return true;
+
+			float inv_w = 1.0f / clip.w();
+			float x = (clip.x()*inv_w*0.5f + 0.5f)*(float)width_;
+			float y = (0.5f - clip.y()*inv_w*0.5f)*(float)height_;
+			float z = clip.z()*inv_w;
+
+			min_x = fminf(min_x, x);
+			max_x = fmaxf(max_x, x);
+			min_y = fminf(min_y, y);
+			max_y = fmaxf(max_y, y);
+			min_z = fminf(min_z, z);
+		}
+
+		// completely off screen
+		if (max_x < 0.0f || max_y < 0.0f || min_x >= (float)width_ || min_y >= (float)height_)
+			return false;
+
+		// widen the test rectangle to 4 pixel boundaries, testing extra pixels can only make the result more conservative
+		const Int32 rect_min_x = (min_x < 0.0f ? 0 : (Int32)min_x) & ~3;
+		const Int32 rect_max_x = max_x >= (float)width_ ? width_ - 1 : (Int32)max_x;
+		const Int32 rect_min_y = min_y < 0.0f ? 0 : (Int32)min_y;
+		const Int32 rect_max_y = max_y >= (float)height_ ? height_ - 1 : (Int32)max_y;
+
+		const __m128 box_depth = _mm_set1_ps(min_z);
+		for (Int32 y = rect_min_y; y <= rect_max_y; ++y)
+		{
+			const float* depth_row = &depth_buffer_[y*width_];
+			for (Int32 x = rect_min_x; x <= rect_max_x; x += 4)
+			{
+				// visible if the nearest point of the box is in front of any occluder pixel
+				if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(depth_row + x), box_depth)))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool OcclusionCuller::IsVisible(const MeshInstance& mesh_instance) const
+	{
+		const Mesh* mesh = mesh_instance.mesh();
+		if (mesh == NULL)
+			return true;
+
+		return IsVisible(mesh->aabb(), mesh_instance.transform());
+	}
+
+	void OcclusionCuller::TestVisibility(const MeshInstance* const* mesh_instances, UInt32 count, bool* visible) const
+	{
+		ParallelFor(count, num_threads_, [this, mesh_instances, visible](UInt32 begin, UInt32 end)
+		{
+			for (UInt32 instance_num = begin; instance_num < end; ++instance_num)
+				visible[instance_num] = IsVisible(*mesh_instances[instance_num]);
+		});
+	}
+}
@@ -0,0 +1,113 @@
+#ifndef _GEF_OCCLUSION_CULLER_H
+#define _GEF_OCCLUSION_CULLER_H
+
+#include <gef.h>
+#include <maths/matrix44.h>
+#include <vector>
+
+namespace gef
+{
+	class Aabb;
+	class MeshInstance;
+	class FrameAllocator;
+
+	/**
+	Software occlusion culling.
+	A small set of low polygon occluders is rasterized on the CPU into a low resolution depth buffer.
+	Bounding boxes can then be tested against the depth buffer to find objects that are completely hidden.
+	Rasterization is split into screen tiles which are processed on multiple threads.
+	The depth buffer uses the Direct3D convention, 0 is the near plane and 1 is the far plane.
+	*/
+	class OcclusionCuller
+	{
+	public:
+		/// @brief Constructor.
+		/// @param[in] width		The width of the depth buffer in pixels. Rounded up to a multiple of the tile width.
+		/// @param[in] height		The height of the depth buffer in pixels. Rounded up to a multiple of the tile height.
+		/// @param[in] num_threads	The number of threads used to rasterize occluders. 0 uses all hardware threads.
+		OcclusionCuller(Int32 width = 256, Int32 height = 128, UInt32 num_threads = 0);
+
+		/// @brief Clear all occluders and the depth buffer, ready for a new frame.
+		/// @param[in] view_projection	The view projection matrix used for rasterization and visibility tests.
+		void Begin(const Matrix44& view_projection);
+
+		/// @brief Add an indexed triangle list occluder.
+		/// @param[in] positions		The vertex positions. Only the xyz components are used.
+		/// @param[in] num_vertices		The number of vertex positions.
+		/// @param[in] indices			Three indices per triangle.
+		/// @param[in] num_indices		The number of indices.
+		/// @param[in] transform		The occluder world transform.
+		/// @note Occluders must lie completely inside the objects they represent.
+		/// Triangles crossing the near plane are skipped, which keeps the culling conservative.
+		void AddOccluder(const Vector4* positions, UInt32 num_vertices, const UInt32* indices, UInt32 num_indices, const Matrix44& transform);
+
+		/// @brief Add a box occluder.
+		/// @param[in] box			The box bounds.
+		/// @param[in] transform	The occluder world transform.
+		void AddOccluder(const Aabb& box, const Matrix44& transform);
+
+		/// @brief Rasterize all occluders added since Begin into the depth buffer.
+		void RasterizeOccluders();
+
+		/// @brief Test a bounding box against the depth buffer.
+		/// @param[in] aabb			The bounding box, in object space.
+		/// @param[in] transform	The object world transform.
+		/// @return true if any part of the box may be visible, false if it is completely hidden by occluders.
+		/// @note Safe to call from multiple threads once RasterizeOccluders has returned.
+		bool IsVisible(const Aabb& aabb, const Matrix44& transform) const;
+
+		/// @brief Test the bounds of a mesh instance against the depth buffer.
+		/// @param[in] mesh_instance	The mesh instance. Uses Mesh::aabb and MeshInstance::transform.
+		/// @return true if the mesh instance may be visible.
+		bool IsVisible(const MeshInstance& mesh_instance) const;
+
+		/// @brief Test many mesh instances, spread over multiple threads.
+		/// @param[in] mesh_instances	The mesh instances to test.
+		/// @param[in] count			The number of mesh instances.
+		/// @param[out] visible			Receives the result of IsVisible for each mesh instance.
+		void TestVisibility(const MeshInstance* const* mesh_instances, UInt32 count, bool* visible) const;
+
+		inline Int32 width() const { return width_; }
+		inline Int32 height() const { return height_; }
+		inline const float* depth_buffer() const { return depth_buffer_.data(); }
+		inline UInt32 num_occluder_triangles() const { return (UInt32)triangles_.size(); }
+		inline UInt32 num_threads() const { return num_threads_; }
+		inline void set_num_threads(UInt32 num_threads) { num_threads_ = num_threads; }
+		/// @brief Set the allocator used for per occluder scratch data, e.g. Platform::frame_allocator.
+		/// @param[in] frame_allocator	The allocator, or NULL to allocate from the heap.
+		inline void set_frame_allocator(FrameAllocator* frame_allocator) { frame_allocator_ = frame_allocator; }
+
+		static const Int32 kTileWidth = 64;
+		static const Int32 kTileHeight = 32;
+
+	private:
+		struct ScreenTriangle
+		{
+			// edge equations, E(x, y) = a*x + b*y + c
+			float edge_a[3];
+			float edge_b[3];
+			float edge_c[3];
+			// depth plane, z(x, y) = z_a*x + z_b*y + z_c
+			float z_a;
+			float z_b;
+			float z_c;
+			Int32 min_x, min_y, max_x, max_y;
+		};
+
+		void SetupTriangle(const Vector4& clip0, const Vector4& clip1, const Vector4& clip2);
+		void RasterizeTile(Int32 tile_index);
+
+		Int32 width_;
+		Int32 height_;
+		Int32 num_tiles_x_;
+		Int32 num_tiles_y_;
+		UInt32 num_threads_;
+		FrameAllocator* frame_allocator_;
+		Matrix44 view_projection_;
+		std::vector<float> depth_buffer_;
+		std::vector<ScreenTriangle> triangles_;
+		std::vector<std::vector<UInt32>> tile_bins_;
+	};
+}
+
+#endif // _GEF_OCCLUSION_CULLER_H
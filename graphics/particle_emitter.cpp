@@ -0,0 +1,198 @@
+#include <graphics/particle_emitter.h>
+#include <graphics/sprite_renderer.h>
+#include <emmintrin.h>
+#include <math.h>
+
+namespace gef
+{
+	namespace
+	{
+		const UInt32 kParticlesPerGroup = 4;
+		const float kMinLifetime = 0.001f;
+	}
+
+	ParticleEmitter::ParticleEmitter(UInt32 max_particles) :
+		num_particles_(0),
+		max_particles_(max_particles),
+		position_(0.0f, 0.0f),
+		emit_rate_(0.0f),
+		emit_remainder_(0.0f),
+		direction_(0.0f),
+		spread_(FRAMEWORK_PI),
+		min_speed_(0.0f),
+		max_speed_(0.0f),
+		min_lifetime_(1.0f),
+		max_lifetime_(1.0f),
+		min_angular_velocity_(0.0f),
+		max_angular_velocity_(0.0f),
+		acceleration_(0.0f, 0.0f),
+		start_size_(1.0f),
+		end_size_(1.0f),
+		start_colour_(1.0f, 1.0f, 1.0f, 1.0f),
+		end_colour_(1.0f, 1.0f, 1.0f, 1.0f),
+		texture_(NULL),
+		random_state_(1)
+	{
+		// the whole pool is allocated up front, so the sprite arrays never move
+		// unused slots are zero so the SIMD update of a partial group stays finite
+		const UInt32 capacity = (max_particles_ + kParticlesPerGroup - 1) & ~(kParticlesPerGroup - 1);
+		x_.resize(capacity, 0.0f);
+		y_.resize(capacity, 0.0f);
+		velocity_x_.resize(capacity, 0.0f);
+		velocity_y_.resize(capacity, 0.0f);
+		rotation_.resize(capacity, 0.0f);
+		angular_velocity_.resize(capacity, 0.0f);
+		age_.resize(capacity, 0.0f);
+		inv_lifetime_.resize(capacity, 0.0f);
+		size_.resize(capacity, 0.0f);
+		colour_.resize(capacity, 0);
+
+		sprite_arrays_.x = x_.data();
+		sprite_arrays_.y = y_.data();
+		sprite_arrays_.width = size_.data();
+		sprite_arrays_.height = size_.data();
+		sprite_arrays_.rotation = rotation_.data();
+		sprite_arrays_.colour = colour_.data();
+	}
+
+	void ParticleEmitter::Clear()
+	{
+		num_particles_ = 0;
+		emit_remainder_ = 0.0f;
+	}
+
+	float ParticleEmitter::Random(float min_value, float max_value)
+	{
+		// xorshift32
+		random_state_ ^= random_state_ << 13;
+		random_state_ ^= random_state_ >> 17;
+		random_state_ ^= random_state_ << 5;
+		return min_value + (max_value - min_value) * ((float)(random_state_ >> 8) * (1.0f / 16777216.0f));
+	}
+
+	UInt32 ParticleEmitter::Emit(UInt32 count)
+	{
+		if (count > max_particles_ - num_particles_)
+			count = max_particles_ - num_particles_;
+
+		const UInt32 colour = start_colour_.GetABGR();
+		for (UInt32 emit_num = 0; emit_num < count; ++emit_num)
+		{
+			const UInt32 particle = num_particles_++;
+			const float angle = direction_ + Random(-spread_, spread_);
+			const float speed = Random(min_speed_, max_speed_);
+			const float lifetime = Random(min_lifetime_, max_lifetime_);
+
+			x_[particle] = position_.x;
+			y_[particle] = position_.y;
+			velocity_x_[particle] = cosf(angle) * speed;
+			velocity_y_[particle] = sinf(angle) * speed;
+			rotation_[particle] = 0.0f;
+			angular_velocity_[particle] = Random(min_angular_velocity_, max_angular_velocity_);
+			age_[particle] = 0.0f;
+			inv_lifetime_[particle] = 1.0f / (lifetime > kMinLifetime ? lifetime : kMinLifetime);
+			size_[particle] = start_size_;
+			colour_[particle] = colour;
+		}
+		return count;
+	}
+
+	void ParticleEmitter::Update(float delta_time)
+	{
+		UpdateParticles(delta_time);
+
+		emit_remainder_ += emit_rate_ * delta_time;
+		const UInt32 emit_count = (UInt32)emit_remainder_;
+		emit_remainder_ -= (float)emit_count;
+		Emit(emit_count);
+	}
+
+	void ParticleEmitter::UpdateParticles(float delta_time)
+	{
+		const __m128 dt = _mm_set1_ps(delta_time);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 velocity_step_x = _mm_set1_ps(acceleration_.x * delta_time);
+		const __m128 velocity_step_y = _mm_set1_ps(acceleration_.y * delta_time);
+		const __m128 start_size = _mm_set1_ps(start_size_);
+		const __m128 size_range = _mm_set1_ps(end_size_ - start_size_);
+
+		// colour channels are blended in the 0 to 255 range and packed to ABGR bytes
+		const __m128 start_r = _mm_set1_ps(start_colour_.r * 255.0f);
+		const __m128 start_g = _mm_set1_ps(start_colour_.g * 255.0f);
+		const __m128 start_b = _mm_set1_ps(start_colour_.b * 255.0f);
+		const __m128 start_a = _mm_set1_ps(start_colour_.a * 255.0f);
+		const __m128 range_r = _mm_set1_ps((end_colour_.r - start_colour_.r) * 255.0f);
+		const __m128 range_g = _mm_set1_ps((end_colour_.g - start_colour_.g) * 255.0f);
+		const __m128 range_b = _mm_set1_ps((end_colour_.b - start_colour_.b) * 255.0f);
+		const __m128 range_a = _mm_set1_ps((end_colour_.a - start_colour_.a) * 255.0f);
+		const __m128i byte_mask = _mm_set1_epi32(0xff);
+
+		int any_dead = 0;
+		for (UInt32 particle = 0; particle < num_particles_; particle += kParticlesPerGroup)
+		{
+			__m128 velocity_x = _mm_add_ps(_mm_loadu_ps(&velocity_x_[particle]), velocity_step_x);
+			__m128 velocity_y = _mm_add_ps(_mm_loadu_ps(&velocity_y_[particle]), velocity_step_y);
+			_mm_storeu_ps(&velocity_x_[particle], velocity_x);
+			_mm_storeu_ps(&velocity_y_[particle], velocity_y);
+			_mm_storeu_ps(&x_[particle], _mm_add_ps(_mm_loadu_ps(&x_[particle]), _mm_mul_ps(velocity_x, dt)));
+			_mm_storeu_ps(&y_[particle], _mm_add_ps(_mm_loadu_ps(&y_[particle]), _mm_mul_ps(velocity_y, dt)));
+			_mm_storeu_ps(&rotation_[particle], _mm_add_ps(_mm_loadu_ps(&rotation_[particle]), _mm_mul_ps(_mm_loadu_ps(&angular_velocity_[particle]), dt)));
+
+			const __m128 age = _mm_add_ps(_mm_loadu_ps(&age_[particle]), dt);
+			_mm_storeu_ps(&age_[particle], age);
+
+			// fraction of the lifetime used, dead particles are removed after the loop
+			const __m128 life = _mm_mul_ps(age, _mm_loadu_ps(&inv_lifetime_[particle]));
+			const UInt32 lanes = num_particles_ - particle;
+			const int lane_mask = lanes >= kParticlesPerGroup ? 0xf : (1 << lanes) - 1;
+			any_dead |= _mm_movemask_ps(_mm_cmpge_ps(life, one)) & lane_mask;
+			const __m128 t = _mm_min_ps(life, one);
+
+			_mm_storeu_ps(&size_[particle], _mm_add_ps(start_size, _mm_mul_ps(size_range, t)));
+
+			const __m128i r = _mm_cvtps_epi32(_mm_add_ps(start_r, _mm_mul_ps(range_r, t)));
+			const __m128i g = _mm_cvtps_epi32(_mm_add_ps(start_g, _mm_mul_ps(range_g, t)));
+			const __m128i b = _mm_cvtps_epi32(_mm_add_ps(start_b, _mm_mul_ps(range_b, t)));
+			const __m128i a = _mm_cvtps_epi32(_mm_add_ps(start_a, _mm_mul_ps(range_a, t)));
+			__m128i colour = _mm_and_si128(r, byte_mask);
+			colour = _mm_or_si128(colour, _mm_slli_epi32(_mm_and_si128(g, byte_mask), 8));
+			colour = _mm_or_si128(colour, _mm_slli_epi32(_mm_and_si128(b, byte_mask), 16));
+			colour = _mm_or_si128(colour, _mm_slli_epi32(a, 24));
+			_mm_storeu_si128((__m128i*)&colour_[particle], colour);
+		}
+
+		if (any_dead)
+			RemoveDeadParticles();
+	}
+
+	void ParticleEmitter::RemoveDeadParticles()
+	{
+		UInt32 particle = 0;
+		while (particle < num_particles_)
+		{
+			if (age_[particle] * inv_lifetime_[particle] < 1.0f)
+			{
+				++particle;
+				continue;
+			}
+
+			const UInt32 last = --num_particles_;
+			x_[particle] = x_[last];
+			y_[particle] = y_[last];
+			velocity_x_[particle] = velocity_x_[last];
+			velocity_y_[particle] = velocity_y_[last];
+			rotation_[particle] = rotation_[last];
+			angular_velocity_[particle] = angular_velocity_[last];
+			age_[particle] = age_[last];
+			inv_lifetime_[particle] = inv_lifetime_[last];
+			size_[particle] = size_[last];
+			colour_[particle] = colour_[last];
+		}
+	}
+
+	void ParticleEmitter::Draw(SpriteRenderer& sprite_renderer) const
+	{
+		if (num_particles_ > 0)
+			sprite_renderer.DrawSprites(sprite_arrays_, num_particles_, texture_);
+	}
+}
@@ -0,0 +1,124 @@
+#ifndef _GEF_PARTICLE_EMITTER_H
+#define _GEF_PARTICLE_EMITTER_H
+
+#include <gef.h>
+#include <graphics/colour.h>
+#include <graphics/sprite_batch.h>
+#include <maths/vector2.h>
+#include <vector>
+
+namespace gef
+{
+	class SpriteRenderer;
+	class Texture;
+
+	/**
+	Emits sprite particles and moves them on the CPU.
+	Particles are stored as one array per attribute in a pool with a fixed capacity,
+	and are updated four at a time with SSE2. Colour and size are blended from their start
+	to their end values over the lifetime of each particle.
+	The arrays are drawn with SpriteRenderer::DrawSprites, so with batching on an emitter
+	is drawn with one batched submission instead of one DrawSprite call per particle.
+	Each emitter has its own random number generator, so different emitters can be updated
+	on different threads, see ParticleSystem.
+	*/
+	class ParticleEmitter
+	{
+	public:
+		/// @param[in] max_particles	The size of the particle pool. Particles are not emitted while the pool is full.
+		ParticleEmitter(UInt32 max_particles);
+		// the sprite arrays point into the particle pool
+		ParticleEmitter(const ParticleEmitter&) = delete;
+		ParticleEmitter& operator=(const ParticleEmitter&) = delete;
+
+		/// @brief Moves the particles, removes those that have reached the end of their lifetime and emits new ones.
+		/// @param[in] delta_time	The time since the last update in seconds.
+		void Update(float delta_time);
+
+		/// @brief Emits particles immediately, e.g. for an explosion.
+		/// @return The number of particles emitted, fewer than count if the pool is full.
+		UInt32 Emit(UInt32 count);
+
+		/// @brief Removes all particles.
+		void Clear();
+
+		/// @brief Draws the particles with a sprite renderer, between its Begin and End.
+		void Draw(SpriteRenderer& sprite_renderer) const;
+
+		inline UInt32 num_particles() const { return num_particles_; }
+		inline UInt32 max_particles() const { return max_particles_; }
+		/// @brief The particles as sprite arrays, valid until the next call to Update or Emit.
+		inline const SpriteArrays& sprite_arrays() const { return sprite_arrays_; }
+
+		/// Where particles are emitted from.
+		inline const Vector2& position() const { return position_; }
+		inline void set_position(const Vector2& position) { position_ = position; }
+		/// Particles emitted per second by Update.
+		inline float emit_rate() const { return emit_rate_; }
+		inline void set_emit_rate(float emit_rate) { emit_rate_ = emit_rate; }
+		/// Direction particles are emitted in, in radians, and the random spread either side of it.
+		inline void set_direction(float direction, float spread) { direction_ = direction; spread_ = spread; }
+		/// Random range of the speed particles are emitted with, in units per second.
+		inline void set_speed(float min_speed, float max_speed) { min_speed_ = min_speed; max_speed_ = max_speed; }
+		/// Random range of the lifetime of the particles, in seconds.
+		inline void set_lifetime(float min_lifetime, float max_lifetime) { min_lifetime_ = min_lifetime; max_lifetime_ = max_lifetime; }
+		/// Random range of the rotation speed of the particles, in radians per second.
+		inline void set_angular_velocity(float min_angular_velocity, float max_angular_velocity) { min_angular_velocity_ = min_angular_velocity; max_angular_velocity_ = max_angular_velocity; }
+		/// Acceleration applied to every particle, e.g. gravity.
+		inline const Vector2& acceleration() const { return acceleration_; }
+		inline void set_acceleration(const Vector2& acceleration) { acceleration_ = acceleration; }
+		/// Width and height of the particles when emitted and at the end of their lifetime.
+		inline void set_size(float start_size, float end_size) { start_size_ = start_size; end_size_ = end_size; }
+		/// Colour of the particles when emitted and at the end of their lifetime.
+		inline void set_colour(const Colour& start_colour, const Colour& end_colour) { start_colour_ = start_colour; end_colour_ = end_colour; }
+		inline const Texture* texture() const { return texture_; }
+		inline void set_texture(const Texture* texture) { texture_ = texture; }
+		inline void set_random_seed(UInt32 seed) { random_state_ = seed != 0 ? seed : 1; }
+
+	private:
+		// random float in [min_value, max_value]
+		float Random(float min_value, float max_value);
+
+		// moves and blends all particles four at a time
+		void UpdateParticles(float delta_time);
+		// removes particles past the end of their lifetime by moving the last particle into their place
+		void RemoveDeadParticles();
+
+		// particle attributes, the size of each is rounded up to a multiple of four for the SIMD update
+		std::vector<float> x_;
+		std::vector<float> y_;
+		std::vector<float> velocity_x_;
+		std::vector<float> velocity_y_;
+		std::vector<float> rotation_;
+		std::vector<float> angular_velocity_;
+		std::vector<float> age_;
+		std::vector<float> inv_lifetime_;
+		std::vector<float> size_;
+		std::vector<UInt32> colour_;
+
+		UInt32 num_particles_;
+		UInt32 max_particles_;
+		SpriteArrays sprite_arrays_;
+
+		Vector2 position_;
+		float emit_rate_;
+		float emit_remainder_;
+		float direction_;
+		float spread_;
+		float min_speed_;
+		float max_speed_;
+		float min_lifetime_;
+		float max_lifetime_;
+		float min_angular_velocity_;
+		float max_angular_velocity_;
+		Vector2 acceleration_;
+		float start_size_;
+		float end_size_;
+		Colour start_colour_;
+		Colour end_colour_;
+		const Texture* texture_;
+		UInt32 random_state_;
+	};
+}
+
+#endif // _GEF_PARTICLE_EMITTER_H
@@ -0,0 +1,47 @@
+#include <graphics/particle_system.h>
+#include <graphics/particle_emitter.h>
+#include <system/parallel_for.h>
+#include <algorithm>
+
+namespace gef
+{
+	ParticleSystem::ParticleSystem(UInt32 num_threads) :
+		num_threads_(num_threads)
+	{
+	}
+
+	void ParticleSystem::AddEmitter(ParticleEmitter* emitter)
+	{
+		emitters_.push_back(emitter);
+	}
+
+	void ParticleSystem::RemoveEmitter(ParticleEmitter* emitter)
+	{
+		std::vector<ParticleEmitter*>::iterator emitter_iter = std::find(emitters_.begin(), emitters_.end(), emitter);
+		if (emitter_iter != emitters_.end())
+			emitters_.erase(emitter_iter);
+	}
+
+	void ParticleSystem::Update(float delta_time)
+	{
+		ParallelFor((UInt32)emitters_.size(), num_threads_, [this, delta_time](UInt32 begin, UInt32 end)
+		{
+			for (UInt32 emitter_num = begin; emitter_num < end; ++emitter_num)
+				emitters_[emitter_num]->Update(delta_time);
+		});
+	}
+
+	void ParticleSystem::Draw(SpriteRenderer& sprite_renderer) const
+	{
+		for (const ParticleEmitter* emitter : emitters_)
+			emitter->Draw(sprite_renderer);
+	}
+
+	UInt32 ParticleSystem::num_particles() const
+	{
+		UInt32 num_particles = 0;
+		for (const ParticleEmitter* emitter : emitters_)
+			num_particles += emitter->num_particles();
+		return num_particles;
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef _GEF_PARTICLE_SYSTEM_H
+#define _GEF_PARTICLE_SYSTEM_H
+
+#include <gef.h>
+#include <vector>
+
+namespace gef
+{
+	class ParticleEmitter;
+	class SpriteRenderer;
+
+	/**
+	Updates and draws a set of particle emitters.
+	Emitters are independent, so they are updated in parallel with a contiguous range of emitters per thread.
+	Drawing stays on the calling thread, one DrawSprites call per emitter in the order they were added.
+	*/
+	class ParticleSystem
+	{
+	public:
+		/// @param[in] num_threads	The number of threads emitters are updated on. 0 uses all hardware threads.
+		ParticleSystem(UInt32 num_threads = 0);
+
+		/// @brief Adds an emitter. The emitter is not owned and must stay valid until it is removed.
+		void AddEmitter(ParticleEmitter* emitter);
+		void RemoveEmitter(ParticleEmitter* emitter);
+
+		/// @brief Updates all emitters.
+		/// @param[in] delta_time	The time since the last update in seconds.
+		void Update(float delta_time);
+
+		/// @brief Draws all emitters with a sprite renderer, between its Begin and End.
+		void Draw(SpriteRenderer& sprite_renderer) const;
+
+		/// @return The number of live particles in all emitters.
+		UInt32 num_particles() const;
+
+		inline const std::vector<ParticleEmitter*>& emitters() const { return emitters_; }
+		inline UInt32 num_threads() const { return num_threads_; }
+		inline void set_num_threads(UInt32 num_threads) { num_threads_ = num_threads; }
+
+	private:
+		std::vector<ParticleEmitter*> emitters_;
+		UInt32 num_threads_;
+	};
+}
+
+#endif // _GEF_PARTICLE_SYSTEM_H
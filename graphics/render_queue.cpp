@@ -0,0 +1,363 @@
+#include <graphics/render_queue.h>
+#include <graphics/renderer_3d.h>
+#include <graphics/mesh_instance.h>
+#include <graphics/mesh.h>
+#include <graphics/primitive.h>
+#include <graphics/material.h>
+#include <graphics/occlusion_culler.h>
+#include <maths/frustum.h>
+#include <maths/aabb.h>
+#include <system/parallel_for.h>
+#include <cstring>
+
+namespace gef
+{
+	static const UInt32 kDepthShift = 0;
+	static const UInt32 kMeshShift = kDepthShift + RenderQueue::kDepthBits;
+	static const UInt32 kMaterialShift = kMeshShift + RenderQueue::kMeshBits;
+	static const UInt32 kTextureShift = kMaterialShift + RenderQueue::kMaterialBits;
+	static const UInt32 kLitShift = kTextureShift + RenderQueue::kTextureBits;
+	static const UInt32 kShaderShift = kLitShift + RenderQueue::kLitBits;
+	static_assert(kShaderShift + RenderQueue::kShaderBits == 64, "RenderQueue sort key fields must fill 64 bits");
+
+	static inline UInt64 FieldMask(UInt32 num_bits)
+	{
+		return (((UInt64)1) << num_bits) - 1;
+	}
+
+	RenderQueue::RenderQueue() :
+		frustum_(NULL)
+	{
+		memset(&stats_, 0, sizeof(Stats));
+	}
+
+	UInt32 RenderQueue::GetId(std::unordered_map<const void*, UInt32>& ids, const void* object, UInt32 num_bits)
+	{
+		auto id = ids.find(object);
+		if (id != ids.end())
+			return id->second;
+
+		// once the field is full all further objects share the last id
+		// this only reduces how well draws are grouped, batching compares the objects themselves
+		const UInt32 max_id = (UInt32)FieldMask(num_bits);
+		UInt32 new_id = ids.size() < max_id ? (UInt32)ids.size() : max_id;
+		ids[object] = new_id;
+		return new_id;
+	}
+
+	bool RenderQueue::IsCulled(const Renderer3D& renderer, const Aabb& world_aabb)
+	{
+		if ((frustum_ && frustum_->Intersects(world_aabb) == FI_OUT) ||
+			(renderer.occlusion_culler() && !renderer.occlusion_culler()->IsVisible(world_aabb, Matrix44::MakeIdentity())))
+		{
+			stats_.num_culled++;
+			return true;
+		}
+		return false;
+	}
+
+	void RenderQueue::DrawMesh(const Renderer3D& renderer, const MeshInstance& mesh_instance)
+	{
+		if (mesh_instance.mesh() == NULL)
+			return;
+
+		// use the cached bounds of the instance when culling
+		if ((frustum_ || renderer.occlusion_culler()) && IsCulled(renderer, mesh_instance.world_aabb()))
+			return;
+
+		AddDraw(renderer, *mesh_instance.mesh(), mesh_instance.transform(), mesh_instance.lit());
+	}
+
+	void RenderQueue::DrawMesh(const Renderer3D& renderer, const Mesh& mesh, const Matrix44& transform, bool lit)
+	{
+		if ((frustum_ || renderer.occlusion_culler()) && IsCulled(renderer, mesh.aabb().Transform(transform)))
+			return;
+
+		AddDraw(renderer, mesh, transform, lit);
+	}
+
+	void RenderQueue::AddDraw(const Renderer3D& renderer, const Mesh& mesh, const Matrix44& transform, bool lit)
+	{
+		Draw draw;
+		draw.transform = transform;
+		draw.mesh = &mesh;
+		draw.shader = renderer.shader();
+		draw.override_material = renderer.override_material();
+		draw.lit = lit;
+
+		// the first primitive's material stands in for the whole mesh
+		const Material* material = draw.override_material;
+		if (material == NULL && mesh.num_primitives() > 0)
+			material = mesh.GetPrimitive(0)->material();
+		const Texture* texture = material ? material->texture_diffuse() : NULL;
+
+		draw.state_key =
+			((UInt64)GetId(shader_ids_, draw.shader, kShaderBits) << kShaderShift) |
+			((UInt64)(lit ? 0 : 1) << kLitShift) |
+			((UInt64)GetId(texture_ids_, texture, kTextureBits) << kTextureShift) |
+			((UInt64)GetId(material_ids_, material, kMaterialBits) << kMaterialShift) |
+			((UInt64)GetId(mesh_ids_, &mesh, kMeshBits) << kMeshShift);
+
+		draws_.push_back(draw);
+	}
+
+	void RenderQueue::Clear()
+	{
+		draws_.clear();
+		shader_ids_.clear();
+		texture_ids_.clear();
+		material_ids_.clear();
+		mesh_ids_.clear();
+	}
+
+	void RenderQueue::BuildIdRemap(std::unordered_map<const void*, UInt32>& ids, const std::unordered_map<const void*, UInt32>& other_ids, UInt32 num_bits, std::vector<UInt32>& remap)
+	{
+		const UInt32 max_id = (UInt32)FieldMask(num_bits);
+		const UInt32 num_ids = other_ids.size() <= max_id ? (UInt32)other_ids.size() : max_id + 1;
+
+		// put the objects in the order the other queue first saw them
+		// so ids are assigned in the same order as recording everything into this queue
+		remap_objects_.assign(num_ids, NULL);
+		for (auto& other_id : other_ids)
+			remap_objects_[other_id.second] = other_id.first;
+
+		remap.resize(num_ids);
+		for (UInt32 id = 0; id < num_ids; ++id)
+		{
+			// objects sharing the last id in the other queue keep sharing it here
+			remap[id] = id == max_id ? max_id : GetId(ids, remap_objects_[id], num_bits);
+		}
+	}
+
+	void RenderQueue::Append(const RenderQueue& queue)
+	{
+		stats_.num_culled += queue.stats_.num_culled;
+		if (queue.draws_.empty())
+			return;
+
+		// ids are assigned per queue, so translate the other queue's ids to this queue's
+		static const UInt32 field_shifts[] = { kShaderShift, kTextureShift, kMaterialShift, kMeshShift };
+		static const UInt32 field_bits[] = { kShaderBits, kTextureBits, kMaterialBits, kMeshBits };
+		BuildIdRemap(shader_ids_, queue.shader_ids_, kShaderBits, id_remaps_[0]);
+		BuildIdRemap(texture_ids_, queue.texture_ids_, kTextureBits, id_remaps_[1]);
+		BuildIdRemap(material_ids_, queue.material_ids_, kMaterialBits, id_remaps_[2]);
+		BuildIdRemap(mesh_ids_, queue.mesh_ids_, kMeshBits, id_remaps_[3]);
+
+		const size_t first_draw = draws_.size();
+		draws_.insert(draws_.end(), queue.draws_.begin(), queue.draws_.end());
+		for (size_t draw_num = first_draw; draw_num < draws_.size(); ++draw_num)
+		{
+			UInt64& state_key = draws_[draw_num].state_key;
+			UInt64 remapped_key = state_key & (FieldMask(kLitBits) << kLitShift);
+			for (UInt32 field_num = 0; field_num < 4; ++field_num)
+			{
+				UInt32 id = (UInt32)((state_key >> field_shifts[field_num]) & FieldMask(field_bits[field_num]));
+				remapped_key |= (UInt64)id_remaps_[field_num][id] << field_shifts[field_num];
+			}
+			state_key = remapped_key;
+		}
+	}
+
+	void RenderQueue::RecordParallel(UInt32 count, UInt32 num_threads, const std::function<void(RenderQueue& queue, UInt32 begin, UInt32 end)>& record)
+	{
+		if (count == 0)
+			return;
+
+		if (num_threads == 0)
+			num_threads = GetNumHardwareThreads();
+		if (num_threads > count)
+			num_threads = count;
+
+		const UInt32 chunk_size = (count + num_threads - 1) / num_threads;
+		const UInt32 num_chunks = (count + chunk_size - 1) / chunk_size;
+
+		while (thread_queues_.size() < num_chunks)
+			thread_queues_.push_back(std::unique_ptr<RenderQueue>(new RenderQueue()));
+		for (UInt32 chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+			thread_queues_[chunk_num]->set_frustum(frustum_);
+
+		ParallelFor(num_chunks, num_chunks, [&](UInt32 begin, UInt32 end)
+		{
+			for (UInt32 chunk_num = begin; chunk_num < end; ++chunk_num)
+			{
+				UInt32 chunk_begin = chunk_num * chunk_size;
+				UInt32 chunk_end = chunk_begin + chunk_size < count ? chunk_begin + chunk_size : count;
+				record(*thread_queues_[chunk_num], chunk_begin, chunk_end);
+			}
+		});
+
+		for (UInt32 chunk_num = 0; chunk_num < num_chunks; ++chunk_num)
+		{
+			RenderQueue& thread_queue = *thread_queues_[chunk_num];
+			Append(thread_queue);
+			thread_queue.Clear();
+			thread_queue.GetAndResetStats();
+		}
+	}
+
+	RenderQueue::Stats RenderQueue::GetAndResetStats()
+	{
+		Stats stats = stats_;
+		memset(&stats_, 0, sizeof(Stats));
+		return stats;
+	}
+
+	UInt32 RenderQueue::CountStateChanges(const UInt64* keys, const UInt32* order, UInt32 count)
+	{
+		static const UInt32 field_shifts[] = { kShaderShift, kLitShift, kTextureShift, kMaterialShift, kMeshShift };
+		static const UInt32 field_bits[] = { kShaderBits, kLitBits, kTextureBits, kMaterialBits, kMeshBits };
+
+		UInt32 state_changes = 0;
+		for (UInt32 draw_num = 1; draw_num < count; ++draw_num)
+		{
+			UInt64 previous_key = keys[order[draw_num - 1]];
+			UInt64 key = keys[order[draw_num]];
+			for (UInt32 field_num = 0; field_num < sizeof(field_shifts) / sizeof(UInt32); ++field_num)
+			{
+				UInt64 mask = FieldMask(field_bits[field_num]) << field_shifts[field_num];
+				if ((previous_key & mask) != (key & mask))
+					state_changes++;
+			}
+		}
+		return state_changes;
+	}
+
+	void RenderQueue::RadixSort(UInt64* keys, UInt32* indices, UInt32 count, UInt64* keys_temp, UInt32* indices_temp)
+	{
+		UInt64* src_keys = keys;
+		UInt32* src_indices = indices;
+		UInt64* dst_keys = keys_temp;
+		UInt32* dst_indices = indices_temp;
+
+		if (count == 0)
+			return;
+
+		// the digit counts don't depend on the key order, so count every digit in one pass over the keys
+		UInt32 offsets[8][256];
+		memset(offsets, 0, sizeof(offsets));
+		for (UInt32 key_num = 0; key_num < count; ++key_num)
+		{
+			const UInt64 key = keys[key_num];
+			for (UInt32 digit_num = 0; digit_num < 8; ++digit_num)
+				offsets[digit_num][(key >> (digit_num * 8)) & 0xff]++;
+		}
+
+		// least significant digit first, 8 bits per pass
+		for (UInt32 digit_num = 0; digit_num < 8; ++digit_num)
+		{
+			const UInt32 shift = digit_num * 8;
+			UInt32* digit_offsets = offsets[digit_num];
+
+			// skip the pass if every key has the same digit, common for the unused upper bits of the ids
+			if (digit_offsets[(keys[0] >> shift) & 0xff] == count)
+				continue;
+
+			UInt32 total = 0;
+			for (UInt32 digit = 0; digit < 256; ++digit)
+			{
+				UInt32 digit_count = digit_offsets[digit];
+				digit_offsets[digit] = total;
+				total += digit_count;
+			}
+
+			for (UInt32 key_num = 0; key_num < count; ++key_num)
+			{
+				UInt32 dst = digit_offsets[(src_keys[key_num] >> shift) & 0xff]++;
+				dst_keys[dst] = src_keys[key_num];
+				dst_indices[dst] = src_indices[key_num];
+			}
+
+			UInt64* swap_keys = src_keys;
+			src_keys = dst_keys;
+			dst_keys = swap_keys;
+			UInt32* swap_indices = src_indices;
+			src_indices = dst_indices;
+			dst_indices = swap_indices;
+		}
+
+		if (src_keys != keys)
+		{
+			memcpy(keys, src_keys, count * sizeof(UInt64));
+			memcpy(indices, src_indices, count * sizeof(UInt32));
+		}
+	}
+
+	void RenderQueue::Submit(Renderer3D& renderer)
+	{
+		const UInt32 count = (UInt32)draws_.size();
+		if (count == 0)
+		{
+			Clear();
+			return;
+		}
+
+		keys_.resize(count);
+		keys_temp_.resize(count);
+		order_.resize(count);
+		order_temp_.resize(count);
+
+		// view space depth of each draw, so draws sharing state are submitted front to back
+		const Matrix44& view_matrix = renderer.view_matrix();
+		for (UInt32 draw_num = 0; draw_num < count; ++draw_num)
+		{
+			const Draw& draw = draws_[draw_num];
+			const Vector4 position = draw.transform.GetTranslation();
+			float depth = -(position.x()*view_matrix.m(0, 2) + position.y()*view_matrix.m(1, 2) + position.z()*view_matrix.m(2, 2) + view_matrix.m(3, 2));
+			if (!(depth > 0.0f))
+				depth = 0.0f;
+
+			// the bits of a positive float sort in the same order as its value, keep the most significant ones
+			UInt32 depth_bits;
+			memcpy(&depth_bits, &depth, sizeof(float));
+			keys_[draw_num] = draw.state_key | (depth_bits >> (32 - kDepthBits));
+			order_[draw_num] = draw_num;
+		}
+
+		stats_.num_draws += count;
+		stats_.state_changes_unsorted += CountStateChanges(keys_.data(), order_.data(), count);
+
+		RadixSort(keys_.data(), order_.data(), count, keys_temp_.data(), order_temp_.data());
+
+		// keys are now in sorted order, so count changes through an identity order
+		for (UInt32 draw_num = 0; draw_num < count; ++draw_num)
+			order_temp_[draw_num] = draw_num;
+		stats_.state_changes += CountStateChanges(keys_.data(), order_temp_.data(), count);
+
+		Shader* previous_shader = renderer.shader();
+		const Material* previous_override_material = renderer.override_material();
+		const OcclusionCuller* previous_occlusion_culler = renderer.occlusion_culler();
+		renderer.set_occlusion_culler(NULL);
+
+		UInt32 draw_num = 0;
+		while (draw_num < count)
+		{
+			const Draw& first = draws_[order_[draw_num]];
+
+			// gather the run of draws with the same mesh and state
+			instance_transforms_.clear();
+			UInt32 end = draw_num;
+			while (end < count)
+			{
+				const Draw& draw = draws_[order_[end]];
+				if (draw.mesh != first.mesh || draw.shader != first.shader || draw.override_material != first.override_material || draw.lit != first.lit)
+					break;
+				instance_transforms_.push_back(draw.transform);
+				++end;
+			}
+
+			if (renderer.shader() != first.shader)
+				renderer.SetShader(first.shader);
+			renderer.set_override_material(first.override_material);
+			renderer.DrawMeshInstanced(*first.mesh, instance_transforms_.data(), (UInt32)instance_transforms_.size(), first.lit);
+			stats_.num_batches++;
+
+			draw_num = end;
+		}
+
+		renderer.SetShader(previous_shader);
+		renderer.set_override_material(previous_override_material);
+		renderer.set_occlusion_culler(previous_occlusion_culler);
+
+		Clear();
+	}
+}
@@ -0,0 +1,157 @@
+#ifndef _GEF_RENDER_QUEUE_H
+#define _GEF_RENDER_QUEUE_H
+
+#include <gef.h>
+#include <maths/matrix44.h>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+
+namespace gef
+{
+	class Renderer3D;
+	class MeshInstance;
+	class Mesh;
+	class Material;
+	class Texture;
+	class Shader;
+	class Frustum;
+	class Aabb;
+
+	/**
+	Deferred mesh draws.
+	Draws are recorded with the shader and override material currently set on the renderer,
+	then sorted by a 64 bit key and submitted together. Sorting groups draws that share state,
+	and consecutive draws of the same mesh are submitted as one Renderer3D::DrawMeshInstanced call.
+	The queue is intended for opaque static meshes. Skinned meshes and anything relying on draw order should be drawn directly.
+
+	Recording only reads from the renderer, so several queues can be recorded on different threads,
+	for example with RecordParallel, and appended to one queue before submitting on the render thread.
+	Culling against the frustum and the renderer occlusion culler happens while recording, so it is spread over the recording threads too.
+	*/
+	class RenderQueue
+	{
+	public:
+		/// @brief Counters for the draws submitted since the last call to GetAndResetStats.
+		struct Stats
+		{
+			/// The number of mesh draws recorded.
+			UInt32 num_draws;
+			/// The number of DrawMeshInstanced calls made after merging draws of the same mesh.
+			UInt32 num_batches;
+			/// The number of shader, lighting, texture, material and mesh changes had the draws been submitted in recorded order.
+			UInt32 state_changes_unsorted;
+			/// The number of shader, lighting, texture, material and mesh changes in sorted order.
+			UInt32 state_changes;
+			/// The number of draws rejected by frustum or occlusion culling while recording.
+			UInt32 num_culled;
+
+			inline UInt32 state_changes_saved() const { return state_changes_unsorted - state_changes; }
+		};
+
+		RenderQueue();
+
+		/// @brief Record a mesh instance draw.
+		/// @param[in] renderer			The renderer the draw will be submitted to. Its current shader and override material are recorded.
+		/// @param[in] mesh_instance	The mesh instance. The mesh and transform are copied, the instance itself is not referenced after this call.
+		void DrawMesh(const Renderer3D& renderer, const MeshInstance& mesh_instance);
+
+		/// @brief Record a mesh draw.
+		/// @param[in] renderer		The renderer the draw will be submitted to. Its current shader and override material are recorded.
+		/// @param[in] mesh			The mesh. Must stay valid until Submit.
+		/// @param[in] transform	The world transform.
+		/// @param[in] lit			Use the renderer light data if true, full bright lighting if false.
+		void DrawMesh(const Renderer3D& renderer, const Mesh& mesh, const Matrix44& transform, bool lit = true);
+
+		/// @brief Add the draws recorded in another queue after the draws in this queue.
+		/// @param[in] queue	The queue to append. It is not modified.
+		void Append(const RenderQueue& queue);
+
+		/// @brief Record draws on multiple threads.
+		/// The items are split into contiguous ranges, each recorded into a separate queue on its own thread.
+		/// The queues are then appended to this queue in item order, so the result is the same as recording on one thread.
+		/// @param[in] count		The number of items.
+		/// @param[in] num_threads	The maximum number of threads to use. 0 uses GetNumHardwareThreads().
+		/// @param[in] record		Called once per range with the queue to record into and the [begin, end) range of items.
+		/// @note The frustum of this queue is used by all the recording queues. The renderer must not be modified while recording.
+		void RecordParallel(UInt32 count, UInt32 num_threads, const std::function<void(RenderQueue& queue, UInt32 begin, UInt32 end)>& record);
+
+		/// @brief Sort the recorded draws and submit them, then clear the queue.
+		/// @param[in] renderer		The renderer to draw with, between Renderer3D::Begin and Renderer3D::End.
+		/// The renderer view matrix is used to sort draws of the same state front to back.
+		/// @note The renderer shader and override material are restored once all draws are submitted.
+		/// Draws have already been occlusion culled when they were recorded, so the renderer occlusion culler is not used again.
+		void Submit(Renderer3D& renderer);
+
+		/// @brief Remove all recorded draws without submitting them.
+		void Clear();
+
+		/// @brief Get the counters and reset them to zero.
+		Stats GetAndResetStats();
+
+		inline UInt32 num_draws() const { return (UInt32)draws_.size(); }
+
+		/// @brief Set the frustum draws are culled against when they are recorded.
+		/// @param[in] frustum	The frustum, or NULL to disable frustum culling. Must stay valid while recording.
+		inline void set_frustum(const Frustum* frustum) { frustum_ = frustum; }
+		inline const Frustum* frustum() const { return frustum_; }
+
+		/// @brief Sort keys and indices together, in ascending key order. The sort is stable.
+		/// @param[in,out] keys		The keys.
+		/// @param[in,out] indices	The values moved with each key.
+		/// @param[in] count		The number of keys.
+		/// @param[in] keys_temp	Scratch space for count keys.
+		/// @param[in] indices_temp	Scratch space for count indices.
+		static void RadixSort(UInt64* keys, UInt32* indices, UInt32 count, UInt64* keys_temp, UInt32* indices_temp);
+
+		// sort key layout, from the most significant bits
+		static const UInt32 kShaderBits = 7;
+		static const UInt32 kLitBits = 1;
+		static const UInt32 kTextureBits = 12;
+		static const UInt32 kMaterialBits = 12;
+		static const UInt32 kMeshBits = 16;
+		static const UInt32 kDepthBits = 16;
+
+	private:
+		struct Draw
+		{
+			Matrix44 transform;
+			const Mesh* mesh;
+			Shader* shader;
+			const Material* override_material;
+			// the key without the depth bits
+			UInt64 state_key;
+			bool lit;
+		};
+
+		bool IsCulled(const Renderer3D& renderer, const Aabb& world_aabb);
+		void AddDraw(const Renderer3D& renderer, const Mesh& mesh, const Matrix44& transform, bool lit);
+		UInt32 GetId(std::unordered_map<const void*, UInt32>& ids, const void* object, UInt32 num_bits);
+		void BuildIdRemap(std::unordered_map<const void*, UInt32>& ids, const std::unordered_map<const void*, UInt32>& other_ids, UInt32 num_bits, std::vector<UInt32>& remap);
+		static UInt32 CountStateChanges(const UInt64* keys, const UInt32* order, UInt32 count);
+
+		std::vector<Draw> draws_;
+		std::unordered_map<const void*, UInt32> shader_ids_;
+		std::unordered_map<const void*, UInt32> texture_ids_;
+		std::unordered_map<const void*, UInt32> material_ids_;
+		std::unordered_map<const void*, UInt32> mesh_ids_;
+
+		// sort and submission scratch, kept to avoid allocating every frame
+		std::vector<UInt64> keys_;
+		std::vector<UInt64> keys_temp_;
+		std::vector<UInt32> order_;
+		std::vector<UInt32> order_temp_;
+		std::vector<Matrix44> instance_transforms_;
+		std::vector<UInt32> id_remaps_[4];
+		std::vector<const void*> remap_objects_;
+
+		// queues recorded by RecordParallel, one per thread
+		std::vector<std::unique_ptr<RenderQueue>> thread_queues_;
+
+		const Frustum* frustum_;
+		Stats stats_;
+	};
+}
+
+#endif // _GEF_RENDER_QUEUE_H
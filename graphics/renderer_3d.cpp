@@ -2,20 +2,31 @@
 #include <graphics/shader.h>
 #include <system/platform.h>
 #include <graphics/texture.h>
+#include <graphics/occlusion_culler.h>
+#include <graphics/mesh_instance.h>
+#include <graphics/mesh.h>
+#include <cstring>
+#include <exception>
 
 namespace gef
 {
 	Renderer3D::Renderer3D(Platform& platform) :
 		shader_(NULL),
 		override_material_(NULL),
+		occlusion_culler_(NULL),
 		platform_(platform),
 		default_shader_(platform),
+		default_instanced_shader_(NULL),
+		default_instanced_shader_failed_(false),
 		default_skinned_mesh_shader_(platform),
+		light_clusters_light_data_version_(0),
+		light_clusters_valid_(false),
 		clear_render_target_enabled_(true),
 		clear_depth_buffer_enabled_(true),
 		clear_stencil_buffer_enabled_(true),
 		fov_(0.0f),
-		draw_count_{0}
+		draw_count_{0},
+		occluded_count_{0}
 	{
 		projection_matrix_.SetIdentity();
 		view_matrix_.SetIdentity();
@@ -24,6 +35,51 @@ namespace gef
 
 	Renderer3D::~Renderer3D()
 	{
+		if (default_instanced_shader_)
+		{
+			platform_.RemoveShader(default_instanced_shader_);
+			delete default_instanced_shader_;
+		}
+	}
+
+	Default3DInstancedShader* Renderer3D::GetDefaultInstancedShader()
+	{
+		if (default_instanced_shader_ == NULL && !default_instanced_shader_failed_)
+		{
+			// hardware instancing is optional, so a vertex shader that fails to compile only disables it
+			try
+			{
+				default_instanced_shader_ = new Default3DInstancedShader(platform_);
+			}
+			catch (const std::exception&)
+			{
+				default_instanced_shader_failed_ = true;
+				return NULL;
+			}
+			platform_.AddShader(default_instanced_shader_);
+		}
+		return default_instanced_shader_;
+	}
+
+	const LightClusters* Renderer3D::GetLightClusters(bool lit)
+	{
+		if (!lit)
+			return NULL;
+
+		// the clusters are in view space so depend on both the camera and the lights
+		if (!light_clusters_valid_ || light_data_.version() != light_clusters_light_data_version_ ||
+			memcmp(&view_matrix_, &light_clusters_view_matrix_, sizeof(Matrix44)) != 0 ||
+			memcmp(&projection_matrix_, &light_clusters_projection_matrix_, sizeof(Matrix44)) != 0)
+		{
+			const Int32 num_lights = light_data_.num_lights() < MAX_LIGHTS ? light_data_.num_lights() : MAX_LIGHTS;
+			light_clusters_.Build(light_data_.GetLights().data(), num_lights, view_matrix_, projection_matrix_);
+			light_clusters_view_matrix_ = view_matrix_;
+			light_clusters_projection_matrix_ = projection_matrix_;
+			light_clusters_light_data_version_ = light_data_.version();
+			light_clusters_valid_ = true;
+		}
+
+		return &light_clusters_;
 	}
 
 	void Renderer3D::SetShader( Shader* shader)
@@ -34,6 +90,12 @@ namespace gef
 			set_shader(shader);
 	}
 
+	void Renderer3D::DrawMeshInstanced(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit)
+	{
+		for (UInt32 instance_num = 0; instance_num < count; ++instance_num)
+			DrawMesh(mesh, transforms[instance_num], lit);
+	}
+
 	void Renderer3D::DrawSkinnedMesh(const MeshInstance& mesh_instance, const std::vector<Matrix44>& bone_matrices, bool use_default_shader)
 	{
 		Shader* previous_shader = shader_;
@@ -43,7 +105,7 @@ namespace gef
 
 			SetShader(&default_skinned_mesh_shader_);
 
-			default_skinned_mesh_shader_.SetSceneData(skinned_data_, light_data_, view_matrix_, projection_matrix_);
+			default_skinned_mesh_shader_.SetSceneData(skinned_data_, light_data_, view_matrix_, projection_matrix_, GetLightClusters(true));
 		}
 
 		DrawMesh(mesh_instance);
@@ -54,9 +116,29 @@ namespace gef
 
 	void Renderer3D::CalculateInverseWorldTransposeMatrix()
 	{
-		Matrix44 inv_world;
-		inv_world.Inverse(world_matrix_);
-		inv_world_transpose_matrix_.Transpose(inv_world);
+		inv_world_transpose_matrix_.InverseTranspose(world_matrix_);
+	}
+
+	bool Renderer3D::IsOccluded(const MeshInstance& mesh_instance)
+	{
+		if (occlusion_culler_ && !occlusion_culler_->IsVisible(mesh_instance))
+		{
+			occluded_count_++;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Renderer3D::IsOccluded(const Mesh& mesh, const Matrix44& transform)
+	{
+		if (occlusion_culler_ && !occlusion_culler_->IsVisible(mesh.aabb(), transform))
+		{
+			occluded_count_++;
+			return true;
+		}
+
+		return false;
 	}
 
 	void Renderer3D::set_world_matrix(const  Matrix44& matrix)
@@ -64,5 +146,10 @@ namespace gef
 		world_matrix_ = matrix;
 		CalculateInverseWorldTransposeMatrix();
 	}
-}
 
+	void Renderer3D::set_world_matrix(const MeshInstance& mesh_instance)
+	{
+		world_matrix_ = mesh_instance.transform();
+		inv_world_transpose_matrix_ = mesh_instance.inv_world_transpose();
+	}
+}
@@ -4,8 +4,10 @@
 #include <gef.h>
 #include <maths/matrix44.h>
 #include <graphics/light_data.h>
+#include <graphics/light_clusters.h>
 #include <graphics/skinned_mesh_shader_data.h>
 #include <graphics/default_3d_shader.h>
+#include <graphics/default_3d_instanced_shader.h>
 #include <graphics/default_3d_skinning_shader.h>
 #include <vector>
 #include <graphics/primitive.h>
@@ -18,6 +20,7 @@ namespace gef
 	class Material;
 	class Texture;
 	class Mesh;
+	class OcclusionCuller;
 
 	class Skeleton;
 
@@ -44,6 +47,13 @@ namespace gef
 		virtual void End() = 0;
 		virtual void DrawMesh(const  MeshInstance& mesh_instance) = 0;
 		virtual void DrawMesh(const Mesh& mesh, const gef::Matrix44& matrix, bool lit=true) = 0;
+		/// @brief Draw the same mesh with several transforms.
+		/// @param[in] mesh			The mesh.
+		/// @param[in] transforms	The world transform of each instance.
+		/// @param[in] count		The number of instances.
+		/// @param[in] lit			Use the light data if true, full bright lighting if false.
+		/// @note The default implementation calls DrawMesh for each transform.
+		virtual void DrawMeshInstanced(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit = true);
 
 //		virtual void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1) = 0;
 		virtual void SetFillMode(FillMode fill_mode) = 0;
@@ -62,6 +72,9 @@ namespace gef
 		inline void set_projection_matrix(const  Matrix44& matrix) {projection_matrix_ = matrix;}
 		inline const Matrix44& world_matrix() const { return world_matrix_; }
 		void set_world_matrix(const  Matrix44& matrix);
+		/// @brief Set the world matrix from a mesh instance, using its cached inverse transpose matrix.
+		/// @param[in] mesh_instance	The mesh instance being drawn.
+		void set_world_matrix(const MeshInstance& mesh_instance);
 		inline const Matrix44& inv_world_transpose_matrix() const { return inv_world_transpose_matrix_; }
 
 		inline  const Platform& platform() const {return platform_;}
@@ -83,10 +96,33 @@ namespace gef
 			draw_count_ = 0;
 			return value;
 		};
+		int GetAndResetOccludedCount() {
+			int value = occluded_count_;
+			occluded_count_ = 0;
+			return value;
+		};
+
+		/// @brief Set the occlusion culler used to skip hidden meshes in DrawMesh.
+		/// @param[in] occlusion_culler		The occlusion culler, or NULL to disable occlusion culling.
+		/// @note The occluders must have been rasterized before any meshes are drawn.
+		inline void set_occlusion_culler(const OcclusionCuller* occlusion_culler) { occlusion_culler_ = occlusion_culler; }
+		inline const OcclusionCuller* occlusion_culler() const { return occlusion_culler_; }
 	protected:
 		Renderer3D(Platform& platform);
 		void CalculateInverseWorldTransposeMatrix();
+		bool IsOccluded(const MeshInstance& mesh_instance);
+		bool IsOccluded(const Mesh& mesh, const Matrix44& transform);
 		inline void set_shader( Shader* shader) { shader_ = shader; }
+		/// @brief Get the instanced variant of the default shader, creating it on the first call.
+		/// Only renderers that draw with hardware instancing need it, so it is not compiled until then.
+		/// @return The shader, or NULL if it could not be created, e.g. because the application does not deploy
+		/// its vertex shader. Creation is not retried, the renderer draws each instance separately instead.
+		Default3DInstancedShader* GetDefaultInstancedShader();
+		/// @brief Get the light clusters for the default shaders, building them if the camera or the lit light data
+		/// have changed since they were last built. Shared by every default shader, so they are normally built once a frame.
+		/// @param[in] lit	false for full bright lighting, which has no lights to cluster.
+		/// @return The clusters of the lit light data, or NULL if lit is false.
+		const LightClusters* GetLightClusters(bool lit);
 
 		Matrix44 projection_matrix_;
 		Matrix44 view_matrix_;
@@ -94,11 +130,20 @@ namespace gef
 		Matrix44 world_matrix_;
 		Shader* shader_;
 		Default3DShader default_shader_;
+		Default3DInstancedShader* default_instanced_shader_;
+		bool default_instanced_shader_failed_;
 		Default3DSkinningShader default_skinned_mesh_shader_;
 		LightData light_data_;
 		LightData full_bright_light_data_;
+		// clusters of light_data_, and the scene data they were built from
+		LightClusters light_clusters_;
+		Matrix44 light_clusters_view_matrix_;
+		Matrix44 light_clusters_projection_matrix_;
+		UInt32 light_clusters_light_data_version_;
+		bool light_clusters_valid_;
 		SkinnedMeshShaderData skinned_data_;
 		const Material* override_material_;
+		const OcclusionCuller* occlusion_culler_;
 
 		Platform& platform_;
 
@@ -108,6 +153,7 @@ namespace gef
 
 		float fov_;
 		int draw_count_;
+		int occluded_count_;
 	};
 }
 #endif // _GEF_RENDERER_3D_H
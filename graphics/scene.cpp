@@ -105,7 +105,7 @@ namespace gef
 			// colour
 			gef::Colour colour{};
 			colour.SetFromAGBR(materialIter->colour);
-			material->diffuse_ = colour.GetRGBAasVector4();
+			material->set_diffuse(colour.GetRGBAasVector4());
 
 			// texture
 			if(materialIter->diffuse_texture != "")
@@ -122,12 +122,12 @@ namespace gef
 						Texture* texture = Texture::Create(platform, image_data);
 						textures.push_back(texture);
 						textures_map[texture_name_id] = texture;
-						material->texture_diffuse_ = texture;
+						material->set_texture_diffuse(texture);
 					}
 				}
 				else
 				{
-					material->texture_diffuse_ = find_result->second;
+					material->set_texture_diffuse(find_result->second);
 				}
 			}
 		}
@@ -14,6 +14,8 @@
 
 namespace gef
 {
+	ShaderInterface::UploadStats ShaderInterface::upload_stats_ = {};
+
 	ShaderInterface::ShaderInterface() 
         :	vertex_shader_variable_data_(NULL),
 			vertex_shader_variable_data_size_(0),
@@ -21,8 +23,15 @@ namespace gef
 			pixel_shader_variable_data_size_(0),
 			light_shader_variable_data_(NULL),
 			light_shader_variable_data_size_(0),
-			vertex_size_(0)
+			vertex_size_(0),
+			instance_size_(0)
 	{
+		for (Int32 frequency = 0; frequency < kNumUpdateFrequencies; ++frequency)
+		{
+			block_states_[frequency].dirty_begin = 0;
+			block_states_[frequency].dirty_end = 0;
+			block_states_[frequency].uploaded = false;
+		}
 	}
 	ShaderInterface::~ShaderInterface()
 	{
@@ -37,7 +46,7 @@ namespace gef
 
 	void ShaderInterface::SetVertexShaderVariable(ShaderInterface::VVIndex variable_index, const void* value, Int32 variable_count)
 	{
-		SetVariable(vertex_shader_variables_, vertex_shader_variable_data_, variable_index.val_, value, variable_count);
+		SetVariable(kPerObject, variable_index.val_, value, variable_count);
 	}
 
 	ShaderInterface::PVIndex ShaderInterface::AddPixelShaderVariable(const char* variable_name, VariableType variable_type, Int32 variable_count)
@@ -47,7 +56,18 @@ namespace gef
 
 	void ShaderInterface::SetPixelShaderVariable(ShaderInterface::PVIndex variable_index, const void* value)
 	{
-		SetVariable(pixel_shader_variables_, pixel_shader_variable_data_, variable_index.val_, value);
+		SetVariable(kPerMaterial, variable_index.val_, value);
+	}
+
+	void ShaderInterface::SetPixelShaderVariables(ShaderInterface::PVIndex first_variable, const void* value, Int32 size)
+	{
+		Int32 byte_offset = pixel_shader_variables_[first_variable.val_].byte_offset;
+		assert(byte_offset + size <= pixel_shader_variable_data_size_);
+		UInt8* variable_data = pixel_shader_variable_data_ + byte_offset;
+		if (memcmp(variable_data, value, size) != 0) {
+			memcpy(variable_data, value, size);
+			MarkBlockDirty(kPerMaterial, byte_offset, byte_offset + size);
+		}
 	}
 
 	ShaderInterface::LVIndex ShaderInterface::AddLightShaderVariable(const char* variable_name, VariableType variable_type, Int32 variable_count)
@@ -57,7 +77,15 @@ namespace gef
 
 	void ShaderInterface::SetLightShaderVariable(ShaderInterface::LVIndex variable_index, const void* value)
 	{
-		SetVariable(light_shader_variables_, light_shader_variable_data_, variable_index.val_, value);
+		SetVariable(kPerFrame, variable_index.val_, value);
+	}
+
+	void ShaderInterface::SetLightShaderVariable(ShaderInterface::LVIndex variable_index, const void* value, Int32 first_element, Int32 element_count)
+	{
+		assert(first_element >= 0 && first_element + element_count <= light_shader_variables_[variable_index.val_].count);
+		if (element_count <= 0)
+			return;
+		SetVariable(kPerFrame, variable_index.val_, value, element_count, first_element);
 	}
 
 	UInt32 ShaderInterface::AddVariable(std::vector<ShaderVariable>& variables, const char* variable_name, VariableType variable_type, Int32 variable_count)
@@ -79,25 +107,129 @@ namespace gef
 		return value + factor - offset;
 	}
 
-	void ShaderInterface::SetVariable(std::vector<ShaderVariable>& variables, UInt8* variables_data, UInt32 variable_index, const void* value, Int32 variable_count)
+	void ShaderInterface::SetVariable(UpdateFrequency frequency, UInt32 variable_index, const void* value, Int32 variable_count, Int32 first_element)
 	{
-		ShaderVariable& shader_variable = variables[variable_index];
+		ShaderVariable& shader_variable = GetBlockVariables(frequency)[variable_index];
 		if (variable_count == -1) variable_count = shader_variable.count;
-		void* variable_data = &static_cast<UInt8*>(variables_data)[shader_variable.byte_offset];
 		Int32 data_size = GetTypeSize(shader_variable.type);
 		Int32 block_data_size = RoundUpToNearest(data_size, 16);
+		// array elements are stored on 16 byte boundaries
+		Int32 byte_offset = shader_variable.byte_offset + block_data_size*first_element;
+		UInt8* variable_data = GetBlockData(frequency) + byte_offset;
+		const UInt8* value_data = static_cast<const UInt8*>(value);
+
+		// only copy values that have changed, so setting the same value again leaves the block clean
 		if (variable_count == 1 || data_size == block_data_size) {
-			memcpy(variable_data, value, data_size*variable_count);
+			Int32 size = data_size*variable_count;
+			if (memcmp(variable_data, value_data, size) != 0) {
+				memcpy(variable_data, value_data, size);
+				MarkBlockDirty(frequency, byte_offset, byte_offset + size);
+			}
 		}
 		else { 
 			for (int i = 0; i < variable_count; i++) {
-				memcpy(static_cast<std::uint8_t*>(variable_data)+block_data_size*i, static_cast<const std::uint8_t*>(value)+data_size*i, data_size);
+				if (memcmp(variable_data + block_data_size*i, value_data + data_size*i, data_size) != 0) {
+					memcpy(variable_data + block_data_size*i, value_data + data_size*i, data_size);
+					MarkBlockDirty(frequency, byte_offset + block_data_size*i, byte_offset + block_data_size*i + data_size);
+				}
+			}
+		}
+	}
+
+	UInt8* ShaderInterface::GetBlockData(UpdateFrequency frequency) const
+	{
+		switch (frequency)
+		{
+		case kPerObject: return vertex_shader_variable_data_;
+		case kPerMaterial: return pixel_shader_variable_data_;
+		default: return light_shader_variable_data_;
+		}
+	}
+
+	Int32 ShaderInterface::GetBlockSize(UpdateFrequency frequency) const
+	{
+		switch (frequency)
+		{
+		case kPerObject: return vertex_shader_variable_data_size_;
+		case kPerMaterial: return pixel_shader_variable_data_size_;
+		default: return light_shader_variable_data_size_;
+		}
+	}
+
+	std::vector<ShaderInterface::ShaderVariable>& ShaderInterface::GetBlockVariables(UpdateFrequency frequency)
+	{
+		switch (frequency)
+		{
+		case kPerObject: return vertex_shader_variables_;
+		case kPerMaterial: return pixel_shader_variables_;
+		default: return light_shader_variables_;
+		}
+	}
+
+	void ShaderInterface::MarkBlockDirty(UpdateFrequency frequency, Int32 begin, Int32 end)
+	{
+		BlockState& block_state = block_states_[frequency];
+		if (block_state.dirty_begin >= block_state.dirty_end)
+		{
+			block_state.dirty_begin = begin;
+			block_state.dirty_end = end;
+		}
+		else
+		{
+			if (begin < block_state.dirty_begin)
+				block_state.dirty_begin = begin;
+			if (end > block_state.dirty_end)
+				block_state.dirty_end = end;
+		}
+	}
+
+	bool ShaderInterface::PrepareBlockUpload(UpdateFrequency frequency)
+	{
+		BlockState& block_state = block_states_[frequency];
+		if (block_state.dirty_begin >= block_state.dirty_end)
+		{
+			upload_stats_.num_skipped_clean[frequency]++;
+			return false;
+		}
+
+		const Int32 dirty_begin = block_state.dirty_begin;
+		const Int32 bytes_changed = block_state.dirty_end - dirty_begin;
+		block_state.dirty_begin = block_state.dirty_end = 0;
+
+		// the values may have changed and then changed back since the last upload
+		// every write marks its bytes dirty, so outside the dirty range the block still matches the uploaded copy
+		const UInt8* block_data = GetBlockData(frequency);
+		if (block_state.uploaded)
+		{
+			UInt8* uploaded_data = block_state.uploaded_data.data() + dirty_begin;
+			if (memcmp(block_data + dirty_begin, uploaded_data, bytes_changed) == 0)
+			{
+				upload_stats_.num_skipped_unchanged[frequency]++;
+				return false;
 			}
+			memcpy(uploaded_data, block_data + dirty_begin, bytes_changed);
 		}
+		else
+		{
+			block_state.uploaded_data.assign(block_data, block_data + GetBlockSize(frequency));
+			block_state.uploaded = true;
+		}
+
+		upload_stats_.bytes_uploaded[frequency] += GetBlockSize(frequency);
+		upload_stats_.bytes_changed[frequency] += bytes_changed;
+		upload_stats_.num_uploads[frequency]++;
+		return true;
+	}
+
+	void ShaderInterface::UploadFailed(UpdateFrequency frequency)
+	{
+		// force the next upload
+		block_states_[frequency].uploaded = false;
+		MarkBlockDirty(frequency, 0, GetBlockSize(frequency));
 	}
 
 
-	void ShaderInterface::AddVertexParameter(const char* parameter_name, VariableType parameter_type, Int32 parameter_byte_offset, const char* semantic_name, int semantic_index)
+	void ShaderInterface::AddVertexParameter(const char* parameter_name, VariableType parameter_type, Int32 parameter_byte_offset, const char* semantic_name, int semantic_index, Int32 input_slot, bool per_instance)
 	{
 		ShaderParameter shader_parameter;
 		shader_parameter.name = parameter_name;
@@ -105,6 +237,8 @@ namespace gef
 		shader_parameter.byte_offset = parameter_byte_offset;
 		shader_parameter.semantic_name = semantic_name;
 		shader_parameter.semantic_index = semantic_index;
+		shader_parameter.input_slot = input_slot;
+		shader_parameter.per_instance = per_instance;
 		parameters_.push_back(shader_parameter);
 	}
 
@@ -129,20 +263,45 @@ namespace gef
 		switch(type)
 		{
 		case kUByte4:
+		case kUByte4Norm:
 		case kFloat: return 4;
 		case kVector2: return 8;
 		case kVector3: return 12;
-		case kVector4: return 16;
+		case kVector4:
+		case kUInt4: return 16;
 		case kMatrix44: return 64;
 		case kLightData: return sizeof(LightData::Light);
 		}
 	}
 
+	UInt32 ShaderInterface::GetAndResetBytesUploaded()
+	{
+		UploadStats upload_stats = GetAndResetUploadStats();
+		UInt32 bytes_uploaded = 0;
+		for (Int32 frequency = 0; frequency < kNumUpdateFrequencies; ++frequency)
+			bytes_uploaded += upload_stats.bytes_uploaded[frequency];
+		return bytes_uploaded;
+	}
+
+	ShaderInterface::UploadStats ShaderInterface::GetAndResetUploadStats()
+	{
+		UploadStats upload_stats = upload_stats_;
+		memset(&upload_stats_, 0, sizeof(UploadStats));
+		return upload_stats;
+	}
+
 	void ShaderInterface::AllocateVariableData()
 	{
 		vertex_shader_variable_data_ = AllocateVariableData(vertex_shader_variables_, vertex_shader_variable_data_size_);
 		pixel_shader_variable_data_ = AllocateVariableData(pixel_shader_variables_, pixel_shader_variable_data_size_);
 		light_shader_variable_data_ = AllocateVariableData(light_shader_variables_, light_shader_variable_data_size_);
+
+		// the first upload sends the whole block
+		for (Int32 frequency = 0; frequency < kNumUpdateFrequencies; ++frequency)
+		{
+			block_states_[frequency].uploaded = false;
+			MarkBlockDirty((UpdateFrequency)frequency, 0, GetBlockSize((UpdateFrequency)frequency));
+		}
 	}
 
 	UInt8* ShaderInterface::AllocateVariableData(std::vector<ShaderVariable>& variables, Int32& variable_data_size)
@@ -167,7 +326,7 @@ namespace gef
 			}
 		}
 		variable_data_size = RoundUpToNearest(variable_data_size, 16);
-		return static_cast<UInt8*>(malloc(variable_data_size));
+		return static_cast<UInt8*>(calloc(variable_data_size, 1));
 	}
 
 	void ShaderInterface::SetVertexShaderPath(const std::wstring& filename, const std::wstring& base_path, const Platform& platform)
@@ -28,7 +28,35 @@ namespace gef
 			kVector3,
 			kVector4,
 			kUByte4,
-			kLightData
+			kLightData,
+			kUInt4,
+			/// four bytes read by the vertex shader as a float4 in the range [0, 1]
+			kUByte4Norm
+		};
+
+		/// @brief How often each variable block is expected to change.
+		/// Vertex shader variables are per object, pixel shader variables per material and light shader variables per frame.
+		enum UpdateFrequency
+		{
+			kPerObject = 0,
+			kPerMaterial,
+			kPerFrame,
+			kNumUpdateFrequencies
+		};
+
+		/// @brief Variable block upload counters for each update frequency.
+		struct UploadStats
+		{
+			/// Bytes copied to the device.
+			UInt32 bytes_uploaded[kNumUpdateFrequencies];
+			/// Bytes that had changed in the uploaded blocks. A partial update would only need to copy these.
+			UInt32 bytes_changed[kNumUpdateFrequencies];
+			/// Blocks copied to the device.
+			UInt32 num_uploads[kNumUpdateFrequencies];
+			/// Blocks not uploaded because no variable had changed since the last upload.
+			UInt32 num_skipped_clean[kNumUpdateFrequencies];
+			/// Blocks not uploaded because the variables changed back to the values last uploaded.
+			UInt32 num_skipped_unchanged[kNumUpdateFrequencies];
 		};
 
 		enum class TextureType {
@@ -61,6 +89,10 @@ namespace gef
 			Int32 byte_offset;
 			std::string semantic_name;
 			Int32 semantic_index;
+			/// The vertex stream the parameter is read from. Stream 0 holds the mesh vertices.
+			Int32 input_slot;
+			/// If true the parameter advances once per instance rather than once per vertex.
+			bool per_instance;
 		};
 
 		struct TextureSampler
@@ -78,17 +110,34 @@ namespace gef
 		virtual void CreateProgram() = 0;
 		virtual void CreateVertexFormat() = 0;
 
-		void AddVertexParameter(const char* parameter_name, VariableType variable_type, Int32 byte_offset, const char* semantic_name, int semantic_index);
+		/// @brief Add a vertex shader input.
+		/// @param[in] input_slot		The vertex stream the input is read from. Per vertex data is in stream 0.
+		/// @param[in] per_instance		Read the input once per instance, from a stream filled by Renderer3D::DrawMeshInstanced.
+		void AddVertexParameter(const char* parameter_name, VariableType variable_type, Int32 byte_offset, const char* semantic_name, int semantic_index, Int32 input_slot = 0, bool per_instance = false);
 		inline void set_vertex_size(Int32 vertex_size) {vertex_size_ = vertex_size; }
+		/// @brief Set the size in bytes of the per instance data, 0 if the shader does not use instancing.
+		inline void set_instance_size(Int32 instance_size) { instance_size_ = instance_size; }
+		inline Int32 instance_size() const { return instance_size_; }
 
 		VVIndex AddVertexShaderVariable(const char* variable_name, VariableType variable_type, Int32 variable_count = 1);
 		void SetVertexShaderVariable(VVIndex variable_index, const void* value, Int32 variable_count = -1);
 		
 		PVIndex AddPixelShaderVariable(const char* variable_name, VariableType variable_type, Int32 variable_count = 1);
 		void SetPixelShaderVariable(PVIndex variable_index, const void* value);
+		/// @brief Set consecutive pixel shader variables from data already packed in the block layout.
+		/// @param[in] first_variable	The first variable to set.
+		/// @param[in] value			The packed variable data.
+		/// @param[in] size				The size of the data in bytes, starting at the first variable.
+		void SetPixelShaderVariables(PVIndex first_variable, const void* value, Int32 size);
 
 		LVIndex AddLightShaderVariable(const char* variable_name, VariableType variable_type, Int32 variable_count = 1);
 		void SetLightShaderVariable(LVIndex variable_index, const void* value);
+		/// @brief Set part of an array light shader variable.
+		/// @param[in] variable_index	The variable.
+		/// @param[in] value			The values for elements [first_element, first_element + element_count).
+		/// @param[in] first_element	The first array element to set.
+		/// @param[in] element_count	The number of array elements to set.
+		void SetLightShaderVariable(LVIndex variable_index, const void* value, Int32 first_element, Int32 element_count);
 
 		TSIndex AddTextureSampler(const char* texture_sampler_name, TextureType type = TextureType::DIFFUSE);
 		void SetTextureSampler(TSIndex texture_sampler_index, const Texture* texture);
@@ -104,15 +153,37 @@ namespace gef
 
 		static ShaderInterface* Create(const Platform& platform);
 
+		/// @brief Get the number of bytes of shader variable data uploaded by all shader interfaces since the last call.
+		/// @return The number of bytes uploaded. Call once per frame for a per frame count.
+		/// @note Also resets the counters returned by GetAndResetUploadStats.
+		static UInt32 GetAndResetBytesUploaded();
+
+		/// @brief Get the upload counters for all shader interfaces since the last call, and reset them.
+		static UploadStats GetAndResetUploadStats();
+
 	protected:
 		ShaderInterface();
 		static Int32 GetTypeSize(VariableType type);
 
 		UInt32 AddVariable(std::vector<ShaderVariable>& variables, const char* variable_name, VariableType variable_type, Int32 variable_count);
-		virtual void SetVariable(std::vector<ShaderVariable>& variables, UInt8* variables_data, UInt32 variable_index, const void* value, Int32 variable_count = -1);
+		/// @brief Copy a variable value into its block. Only values that differ from the block contents mark the block dirty.
+		void SetVariable(UpdateFrequency frequency, UInt32 variable_index, const void* value, Int32 variable_count = -1, Int32 first_element = 0);
 		void AllocateVariableData();
 		UInt8* AllocateVariableData(std::vector<ShaderVariable>& variables, Int32& variable_data_size);
 
+		UInt8* GetBlockData(UpdateFrequency frequency) const;
+		Int32 GetBlockSize(UpdateFrequency frequency) const;
+		std::vector<ShaderVariable>& GetBlockVariables(UpdateFrequency frequency);
+		void MarkBlockDirty(UpdateFrequency frequency, Int32 begin, Int32 end);
+
+		/// @brief Called by the device implementation before uploading a block.
+		/// @param[in] frequency	The block.
+		/// @return true if the block must be uploaded, false if the device already has its contents.
+		/// Clears the dirty range and updates the upload stats.
+		bool PrepareBlockUpload(UpdateFrequency frequency);
+		/// @brief Called by the device implementation if an upload prepared with PrepareBlockUpload failed.
+		void UploadFailed(UpdateFrequency frequency);
+
 		std::wstring vs_path;
 		std::wstring ps_path;
 
@@ -128,6 +199,22 @@ namespace gef
 		UInt8* light_shader_variable_data_;
 		Int32 light_shader_variable_data_size_;
 		Int32 vertex_size_;
+		Int32 instance_size_;
+
+		// Each variable block is only uploaded when one of its variables has changed since the last upload,
+		// and its contents differ from what was last uploaded.
+		struct BlockState
+		{
+			// byte range changed since the last upload, empty when begin >= end
+			Int32 dirty_begin;
+			Int32 dirty_end;
+			// copy of the block as it was last uploaded, valid when uploaded is true
+			std::vector<UInt8> uploaded_data;
+			bool uploaded;
+		};
+		BlockState block_states_[kNumUpdateFrequencies];
+
+		static UploadStats upload_stats_;
 	};
 }
 
@@ -0,0 +1,125 @@
+#include <graphics/skyline_packer.h>
+
+namespace gef
+{
+	SkylinePacker::SkylinePacker(UInt32 width, UInt32 height)
+	{
+		Reset(width, height);
+	}
+
+	void SkylinePacker::Reset(UInt32 width, UInt32 height)
+	{
+		width_ = width;
+		height_ = height;
+		used_area_ = 0;
+
+		skyline_.clear();
+		Node node;
+		node.x = 0;
+		node.y = 0;
+		node.width = width;
+		skyline_.push_back(node);
+	}
+
+	bool SkylinePacker::Fit(size_t node_index, UInt32 width, UInt32 height, UInt32& y) const
+	{
+		const UInt32 x = skyline_[node_index].x;
+		if (x + width > width_)
+			return false;
+
+		// the rectangle rests on the highest segment under it
+		y = 0;
+		UInt32 width_left = width;
+		for (size_t index = node_index; width_left > 0; ++index)
+		{
+			const Node& node = skyline_[index];
+			if (node.y > y)
+				y = node.y;
+			if (y + height > height_)
+				return false;
+			width_left = node.width < width_left ? width_left - node.width : 0;
+		}
+		return true;
+	}
+
+	bool SkylinePacker::Pack(UInt32 width, UInt32 height, UInt32& x, UInt32& y)
+	{
+		if (width == 0 || height == 0)
+			return false;
+
+		// choose the lowest top edge, then the narrowest segment to leave the least waste
+		size_t best_index = skyline_.size();
+		UInt32 best_bottom = 0xffffffff;
+		UInt32 best_width = 0xffffffff;
+		UInt32 best_y = 0;
+		for (size_t index = 0; index < skyline_.size(); ++index)
+		{
+			UInt32 node_y;
+			if (Fit(index, width, height, node_y))
+			{
+				const UInt32 bottom = node_y + height;
+				if (bottom < best_bottom || (bottom == best_bottom && skyline_[index].width < best_width))
+				{
+					best_index = index;
+					best_bottom = bottom;
+					best_width = skyline_[index].width;
+					best_y = node_y;
+				}
+			}
+		}
+
+		if (best_index == skyline_.size())
+			return false;
+
+		Node new_node;
+		new_node.x = skyline_[best_index].x;
+		new_node.y = best_y + height;
+		new_node.width = width;
+		skyline_.insert(skyline_.begin() + best_index, new_node);
+
+		// remove or shorten the segments now under the new one
+		const UInt32 right = new_node.x + new_node.width;
+		size_t index = best_index + 1;
+		while (index < skyline_.size() && skyline_[index].x < right)
+		{
+			Node& node = skyline_[index];
+			const UInt32 node_right = node.x + node.width;
+			if (node_right <= right)
+				skyline_.erase(skyline_.begin() + index);
+			else
+			{
+				node.width = node_right - right;
+				node.x = right;
+				break;
+			}
+		}
+
+		// merge neighbouring segments at the same height
+		for (size_t merge_index = 0; merge_index + 1 < skyline_.size();)
+		{
+			if (skyline_[merge_index].y == skyline_[merge_index + 1].y)
+			{
+				skyline_[merge_index].width += skyline_[merge_index + 1].width;
+				skyline_.erase(skyline_.begin() + merge_index + 1);
+			}
+			else
+				++merge_index;
+		}
+
+		x = new_node.x;
+		y = best_y;
+		used_area_ += (UInt64)width * height;
+		return true;
+	}
+
+	UInt32 SkylinePacker::used_height() const
+	{
+		UInt32 max_y = 0;
+		for (const Node& node : skyline_)
+		{
+			if (node.y > max_y)
+				max_y = node.y;
+		}
+		return max_y;
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef _GEF_SKYLINE_PACKER_H
+#define _GEF_SKYLINE_PACKER_H
+
+#include <gef.h>
+#include <vector>
+#include <cstddef>
+
+namespace gef
+{
+	/**
+	Packs rectangles into a fixed size area with the skyline bottom-left heuristic.
+	The packer keeps the top edge of the packed rectangles as a list of horizontal segments,
+	each rectangle is placed on the segment where its top edge would be lowest.
+	Only coordinates are calculated, so it can be used for textures, font glyphs or anything else.
+	*/
+	class SkylinePacker
+	{
+	public:
+		SkylinePacker(UInt32 width = 0, UInt32 height = 0);
+
+		/// @brief Removes all packed rectangles and sets the size of the area.
+		void Reset(UInt32 width, UInt32 height);
+
+		/// @brief Finds a place for a rectangle.
+		/// @param[in] width		Width of the rectangle.
+		/// @param[in] height		Height of the rectangle.
+		/// @param[out] x			Left edge of the placed rectangle.
+		/// @param[out] y			Top edge of the placed rectangle.
+		/// @return false if there is no room for the rectangle.
+		bool Pack(UInt32 width, UInt32 height, UInt32& x, UInt32& y);
+
+		inline UInt32 width() const { return width_; }
+		inline UInt32 height() const { return height_; }
+		/// @return The height of the tallest part of the skyline.
+		UInt32 used_height() const;
+		/// @return The total area of the packed rectangles.
+		inline UInt64 used_area() const { return used_area_; }
+
+	private:
+		// a segment of the skyline
+		struct Node
+		{
+			UInt32 x;
+			UInt32 y;
+			UInt32 width;
+		};
+
+		// returns the top of a rectangle placed at the start of node_index, or false if it doesn't fit
+		bool Fit(size_t node_index, UInt32 width, UInt32 height, UInt32& y) const;
+
+		std::vector<Node> skyline_;
+		UInt32 width_;
+		UInt32 height_;
+		UInt64 used_area_;
+	};
+}
+
+#endif // _GEF_SKYLINE_PACKER_H
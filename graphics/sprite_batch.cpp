@@ -0,0 +1,284 @@
+#include <graphics/sprite_batch.h>
+#include <graphics/sprite.h>
+#include <maths/fast_math.h>
+#include <emmintrin.h>
+#include <cstring>
+#include <math.h>
+
+namespace gef
+{
+	// the SIMD quad builder stores px, py, pz and colour as one four float row
+	static_assert(sizeof(SpriteBatch::Vertex) == 6 * sizeof(float), "SpriteBatch::Vertex layout has changed");
+
+	namespace
+	{
+		const UInt32 kSpritesPerGroup = 4;
+
+		inline __m128 LoadOrSet(const float* values, UInt32 index, float default_value)
+		{
+			return values ? _mm_loadu_ps(&values[index]) : _mm_set1_ps(default_value);
+		}
+
+		// builds the quads of the four sprites starting at index
+		void BuildQuads4(const SpriteArrays& sprites, UInt32 index, SpriteBatch::Vertex* vertices)
+		{
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 x = _mm_loadu_ps(&sprites.x[index]);
+			const __m128 y = _mm_loadu_ps(&sprites.y[index]);
+			const __m128 z = LoadOrSet(sprites.z, index, 0.0f);
+			const __m128 half_width = _mm_mul_ps(_mm_loadu_ps(&sprites.width[index]), half);
+			const __m128 half_height = _mm_mul_ps(_mm_loadu_ps(&sprites.height[index]), half);
+			const __m128 colour = sprites.colour ? _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)&sprites.colour[index])) : _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+			// the same axes as BuildQuad
+			__m128 x_axis_x = half_width;
+			__m128 x_axis_y = _mm_setzero_ps();
+			__m128 y_axis_x = _mm_setzero_ps();
+			__m128 y_axis_y = half_height;
+			if (sprites.rotation)
+			{
+				__m128 sin_rotation, cos_rotation;
+				FastSinCos(_mm_loadu_ps(&sprites.rotation[index]), sin_rotation, cos_rotation);
+				x_axis_x = _mm_mul_ps(cos_rotation, half_width);
+				x_axis_y = _mm_mul_ps(sin_rotation, half_width);
+				y_axis_x = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sin_rotation, half_height));
+				y_axis_y = _mm_mul_ps(cos_rotation, half_height);
+			}
+
+			// corner offsets, the bottom left and top left corners are the negated diagonals
+			const __m128 diagonal_x = _mm_add_ps(x_axis_x, y_axis_x);
+			const __m128 diagonal_y = _mm_add_ps(x_axis_y, y_axis_y);
+			const __m128 anti_diagonal_x = _mm_sub_ps(x_axis_x, y_axis_x);
+			const __m128 anti_diagonal_y = _mm_sub_ps(x_axis_y, y_axis_y);
+
+			__m128 corner_x[SpriteBatch::kVerticesPerSprite];
+			__m128 corner_y[SpriteBatch::kVerticesPerSprite];
+			corner_x[0] = _mm_sub_ps(x, diagonal_x);
+			corner_y[0] = _mm_sub_ps(y, diagonal_y);
+			corner_x[1] = _mm_add_ps(x, anti_diagonal_x);
+			corner_y[1] = _mm_add_ps(y, anti_diagonal_y);
+			corner_x[2] = _mm_add_ps(x, diagonal_x);
+			corner_y[2] = _mm_add_ps(y, diagonal_y);
+			corner_x[3] = _mm_sub_ps(x, anti_diagonal_x);
+			corner_y[3] = _mm_sub_ps(y, anti_diagonal_y);
+
+			__m128 u0, v0, u1, v1;
+			if (sprites.u && sprites.v && sprites.uv_width && sprites.uv_height)
+			{
+				u0 = _mm_loadu_ps(&sprites.u[index]);
+				v0 = _mm_loadu_ps(&sprites.v[index]);
+				u1 = _mm_add_ps(u0, _mm_loadu_ps(&sprites.uv_width[index]));
+				v1 = _mm_add_ps(v0, _mm_loadu_ps(&sprites.uv_height[index]));
+			}
+			else
+			{
+				u0 = v0 = _mm_setzero_ps();
+				u1 = v1 = _mm_set1_ps(1.0f);
+			}
+			const __m128 corner_u[SpriteBatch::kVerticesPerSprite] = { u0, u1, u1, u0 };
+			const __m128 corner_v[SpriteBatch::kVerticesPerSprite] = { v0, v0, v1, v1 };
+
+			for (UInt32 corner = 0; corner < SpriteBatch::kVerticesPerSprite; ++corner)
+			{
+				// transpose to one px, py, pz, colour row per sprite
+				__m128 row0 = corner_x[corner];
+				__m128 row1 = corner_y[corner];
+				__m128 row2 = z;
+				__m128 row3 = colour;
+				_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+				const __m128 uv01 = _mm_unpacklo_ps(corner_u[corner], corner_v[corner]);
+				const __m128 uv23 = _mm_unpackhi_ps(corner_u[corner], corner_v[corner]);
+
+				SpriteBatch::Vertex* vertex = &vertices[corner];
+				_mm_storeu_ps(&vertex->px, row0);
+				_mm_storel_pi((__m64*)&vertex->u, uv01);
+				vertex += SpriteBatch::kVerticesPerSprite;
+				_mm_storeu_ps(&vertex->px, row1);
+				_mm_storeh_pi((__m64*)&vertex->u, uv01);
+				vertex += SpriteBatch::kVerticesPerSprite;
+				_mm_storeu_ps(&vertex->px, row2);
+				_mm_storel_pi((__m64*)&vertex->u, uv23);
+				vertex += SpriteBatch::kVerticesPerSprite;
+				_mm_storeu_ps(&vertex->px, row3);
+				_mm_storeh_pi((__m64*)&vertex->u, uv23);
+			}
+		}
+
+		// copies up to four values to a padded group so the tail can use the four wide loads
+		template<typename T>
+		const T* CopyTail(const T* values, UInt32 index, UInt32 count, T* tail)
+		{
+			if (values == NULL)
+				return NULL;
+			memset(tail, 0, kSpritesPerGroup * sizeof(T));
+			memcpy(tail, &values[index], count * sizeof(T));
+			return tail;
+		}
+	}
+	SpriteBatch::SpriteBatch(UInt32 max_sprites) :
+		num_sprites_(0),
+		max_sprites_(max_sprites)
+	{
+		// the whole batch is allocated up front so adding sprites never reallocates
+		vertices_.resize(max_sprites_ * kVerticesPerSprite);
+	}
+
+	void SpriteBatch::Clear()
+	{
+		runs_.clear();
+		num_sprites_ = 0;
+	}
+
+	bool SpriteBatch::AddSprite(const Sprite& sprite, const Texture* texture)
+	{
+		if (full())
+			return false;
+
+		if (runs_.empty() || runs_.back().texture != texture)
+		{
+			Run run;
+			run.texture = texture;
+			run.first_sprite = num_sprites_;
+			run.num_sprites = 0;
+			runs_.push_back(run);
+		}
+
+		BuildQuad(sprite, &vertices_[num_sprites_ * kVerticesPerSprite]);
+		runs_.back().num_sprites++;
+		num_sprites_++;
+		return true;
+	}
+
+	UInt32 SpriteBatch::AddSprites(const SpriteArrays& sprites, UInt32 first, UInt32 count, const Texture* texture)
+	{
+		const UInt32 space = max_sprites_ - num_sprites_;
+		if (count > space)
+			count = space;
+		if (count == 0)
+			return 0;
+
+		if (runs_.empty() || runs_.back().texture != texture)
+		{
+			Run run;
+			run.texture = texture;
+			run.first_sprite = num_sprites_;
+			run.num_sprites = 0;
+			runs_.push_back(run);
+		}
+
+		BuildQuads(sprites, first, count, &vertices_[num_sprites_ * kVerticesPerSprite]);
+		runs_.back().num_sprites += count;
+		num_sprites_ += count;
+		return count;
+	}
+
+	void SpriteBatch::BuildQuad(const Sprite& sprite, Vertex* vertices)
+	{
+		// the same transform the sprite shader applies to the unit quad
+		float x_axis_x = sprite.width() * 0.5f;
+		float x_axis_y = 0.0f;
+		float y_axis_x = 0.0f;
+		float y_axis_y = sprite.height() * 0.5f;
+		if (sprite.rotation() != 0)
+		{
+			const float cos_rotation = cosf(sprite.rotation());
+			const float sin_rotation = sinf(sprite.rotation());
+			x_axis_y = sin_rotation * x_axis_x;
+			x_axis_x = cos_rotation * x_axis_x;
+			y_axis_x = -sin_rotation * y_axis_y;
+			y_axis_y = cos_rotation * y_axis_y;
+		}
+
+		const float x = sprite.position().x();
+		const float y = sprite.position().y();
+		const float z = sprite.position().z();
+		const float u0 = sprite.uv_position().x;
+		const float v0 = sprite.uv_position().y;
+		const float u1 = u0 + sprite.uv_width();
+		const float v1 = v0 + sprite.uv_height();
+
+		static const float kCornerX[kVerticesPerSprite] = { -1.0f, 1.0f, 1.0f, -1.0f };
+		static const float kCornerY[kVerticesPerSprite] = { -1.0f, -1.0f, 1.0f, 1.0f };
+		for (UInt32 corner = 0; corner < kVerticesPerSprite; ++corner)
+		{
+			Vertex& vertex = vertices[corner];
+			vertex.px = x + kCornerX[corner] * x_axis_x + kCornerY[corner] * y_axis_x;
+			vertex.py = y + kCornerX[corner] * x_axis_y + kCornerY[corner] * y_axis_y;
+			vertex.pz = z;
+			vertex.colour = sprite.colour();
+		}
+
+		vertices[0].u = u0; vertices[0].v = v0;
+		vertices[1].u = u1; vertices[1].v = v0;
+		vertices[2].u = u1; vertices[2].v = v1;
+		vertices[3].u = u0; vertices[3].v = v1;
+	}
+
+	void SpriteBatch::BuildSprite(const Vertex* vertices, Sprite& sprite)
+	{
+		// the corners are the centre minus and plus the sum of the half size axes, the edges are twice the axes
+		const float x_axis_x = (vertices[1].px - vertices[0].px) * 0.5f;
+		const float x_axis_y = (vertices[1].py - vertices[0].py) * 0.5f;
+		const float y_axis_x = (vertices[3].px - vertices[0].px) * 0.5f;
+		const float y_axis_y = (vertices[3].py - vertices[0].py) * 0.5f;
+
+		const float width = 2.0f * sqrtf(x_axis_x * x_axis_x + x_axis_y * x_axis_y);
+		const float height = 2.0f * sqrtf(y_axis_x * y_axis_x + y_axis_y * y_axis_y);
+		sprite.set_position((vertices[0].px + vertices[2].px) * 0.5f, (vertices[0].py + vertices[2].py) * 0.5f, vertices[0].pz);
+		sprite.set_width(width);
+		// a mirrored quad turns the other way from the x axis to the y axis
+		sprite.set_height(x_axis_x * y_axis_y - x_axis_y * y_axis_x < 0.0f ? -height : height);
+		sprite.set_rotation(width > 0.0f ? atan2f(x_axis_y, x_axis_x) : 0.0f);
+		sprite.set_colour(vertices[0].colour);
+		sprite.set_uv_position(Vector2(vertices[0].u, vertices[0].v));
+		sprite.set_uv_width(vertices[2].u - vertices[0].u);
+		sprite.set_uv_height(vertices[2].v - vertices[0].v);
+	}
+
+	void SpriteBatch::BuildQuads(const SpriteArrays& sprites, UInt32 first, UInt32 count, Vertex* vertices)
+	{
+		UInt32 sprite_num = 0;
+		for (; sprite_num + kSpritesPerGroup <= count; sprite_num += kSpritesPerGroup)
+			BuildQuads4(sprites, first + sprite_num, &vertices[sprite_num * kVerticesPerSprite]);
+
+		const UInt32 tail_count = count - sprite_num;
+		if (tail_count == 0)
+			return;
+
+		float tail_values[10][kSpritesPerGroup];
+		UInt32 tail_colour[kSpritesPerGroup];
+		const UInt32 index = first + sprite_num;
+		SpriteArrays tail;
+		tail.x = CopyTail(sprites.x, index, tail_count, tail_values[0]);
+		tail.y = CopyTail(sprites.y, index, tail_count, tail_values[1]);
+		tail.z = CopyTail(sprites.z, index, tail_count, tail_values[2]);
+		tail.width = CopyTail(sprites.width, index, tail_count, tail_values[3]);
+		tail.height = CopyTail(sprites.height, index, tail_count, tail_values[4]);
+		tail.rotation = CopyTail(sprites.rotation, index, tail_count, tail_values[5]);
+		tail.colour = CopyTail(sprites.colour, index, tail_count, tail_colour);
+		tail.u = CopyTail(sprites.u, index, tail_count, tail_values[6]);
+		tail.v = CopyTail(sprites.v, index, tail_count, tail_values[7]);
+		tail.uv_width = CopyTail(sprites.uv_width, index, tail_count, tail_values[8]);
+		tail.uv_height = CopyTail(sprites.uv_height, index, tail_count, tail_values[9]);
+
+		Vertex tail_vertices[kSpritesPerGroup * kVerticesPerSprite];
+		BuildQuads4(tail, 0, tail_vertices);
+		memcpy(&vertices[sprite_num * kVerticesPerSprite], tail_vertices, tail_count * kVerticesPerSprite * sizeof(Vertex));
+	}
+
+	void SpriteBatch::BuildIndices(UInt16* indices, UInt32 num_sprites)
+	{
+		// same winding as the unit quad of the unbatched sprite renderer
+		for (UInt32 sprite_num = 0; sprite_num < num_sprites; ++sprite_num)
+		{
+			const UInt16 base = (UInt16)(sprite_num * kVerticesPerSprite);
+			UInt16* sprite_indices = &indices[sprite_num * kIndicesPerSprite];
+			sprite_indices[0] = base;
+			sprite_indices[1] = (UInt16)(base + 1);
+			sprite_indices[2] = (UInt16)(base + 2);
+			sprite_indices[3] = base;
+			sprite_indices[4] = (UInt16)(base + 2);
+			sprite_indices[5] = (UInt16)(base + 3);
+		}
+	}
+}
@@ -0,0 +1,135 @@
+#ifndef _GEF_SPRITE_BATCH_H
+#define _GEF_SPRITE_BATCH_H
+
+#include <gef.h>
+#include <vector>
+#include <cstddef>
+
+namespace gef
+{
+	class Sprite;
+	class Texture;
+
+	/**
+	Sprites stored as one array per attribute instead of an array of Sprite objects.
+	Quads are built from the arrays four sprites at a time with SSE2.
+	Optional arrays may be NULL and take the value given in their comment.
+	*/
+	struct SpriteArrays
+	{
+		SpriteArrays() :
+			x(NULL), y(NULL), z(NULL),
+			width(NULL), height(NULL), rotation(NULL),
+			colour(NULL),
+			u(NULL), v(NULL), uv_width(NULL), uv_height(NULL)
+		{
+		}
+
+		/// Centre of each sprite.
+		const float* x;
+		const float* y;
+		/// Depth of each sprite, 0 if NULL.
+		const float* z;
+		const float* width;
+		const float* height;
+		/// Rotation in radians, no rotation if NULL.
+		const float* rotation;
+		/// Colour (ABGR) of each sprite, white if NULL.
+		const UInt32* colour;
+		/// Texture rectangle of each sprite, the whole texture if any are NULL.
+		const float* u;
+		const float* v;
+		const float* uv_width;
+		const float* uv_height;
+	};
+
+	/**
+	Builds the vertices of a batch of sprites on the CPU.
+	Each sprite is expanded to a quad of four vertices in screen space, so any number of sprites
+	can be drawn with one indexed draw call per run of sprites that share a texture.
+	Sprites keep the order they were added in, so the painter's order of the sprites is unchanged.
+	No device objects are used, the platform sprite renderers copy the vertices to the device.
+	*/
+	class SpriteBatch
+	{
+	public:
+		/// @brief The vertex layout of a batched sprite.
+		struct Vertex
+		{
+			float px;
+			float py;
+			float pz;
+			/// Colour of the sprite (ABGR), the byte order of an RGBA UNORM vertex attribute.
+			UInt32 colour;
+			float u;
+			float v;
+		};
+
+		/// @brief A run of consecutive sprites that are drawn with the same texture.
+		struct Run
+		{
+			const Texture* texture;
+			UInt32 first_sprite;
+			UInt32 num_sprites;
+		};
+
+		static const UInt32 kVerticesPerSprite = 4;
+		static const UInt32 kIndicesPerSprite = 6;
+		/// @brief The default number of sprites in a batch.
+		/// The vertices of a full batch can be indexed with 16 bit indices.
+		static const UInt32 kDefaultMaxSprites = 4096;
+
+		SpriteBatch(UInt32 max_sprites = kDefaultMaxSprites);
+
+		/// @brief Removes all sprites from the batch.
+		void Clear();
+
+		/// @brief Adds the quad of a sprite to the end of the batch.
+		/// @param[in] sprite		The sprite to add.
+		/// @param[in] texture		The texture the sprite is drawn with.
+		/// @return false if the batch is full.
+		bool AddSprite(const Sprite& sprite, const Texture* texture);
+
+		/// @brief Adds the quads of a range of sprites to the end of the batch.
+		/// @param[in] sprites		The sprite arrays.
+		/// @param[in] first		Index of the first sprite to add.
+		/// @param[in] count		The number of sprites to add.
+		/// @param[in] texture		The texture all of the sprites are drawn with.
+		/// @return The number of sprites added, fewer than count if the batch is full.
+		UInt32 AddSprites(const SpriteArrays& sprites, UInt32 first, UInt32 count, const Texture* texture);
+
+		/// @brief Writes the quad of a sprite to four vertices.
+		/// The corners are top left, top right, bottom right and bottom left of the unrotated sprite.
+		static void BuildQuad(const Sprite& sprite, Vertex* vertices);
+
+		/// @brief Reads back the sprite a quad was built from, the inverse of BuildQuad.
+		/// Sprites that were mirrored with a negative width or height come back rotated by half a turn
+		/// with the other size negated, which builds the same quad. The texture is not set.
+		static void BuildSprite(const Vertex* vertices, Sprite& sprite);
+
+		/// @brief Writes the quads of a range of sprites, four sprites at a time.
+		/// The corners are in the same order as BuildQuad. Rotation uses FastSinCos.
+		/// @param[out] vertices	Room for count*kVerticesPerSprite vertices.
+		static void BuildQuads(const SpriteArrays& sprites, UInt32 first, UInt32 count, Vertex* vertices);
+
+		/// @brief Writes the indices of the two triangles of each sprite quad.
+		/// @param[out] indices		Room for num_sprites*kIndicesPerSprite indices.
+		static void BuildIndices(UInt16* indices, UInt32 num_sprites);
+
+		inline bool empty() const { return num_sprites_ == 0; }
+		inline bool full() const { return num_sprites_ == max_sprites_; }
+		inline UInt32 num_sprites() const { return num_sprites_; }
+		inline UInt32 max_sprites() const { return max_sprites_; }
+		inline const Vertex* vertices() const { return vertices_.data(); }
+		inline UInt32 num_vertices() const { return num_sprites_ * kVerticesPerSprite; }
+		inline const std::vector<Run>& runs() const { return runs_; }
+
+	private:
+		std::vector<Vertex> vertices_;
+		std::vector<Run> runs_;
+		UInt32 num_sprites_;
+		UInt32 max_sprites_;
+	};
+}
+
+#endif // _GEF_SPRITE_BATCH_H
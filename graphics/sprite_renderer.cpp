@@ -7,6 +7,10 @@
 #include <cstdlib>
 #include <math.h>
 #include <graphics/shader.h>
+#include <graphics/render_queue.h>
+#include <system/platform.h>
+#include <cstring>
+#include <exception>
 
 namespace gef
 {
@@ -14,7 +18,12 @@ namespace gef
 SpriteRenderer::SpriteRenderer(Platform& platform) :
 platform_(platform),
 	shader_(NULL),
-	default_shader_(platform_)
+	default_shader_(platform_),
+	batch_shader_(NULL),
+	batch_shader_failed_(false),
+	batching_(false),
+	sprite_quad_bound_(false),
+	sort_mode_(kSortNone)
 {
 	//SCE_DBG_ASSERT(platform_ != NULL);
 }
@@ -22,14 +31,190 @@ platform_(platform),
 
 SpriteRenderer::~SpriteRenderer()
 {
+	if (batch_shader_)
+	{
+		platform_.RemoveShader(batch_shader_);
+		delete batch_shader_;
+	}
+}
+
+DefaultSpriteBatchShader* SpriteRenderer::GetBatchShader()
+{
+	if (batch_shader_ == NULL && !batch_shader_failed_)
+	{
+		// batching is optional, so a vertex shader that fails to compile only disables it
+		try
+		{
+			batch_shader_ = new DefaultSpriteBatchShader(platform_);
+		}
+		catch (const std::exception&)
+		{
+			batch_shader_failed_ = true;
+			return NULL;
+		}
+		platform_.AddShader(batch_shader_);
+	}
+	return batch_shader_;
+}
+
+bool SpriteRenderer::BatchingActive()
+{
+	return batching_ && shader_ == &default_shader_ && GetBatchShader() != NULL;
 }
 
 void SpriteRenderer::SetShader( Shader* shader)
 {
+	// sprites already queued or batched are drawn with the shader they were submitted with
+	DrawSortedSprites();
+	if (!batch_.empty())
+		FlushBatch();
+
 	if(shader == NULL)
 		set_shader(&default_shader_);
 	else
 		set_shader(shader);
+	sprite_quad_bound_ = false;
+}
+
+void SpriteRenderer::DrawSprite(const Sprite& sprite)
+{
+	if (sort_mode_ == kSortNone)
+		RenderSprite(sprite);
+	else
+		sort_queue_.push_back(sprite);
+}
+
+void SpriteRenderer::DrawQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Vertex* vertices, const SpriteBatch::Run* runs, UInt32 num_runs)
+{
+	if (num_runs == 0)
+		return;
+
+	DrawSortedSprites();
+	if (!batch_.empty())
+		FlushBatch();
+	if (GetBatchShader())
+		RenderQuads(vertex_buffer, runs, num_runs);
+	else
+		DrawQuadsAsSprites(vertices, runs, num_runs);
+}
+
+void SpriteRenderer::DrawQuadsAsSprites(const SpriteBatch::Vertex* vertices, const SpriteBatch::Run* runs, UInt32 num_runs)
+{
+	// the quads are drawn with the default pixel shader, as the batch shader would
+	Shader* previous_shader = shader_;
+	SetShader(NULL);
+
+	Sprite sprite;
+	for (UInt32 run_num = 0; run_num < num_runs; ++run_num)
+	{
+		const SpriteBatch::Run& run = runs[run_num];
+		for (UInt32 sprite_num = run.first_sprite; sprite_num < run.first_sprite + run.num_sprites; ++sprite_num)
+		{
+			SpriteBatch::BuildSprite(&vertices[sprite_num * SpriteBatch::kVerticesPerSprite], sprite);
+
+			// unused quads are degenerate
+			if (sprite.width() == 0.0f || sprite.height() == 0.0f)
+				continue;
+			sprite.set_texture(run.texture);
+			RenderSprite(sprite);
+		}
+	}
+
+	SetShader(previous_shader);
+}
+
+void SpriteRenderer::DrawSprites(const SpriteArrays& sprites, UInt32 count, const Texture* texture)
+{
+	if (BatchingActive() && sort_mode_ == kSortNone)
+	{
+		UInt32 sprite_num = 0;
+		while (sprite_num < count)
+		{
+			if (batch_.full())
+				FlushBatch();
+			sprite_num += batch_.AddSprites(sprites, sprite_num, count - sprite_num, texture);
+		}
+		return;
+	}
+
+	const bool has_uvs = sprites.u && sprites.v && sprites.uv_width && sprites.uv_height;
+	Sprite sprite;
+	sprite.set_texture(texture);
+	for (UInt32 sprite_num = 0; sprite_num < count; ++sprite_num)
+	{
+		sprite.set_position(sprites.x[sprite_num], sprites.y[sprite_num], sprites.z ? sprites.z[sprite_num] : 0.0f);
+		sprite.set_width(sprites.width[sprite_num]);
+		sprite.set_height(sprites.height[sprite_num]);
+		sprite.set_rotation(sprites.rotation ? sprites.rotation[sprite_num] : 0.0f);
+		sprite.set_colour(sprites.colour ? sprites.colour[sprite_num] : 0xffffffff);
+		if (has_uvs)
+		{
+			sprite.set_uv_position(Vector2(sprites.u[sprite_num], sprites.v[sprite_num]));
+			sprite.set_uv_width(sprites.uv_width[sprite_num]);
+			sprite.set_uv_height(sprites.uv_height[sprite_num]);
+		}
+		DrawSprite(sprite);
+	}
+}
+
+void SpriteRenderer::DrawSortedSprites()
+{
+	const UInt32 count = (UInt32)sort_queue_.size();
+	if (count == 0)
+		return;
+
+	sort_keys_.resize(count);
+	sort_keys_temp_.resize(count);
+	sort_order_.resize(count);
+	sort_order_temp_.resize(count);
+
+	// textures are numbered in the order they are first used
+	sort_texture_ids_.clear();
+	const Texture* last_texture = NULL;
+	UInt32 last_texture_id = 0;
+
+	for (UInt32 sprite_num = 0; sprite_num < count; ++sprite_num)
+	{
+		const Sprite& sprite = sort_queue_[sprite_num];
+
+		// flip the float bits so they sort in order as unsigned integers, then invert for back to front
+		const float depth = sprite.position().z();
+		UInt32 depth_bits;
+		memcpy(&depth_bits, &depth, sizeof(float));
+		depth_bits ^= (depth_bits & 0x80000000) ? 0xffffffff : 0x80000000;
+		UInt64 key = (UInt64)(~depth_bits) << 16;
+
+		if (sort_mode_ == kSortDepthTexture)
+		{
+			if (sprite_num == 0 || sprite.texture() != last_texture)
+			{
+				last_texture = sprite.texture();
+				std::unordered_map<const Texture*, UInt32>::iterator texture_iter = sort_texture_ids_.find(last_texture);
+				if (texture_iter == sort_texture_ids_.end())
+					texture_iter = sort_texture_ids_.insert(std::make_pair(last_texture, (UInt32)sort_texture_ids_.size())).first;
+				last_texture_id = texture_iter->second < 0xffff ? texture_iter->second : 0xffff;
+			}
+			key |= last_texture_id;
+		}
+
+		sort_keys_[sprite_num] = key;
+		sort_order_[sprite_num] = sprite_num;
+	}
+
+	// the radix sort is stable, so sprites with the same key keep their call order
+	RenderQueue::RadixSort(sort_keys_.data(), sort_order_.data(), count, sort_keys_temp_.data(), sort_order_temp_.data());
+
+	for (UInt32 sprite_num = 0; sprite_num < count; ++sprite_num)
+		RenderSprite(sort_queue_[sort_order_[sprite_num]]);
+
+	sort_queue_.clear();
+}
+
+void SpriteRenderer::BatchSprite(const Sprite& sprite, const Texture* texture)
+{
+	if (batch_.full())
+		FlushBatch();
+	batch_.AddSprite(sprite, texture);
 }
 
 void SpriteRenderer::BuildSpriteShaderData(const Sprite& sprite, Matrix44& sprite_data)
@@ -58,10 +243,12 @@ void SpriteRenderer::BuildSpriteShaderData(const Sprite& sprite, Matrix44& sprit
 		}
 		else
 		{
-			sprite_data.set_m(0,0,cosf(sprite.rotation())*sprite.width());
-			sprite_data.set_m(0,1,sinf(sprite.rotation())*sprite.width());
-			sprite_data.set_m(1,0,-sinf(sprite.rotation())*sprite.height());
-			sprite_data.set_m(1,1,cosf(sprite.rotation())*sprite.height());
+			const float cos_rotation = cosf(sprite.rotation());
+			const float sin_rotation = sinf(sprite.rotation());
+			sprite_data.set_m(0,0,cos_rotation*sprite.width());
+			sprite_data.set_m(0,1,sin_rotation*sprite.width());
+			sprite_data.set_m(1,0,-sin_rotation*sprite.height());
+			sprite_data.set_m(1,1,cos_rotation*sprite.height());
 		}
 
         // Source rectangle
@@ -3,6 +3,11 @@
 
 #include <maths/matrix44.h>
 #include <graphics/default_sprite_shader.h>
+#include <graphics/default_sprite_batch_shader.h>
+#include <graphics/sprite_batch.h>
+#include <graphics/sprite.h>
+#include <unordered_map>
+#include <vector>
 
 namespace gef
 {
@@ -11,25 +16,95 @@ namespace gef
 	class Sprite;
 	class Platform;
 	class Shader;
+	class Texture;
+	class VertexBuffer;
 
 	class SpriteRenderer
 	{
 	public:
+		/// @brief The order sprites are drawn in.
+		enum SortMode
+		{
+			/// Sprites are drawn in the order DrawSprite is called.
+			kSortNone = 0,
+			/// Sprites are drawn back to front by their position z value, sprites at the same depth in call order.
+			kSortDepth,
+			/// As kSortDepth, but sprites at the same depth are grouped by texture so they batch together.
+			/// Only use when sprites at the same depth do not overlap, or when their overlap order does not matter.
+			kSortDepthTexture
+		};
+
 		virtual ~SpriteRenderer();
 		void SetShader( Shader* shader);
 
 		virtual void Begin(bool clear = true) = 0;
-		virtual void DrawSprite(const Sprite& sprite) = 0;
+		/// @brief Draws a sprite, or queues it to be sorted if a sort mode is set.
+		virtual void DrawSprite(const Sprite& sprite);
+		/// @brief Draws sprites stored as arrays, all with the same texture.
+		/// With batching on and no sort mode the quads are built straight from the arrays four at a time,
+		/// otherwise each sprite is drawn with DrawSprite.
+		/// @param[in] sprites		The sprite arrays.
+		/// @param[in] count		The number of sprites in the arrays.
+		/// @param[in] texture		The texture of the sprites, NULL for the default texture.
+		void DrawSprites(const SpriteArrays& sprites, UInt32 count, const Texture* texture);
+		/// @brief Draws sprite quads that are already in a vertex buffer, e.g. the quads of a UILayer.
+		/// Sprites drawn before are drawn first, including queued sorted sprites, so the quads are drawn over them.
+		/// Quads are drawn with the batch shader whether batching is on or not, or as sprites if it could not be created.
+		/// @param[in] vertex_buffer	SpriteBatch::Vertex quads with the corners in the order of SpriteBatch::BuildQuad.
+		/// @param[in] vertices			The same quads in memory, read only if they are drawn as sprites.
+		/// @param[in] runs				Ranges of quads in the buffer and the texture each is drawn with, NULL for the default texture.
+		/// @param[in] num_runs			The number of runs, one draw call each, or more for runs longer than a full batch.
+		void DrawQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Vertex* vertices, const SpriteBatch::Run* runs, UInt32 num_runs);
 		virtual void End() = 0;
 
 		inline const Matrix44& projection_matrix() const { return projection_matrix_; }
 		inline void set_projection_matrix(const  Matrix44& matrix) {projection_matrix_ = matrix;}
 
+		/// @brief Draws sprites in batches instead of one draw call per sprite.
+		/// Sprites that use the default shader are collected between Begin and End, consecutive sprites
+		/// with the same texture share a draw call. The batch is drawn when it is full, when the shader
+		/// is changed and at End. Call outside of Begin and End.
+		/// The batch vertex shader default_sprite_batch_shader_vs is deployed by the application, see DefaultSpriteBatchShader.
+		/// If it could not be created, sprites are drawn one at a time as if batching were off.
+		inline void set_batching(bool batching) { batching_ = batching; }
+		inline bool batching() const { return batching_; }
+
+		/// @brief Sorts the sprites drawn between Begin and End before drawing them.
+		/// Sorted sprites are drawn at End, or when the shader is changed. Call outside of Begin and End.
+		inline void set_sort_mode(SortMode sort_mode) { sort_mode_ = sort_mode; }
+		inline SortMode sort_mode() const { return sort_mode_; }
+
 		static SpriteRenderer* Create(Platform& platform);
 	protected:
 		SpriteRenderer(Platform& platform);
 		void BuildSpriteShaderData(const Sprite& sprite, Matrix44& sprite_data);
 
+		/// @brief Draws a sprite without sorting.
+		virtual void RenderSprite(const Sprite& sprite) = 0;
+		/// @brief Sorts the sprites queued by DrawSprite and draws them.
+		void DrawSortedSprites();
+
+		/// @brief The number of sprites the platform vertex ring buffers hold, several full batches.
+		static const UInt32 kBatchRingBufferSprites = 4 * SpriteBatch::kDefaultMaxSprites;
+
+		/// @brief Adds a sprite to the batch, drawing the batch first if it is full.
+		void BatchSprite(const Sprite& sprite, const Texture* texture);
+		/// @brief Draws the sprites in the batch and clears it.
+		/// Sprites are only batched while there is a batch shader, so it is never NULL here.
+		virtual void FlushBatch() = 0;
+		/// @brief Draws runs of quads from a vertex buffer with the batch shader and index buffer.
+		/// Only called when there is a batch shader.
+		virtual void RenderQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Run* runs, UInt32 num_runs) = 0;
+		/// @return true if sprites are being drawn with the batch shader, creating it if batching is on.
+		bool BatchingActive();
+		/// @brief Get the batch shader, creating it on the first call.
+		/// Only renderers that batch sprites or draw quads need it, so it is not compiled until then.
+		/// @return The shader, or NULL if it could not be created, e.g. because the application does not deploy
+		/// its vertex shader. Creation is not retried.
+		DefaultSpriteBatchShader* GetBatchShader();
+		/// @brief Draws runs of quads one sprite at a time with the default shader, when there is no batch shader.
+		void DrawQuadsAsSprites(const SpriteBatch::Vertex* vertices, const SpriteBatch::Run* runs, UInt32 num_runs);
+
 		inline void set_shader( Shader* shader) { shader_ = shader; }
 
 		Platform& platform_;
@@ -37,6 +112,23 @@ namespace gef
 
 		Shader* shader_;
 		DefaultSpriteShader default_shader_;
+
+		DefaultSpriteBatchShader* batch_shader_;
+		bool batch_shader_failed_;
+		SpriteBatch batch_;
+		bool batching_;
+		// false after a batch is drawn or the shader is changed, as the per sprite draws need the unit quad
+		// and the default shader bound again
+		bool sprite_quad_bound_;
+
+		SortMode sort_mode_;
+		// sort scratch, kept to avoid allocating every frame
+		std::vector<Sprite> sort_queue_;
+		std::vector<UInt64> sort_keys_;
+		std::vector<UInt64> sort_keys_temp_;
+		std::vector<UInt32> sort_order_;
+		std::vector<UInt32> sort_order_temp_;
+		std::unordered_map<const Texture*, UInt32> sort_texture_ids_;
 	};
 }
 #endif // _GEF_SPRITE_RENDERER_H
@@ -0,0 +1,109 @@
+#include <graphics/text_batch.h>
+#include <graphics/sprite_renderer.h>
+#include <maths/vector4.h>
+
+namespace gef
+{
+	TextBatch::TextBatch() :
+		num_pages_(0)
+	{
+	}
+
+	TextBatch::Page& TextBatch::GetPage(const Texture* texture)
+	{
+		// fonts rarely have more than a few pages, so a linear search is fastest
+		for (UInt32 page_num = 0; page_num < num_pages_; ++page_num)
+		{
+			if (pages_[page_num].texture == texture)
+				return pages_[page_num];
+		}
+
+		if (num_pages_ == pages_.size())
+			pages_.push_back(Page());
+		Page& page = pages_[num_pages_++];
+		page.texture = texture;
+		return page;
+	}
+
+	void TextBatch::AddText(const Font& font, const Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, const std::wstring& text)
+	{
+		if (text.empty())
+			return;
+
+		const Font::TextLayout& layout = font.LayoutText(text, scale, justification);
+		const Texture* last_texture = NULL;
+		Page* page = NULL;
+		for (const Font::GlyphQuad& quad : layout.quads)
+		{
+			if (page == NULL || quad.texture != last_texture)
+			{
+				page = &GetPage(quad.texture);
+				last_texture = quad.texture;
+			}
+
+			page->x.push_back(pos.x() + quad.x);
+			page->y.push_back(pos.y() + quad.y);
+			page->z.push_back(pos.z());
+			page->width.push_back(quad.width);
+			page->height.push_back(quad.height);
+			page->colour.push_back(colour);
+			page->u.push_back(quad.uv_position.x);
+			page->v.push_back(quad.uv_position.y);
+			page->uv_width.push_back(quad.uv_width);
+			page->uv_height.push_back(quad.uv_height);
+		}
+	}
+
+	void TextBatch::Draw(SpriteRenderer& sprite_renderer)
+	{
+		for (UInt32 page_num = 0; page_num < num_pages_; ++page_num)
+		{
+			const Page& page = pages_[page_num];
+			SpriteArrays arrays;
+			arrays.x = page.x.data();
+			arrays.y = page.y.data();
+			arrays.z = page.z.data();
+			arrays.width = page.width.data();
+			arrays.height = page.height.data();
+			arrays.colour = page.colour.data();
+			arrays.u = page.u.data();
+			arrays.v = page.v.data();
+			arrays.uv_width = page.uv_width.data();
+			arrays.uv_height = page.uv_height.data();
+			sprite_renderer.DrawSprites(arrays, (UInt32)page.x.size(), page.texture);
+		}
+		Clear();
+	}
+
+	void TextBatch::Clear()
+	{
+		for (UInt32 page_num = 0; page_num < num_pages_; ++page_num)
+		{
+			Page& page = pages_[page_num];
+			page.x.clear();
+			page.y.clear();
+			page.z.clear();
+			page.width.clear();
+			page.height.clear();
+			page.colour.clear();
+			page.u.clear();
+			page.v.clear();
+			page.uv_width.clear();
+			page.uv_height.clear();
+		}
+		num_pages_ = 0;
+	}
+
+	UInt32 TextBatch::num_glyphs() const
+	{
+		UInt32 num_glyphs = 0;
+		for (UInt32 page_num = 0; page_num < num_pages_; ++page_num)
+			num_glyphs += (UInt32)pages_[page_num].x.size();
+		return num_glyphs;
+	}
+
+	UInt32 TextBatch::num_pages() const
+	{
+		return num_pages_;
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef _GEF_TEXT_BATCH_H
+#define _GEF_TEXT_BATCH_H
+
+#include <gef.h>
+#include <graphics/font.h>
+#include <graphics/sprite_batch.h>
+#include <vector>
+#include <string>
+
+namespace gef
+{
+	class SpriteRenderer;
+	class Texture;
+	class Vector4;
+
+	/**
+	Collects the glyph quads of many strings and draws them with one DrawSprites call per font page.
+	With sprite batching on, all of the text on a page is one draw call instead of one per glyph,
+	so a frame of text that uses one single page font is a single draw.
+	Text is drawn page by page, so overlapping glyphs on different pages do not keep the order they were added in.
+	Fonts drawn through a GlyphAtlas have one page, the atlas texture.
+	*/
+	class TextBatch
+	{
+	public:
+		TextBatch();
+
+		/// @brief Adds the glyphs of a string, with the same arguments as Font::RenderText.
+		/// The layout comes from the layout cache of the font.
+		void AddText(const Font& font, const Vector4& pos, const float scale, const UInt32 colour, const TextJustification justification, const std::wstring& text);
+
+		/// @brief Draws the text added since the last call and clears the batch.
+		/// Call between Begin and End of the sprite renderer.
+		void Draw(SpriteRenderer& sprite_renderer);
+
+		/// @brief Removes all text without drawing it.
+		void Clear();
+
+		/// @return The number of glyphs waiting to be drawn.
+		UInt32 num_glyphs() const;
+		/// @return The number of pages with glyphs waiting to be drawn, the number of DrawSprites calls Draw makes.
+		UInt32 num_pages() const;
+
+	private:
+		// the glyphs added on one font page texture, as sprite arrays
+		struct Page
+		{
+			const Texture* texture;
+			std::vector<float> x;
+			std::vector<float> y;
+			std::vector<float> z;
+			std::vector<float> width;
+			std::vector<float> height;
+			std::vector<UInt32> colour;
+			std::vector<float> u;
+			std::vector<float> v;
+			std::vector<float> uv_width;
+			std::vector<float> uv_height;
+		};
+
+		Page& GetPage(const Texture* texture);
+
+		// pages are kept after Clear so their arrays are reused, only the first num_pages_ are in use
+		std::vector<Page> pages_;
+		UInt32 num_pages_;
+	};
+}
+
+#endif // _GEF_TEXT_BATCH_H
@@ -17,6 +17,11 @@ namespace gef
 	{
 	}
 
+	bool Texture::Update(const Platform&, UInt32, UInt32, UInt32, UInt32, const UInt8*, UInt32)
+	{
+		return false;
+	}
+
 	Texture* Texture::CreateCheckerTexture(const Int32 size, const Int32 num_checkers, const Platform& platform)
 	{
 		const UInt32 check_size = size / num_checkers;
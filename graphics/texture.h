@@ -16,6 +16,14 @@ public:
 	virtual void Bind(const Platform& platform, const int texture_stage_num) const = 0;
 	virtual void Unbind(const Platform& platform, const int texture_stage_num) const = 0;
 
+	/// @brief Copies RGBA pixels into a rectangle of the texture, e.g. to add glyphs to a GlyphAtlas.
+	/// @param[in] x, y				Top left of the rectangle in texels.
+	/// @param[in] width, height	Size of the rectangle in texels.
+	/// @param[in] pixels			The pixels of the top left texel of the rectangle.
+	/// @param[in] row_pitch		Bytes from one row of pixels to the next.
+	/// @return false if the platform can not update textures.
+	virtual bool Update(const Platform& platform, UInt32 x, UInt32 y, UInt32 width, UInt32 height, const UInt8* pixels, UInt32 row_pitch);
+
 	static Texture* Create(const Platform& platform, const ImageData& image_data);
 	static Texture* CreateCheckerTexture(const Int32 size, const Int32 num_checkers, const Platform& platform);
 	static Texture* CreateSolidTexture(const Int32 size, gef::Colour colour, const Platform& platform);
@@ -0,0 +1,371 @@
+#include <graphics/texture_atlas.h>
+#include <graphics/skyline_packer.h>
+#include <graphics/texture.h>
+#include <graphics/sprite.h>
+#include <system/file.h>
+#include <system/memory_stream_buffer.h>
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+
+namespace gef
+{
+	namespace
+	{
+		const UInt32 kAtlasFileId = 0x41464547;		// "GEFA"
+		const UInt32 kAtlasFileVersion = 1;
+		const UInt32 kBytesPerPixel = 4;
+		// the largest texture side D3D11 supports, which keeps the atlas image under 1GB
+		const UInt32 kMaxAtlasSize = 16384;
+
+		// the number of bytes left to read, -1 if the stream can not seek
+		Int64 GetRemainingSize(std::istream& stream)
+		{
+			const std::streampos position = stream.tellg();
+			if (position == std::streampos(-1))
+				return -1;
+			stream.seekg(0, std::ios::end);
+			const std::streampos end = stream.tellg();
+			stream.seekg(position);
+			if (end == std::streampos(-1) || !stream.good())
+				return -1;
+			return (Int64)(end - position);
+		}
+
+		// true if the rectangle fits in the image, without the sums overflowing
+		bool RegionInImage(UInt32 x, UInt32 y, UInt32 width, UInt32 height, UInt32 image_width, UInt32 image_height)
+		{
+			return width <= image_width && x <= image_width - width && height <= image_height && y <= image_height - height;
+		}
+	}
+
+	TextureAtlas::TextureAtlas() :
+		texture_(NULL)
+	{
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{
+		Release();
+	}
+
+	void TextureAtlas::Release()
+	{
+		delete texture_;
+		texture_ = NULL;
+
+		delete[] image_data_.image();
+		image_data_.set_image(NULL);
+		image_data_.set_width(0);
+		image_data_.set_height(0);
+
+		regions_.clear();
+	}
+
+	void TextureAtlas::AddImage(const char* name, const ImageData& image_data)
+	{
+		Source source;
+		source.name_id = names_.Add(name);
+		source.image_data = &image_data;
+		sources_.push_back(source);
+	}
+
+	bool TextureAtlas::PackSources(UInt32 width, UInt32 height, UInt32 padding, std::vector<Region>& regions) const
+	{
+		// tallest images first leaves the flattest skyline
+		std::vector<size_t> order(sources_.size());
+		for (size_t source_num = 0; source_num < sources_.size(); ++source_num)
+			order[source_num] = source_num;
+		std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+		{
+			const ImageData& image_a = *sources_[a].image_data;
+			const ImageData& image_b = *sources_[b].image_data;
+			if (image_a.height() != image_b.height())
+				return image_a.height() > image_b.height();
+			return image_a.width() > image_b.width();
+		});
+
+		SkylinePacker packer(width, height);
+		regions.resize(sources_.size());
+		for (size_t source_num : order)
+		{
+			const ImageData& image = *sources_[source_num].image_data;
+			Region& region = regions[source_num];
+			region.width = image.width();
+			region.height = image.height();
+			if (!packer.Pack(image.width() + padding, image.height() + padding, region.x, region.y))
+				return false;
+		}
+		return true;
+	}
+
+	bool TextureAtlas::Build(UInt32 max_size, UInt32 padding)
+	{
+		Release();
+
+		if (max_size > kMaxAtlasSize)
+			max_size = kMaxAtlasSize;
+
+		UInt64 total_area = 0;
+		UInt64 largest_side = 1;
+		for (const Source& source : sources_)
+		{
+			if (source.image_data->image() == NULL)
+				return false;
+			const UInt64 width = (UInt64)source.image_data->width() + padding;
+			const UInt64 height = (UInt64)source.image_data->height() + padding;
+			total_area += width * height;
+			largest_side = std::max(largest_side, std::max(width, height));
+		}
+		if (largest_side > max_size || total_area > (UInt64)max_size * max_size)
+			return false;
+
+		// start at the smallest power of two square that could hold every image, then grow the shorter side
+		UInt32 width = 1;
+		while (width < largest_side || (UInt64)width * width < total_area)
+			width *= 2;
+		UInt32 height = width;
+
+		std::vector<Region> regions;
+		while (width <= max_size && height <= max_size)
+		{
+			if (PackSources(width, height, padding, regions))
+				break;
+			if (width <= height)
+				width *= 2;
+			else
+				height *= 2;
+		}
+		if (width > max_size || height > max_size)
+			return false;
+
+		const size_t image_size = (size_t)width * height * kBytesPerPixel;
+		UInt8* atlas_image = new UInt8[image_size];
+		memset(atlas_image, 0, image_size);
+		image_data_.set_image(atlas_image);
+		image_data_.set_width(width);
+		image_data_.set_height(height);
+
+		for (size_t source_num = 0; source_num < sources_.size(); ++source_num)
+		{
+			const ImageData& image = *sources_[source_num].image_data;
+			Region& region = regions[source_num];
+
+			const UInt32 row_size = region.width * kBytesPerPixel;
+			for (UInt32 row = 0; row < region.height; ++row)
+				memcpy(&atlas_image[((size_t)(region.y + row) * width + region.x) * kBytesPerPixel], &image.image()[(size_t)row * row_size], row_size);
+
+			CalculateUVs(region);
+			regions_[sources_[source_num].name_id] = region;
+		}
+
+		// the images only need to stay valid until they are packed
+		sources_.clear();
+		return true;
+	}
+
+	void TextureAtlas::CalculateUVs(Region& region) const
+	{
+		const float width = (float)image_data_.width();
+		const float height = (float)image_data_.height();
+		region.uv_position = Vector2((float)region.x / width, (float)region.y / height);
+		region.uv_width = (float)region.width / width;
+		region.uv_height = (float)region.height / height;
+	}
+
+	bool TextureAtlas::CreateTexture(const Platform& platform)
+	{
+		if (image_data_.image() == NULL)
+			return false;
+
+		delete texture_;
+		texture_ = Texture::Create(platform, image_data_);
+		return texture_ != NULL;
+	}
+
+	const TextureAtlas::Region* TextureAtlas::FindRegion(StringId name_id) const
+	{
+		std::map<StringId, Region>::const_iterator iter = regions_.find(name_id);
+		return iter != regions_.end() ? &iter->second : NULL;
+	}
+
+	const TextureAtlas::Region* TextureAtlas::FindRegion(const char* name) const
+	{
+		return FindRegion(GetStringId(name));
+	}
+
+	bool TextureAtlas::SetSprite(StringId name_id, Sprite& sprite) const
+	{
+		const Region* region = FindRegion(name_id);
+		if (region == NULL)
+			return false;
+
+		sprite.set_texture(texture_);
+		sprite.set_uv_position(region->uv_position);
+		sprite.set_uv_width(region->uv_width);
+		sprite.set_uv_height(region->uv_height);
+		return true;
+	}
+
+	bool TextureAtlas::RemapSprite(StringId name_id, Sprite& sprite) const
+	{
+		const Region* region = FindRegion(name_id);
+		if (region == NULL)
+			return false;
+
+		sprite.set_texture(texture_);
+		sprite.set_uv_position(Vector2(
+			region->uv_position.x + sprite.uv_position().x * region->uv_width,
+			region->uv_position.y + sprite.uv_position().y * region->uv_height));
+		sprite.set_uv_width(sprite.uv_width() * region->uv_width);
+		sprite.set_uv_height(sprite.uv_height() * region->uv_height);
+		return true;
+	}
+
+	bool TextureAtlas::Write(std::ostream& stream) const
+	{
+		if (image_data_.image() == NULL)
+			return false;
+
+		const UInt32 width = image_data_.width();
+		const UInt32 height = image_data_.height();
+		const UInt32 region_count = (UInt32)regions_.size();
+
+		stream.write((char*)&kAtlasFileId, sizeof(UInt32));
+		stream.write((char*)&kAtlasFileVersion, sizeof(UInt32));
+		stream.write((char*)&width, sizeof(UInt32));
+		stream.write((char*)&height, sizeof(UInt32));
+		stream.write((char*)&region_count, sizeof(UInt32));
+
+		// regions are written with their names, so ids still match if the id hash changes
+		for (std::map<StringId, Region>::const_iterator region_iter = regions_.begin(); region_iter != regions_.end(); ++region_iter)
+		{
+			std::map<StringId, std::string>::const_iterator name_iter = names_.table().find(region_iter->first);
+			const std::string name = name_iter != names_.table().end() ? name_iter->second : std::string();
+			stream.write(name.c_str(), name.length() + 1);
+
+			const Region& region = region_iter->second;
+			stream.write((char*)&region.x, sizeof(UInt32));
+			stream.write((char*)&region.y, sizeof(UInt32));
+			stream.write((char*)&region.width, sizeof(UInt32));
+			stream.write((char*)&region.height, sizeof(UInt32));
+		}
+
+		stream.write((char*)image_data_.image(), width * height * kBytesPerPixel);
+
+		return stream.good();
+	}
+
+	bool TextureAtlas::Read(std::istream& stream)
+	{
+		Release();
+		names_ = StringIdTable();
+
+		UInt32 file_id = 0;
+		UInt32 version = 0;
+		UInt32 width = 0;
+		UInt32 height = 0;
+		UInt32 region_count = 0;
+
+		stream.read((char*)&file_id, sizeof(UInt32));
+		stream.read((char*)&version, sizeof(UInt32));
+		if (!stream.good() || file_id != kAtlasFileId || version != kAtlasFileVersion)
+			return false;
+
+		stream.read((char*)&width, sizeof(UInt32));
+		stream.read((char*)&height, sizeof(UInt32));
+		stream.read((char*)&region_count, sizeof(UInt32));
+		if (!stream.good() || width == 0 || height == 0 || width > kMaxAtlasSize || height > kMaxAtlasSize)
+			return false;
+
+		image_data_.set_width(width);
+		image_data_.set_height(height);
+
+		for (UInt32 region_num = 0; region_num < region_count; ++region_num)
+		{
+			std::string name;
+			std::getline(stream, name, '\0');
+
+			Region region;
+			stream.read((char*)&region.x, sizeof(UInt32));
+			stream.read((char*)&region.y, sizeof(UInt32));
+			stream.read((char*)&region.width, sizeof(UInt32));
+			stream.read((char*)&region.height, sizeof(UInt32));
+			if (!stream.good() || !RegionInImage(region.x, region.y, region.width, region.height, width, height))
+			{
+				Release();
+				return false;
+			}
+
+			CalculateUVs(region);
+			regions_[names_.Add(name)] = region;
+		}
+
+		// a truncated or corrupt file must not allocate an image it does not hold
+		const UInt64 image_size = (UInt64)width * height * kBytesPerPixel;
+		const Int64 remaining_size = GetRemainingSize(stream);
+		if (remaining_size < 0 || (UInt64)remaining_size < image_size)
+		{
+			Release();
+			return false;
+		}
+
+		UInt8* atlas_image = new UInt8[(size_t)image_size];
+		image_data_.set_image(atlas_image);
+		stream.read((char*)atlas_image, (std::streamsize)image_size);
+		if (stream.fail())
+		{
+			Release();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextureAtlas::WriteToFile(const char* filename) const
+	{
+		std::ofstream file_stream(filename, std::ios::out | std::ios::binary);
+		if (!file_stream.is_open())
+			return false;
+
+		const bool success = Write(file_stream);
+		file_stream.close();
+		return success;
+	}
+
+	bool TextureAtlas::ReadFromFile(const char* filename)
+	{
+		File* file = File::Create();
+		void* file_data = NULL;
+		Int32 file_size = 0;
+
+		bool success = file->Open(filename);
+		if (success)
+		{
+			success = file->GetSize(file_size);
+			if (success)
+			{
+				file_data = malloc(file_size);
+				success = file_data != NULL;
+				if (success)
+				{
+					Int32 bytes_read;
+					success = file->Read(file_data, file_size, bytes_read) && bytes_read == file_size;
+				}
+			}
+			file->Close();
+		}
+		delete file;
+
+		if (success)
+		{
+			MemoryStreamBuffer stream_buffer((char*)file_data, file_size);
+			std::istream input_stream(&stream_buffer);
+			success = Read(input_stream);
+		}
+
+		free(file_data);
+		return success;
+	}
+}
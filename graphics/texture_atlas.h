@@ -0,0 +1,112 @@
+#ifndef _GEF_TEXTURE_ATLAS_H
+#define _GEF_TEXTURE_ATLAS_H
+
+#include <gef.h>
+#include <graphics/image_data.h>
+#include <maths/vector2.h>
+#include <system/string_id.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+namespace gef
+{
+	class Platform;
+	class Texture;
+	class Sprite;
+
+	/**
+	Many images packed into one texture, so sprites that use any of them can be drawn in the same batch.
+	Images are added by name and packed with a SkylinePacker when the atlas is built.
+	A built atlas can be written to a file, offline or the first time it is built,
+	and read back at startup without packing again.
+	*/
+	class TextureAtlas
+	{
+	public:
+		/// @brief Where an image is in the atlas.
+		struct Region
+		{
+			/// Rectangle in pixels.
+			UInt32 x;
+			UInt32 y;
+			UInt32 width;
+			UInt32 height;
+			/// Rectangle in texture coordinates, in the same form as the Sprite uv values.
+			Vector2 uv_position;
+			float uv_width;
+			float uv_height;
+		};
+
+		static const UInt32 kDefaultMaxSize = 2048;
+
+		TextureAtlas();
+		~TextureAtlas();
+
+		/// @brief Adds an image to be packed by the next call to Build.
+		/// @param[in] name			Name used to find the region of the image. Names must be unique.
+		/// @param[in] image_data	RGBA image. Must stay valid until Build is called.
+		void AddImage(const char* name, const ImageData& image_data);
+
+		/// @brief Packs the added images into a new atlas image.
+		/// The atlas is the smallest power of two size the images fit in.
+		/// Regions and the texture of a previous build are released.
+		/// @param[in] max_size		The largest width and height of the atlas image, at most 16384.
+		/// @param[in] padding		Transparent pixels between images, stops filtering blending neighbours.
+		/// @return false if the images do not fit in max_size by max_size.
+		bool Build(UInt32 max_size = kDefaultMaxSize, UInt32 padding = 1);
+
+		/// @brief Creates the texture of the atlas image.
+		/// The atlas owns the texture. Sprites set up before this is called have no texture.
+		bool CreateTexture(const Platform& platform);
+
+		const Region* FindRegion(StringId name_id) const;
+		const Region* FindRegion(const char* name) const;
+
+		/// @brief Sets a sprite to draw the whole of an image in the atlas.
+		/// @return false if there is no image with the name.
+		bool SetSprite(StringId name_id, Sprite& sprite) const;
+
+		/// @brief Converts the uv rectangle of a sprite from the original image to the atlas.
+		/// For sprites that draw part of an image, e.g. one frame of a sprite sheet.
+		/// Call once per sprite, the uv values are changed in place.
+		/// @return false if there is no image with the name.
+		bool RemapSprite(StringId name_id, Sprite& sprite) const;
+
+		/// @brief Reads an atlas written by Write.
+		/// The stream must be able to seek, so the image size can be checked against the data left before it is allocated.
+		/// @return false if the file is not an atlas, is truncated, or has regions outside the image.
+		bool Read(std::istream& stream);
+		bool Write(std::ostream& stream) const;
+		bool ReadFromFile(const char* filename);
+		bool WriteToFile(const char* filename) const;
+
+		inline const ImageData& image_data() const { return image_data_; }
+		inline Texture* texture() const { return texture_; }
+		inline UInt32 width() const { return image_data_.width(); }
+		inline UInt32 height() const { return image_data_.height(); }
+		inline const std::map<StringId, Region>& regions() const { return regions_; }
+
+	private:
+		struct Source
+		{
+			StringId name_id;
+			const ImageData* image_data;
+		};
+
+		// releases the atlas image, regions and texture
+		void Release();
+		bool PackSources(UInt32 width, UInt32 height, UInt32 padding, std::vector<Region>& regions) const;
+		void CalculateUVs(Region& region) const;
+
+		std::vector<Source> sources_;
+		std::map<StringId, Region> regions_;
+		StringIdTable names_;
+		ImageData image_data_;
+		Texture* texture_;
+	};
+}
+
+#endif // _GEF_TEXTURE_ATLAS_H
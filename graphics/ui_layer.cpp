@@ -0,0 +1,447 @@
+#include <graphics/ui_layer.h>
+#include <graphics/sprite_renderer.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/glyph_atlas.h>
+#include <system/platform.h>
+#include <algorithm>
+
+namespace gef
+{
+	namespace
+	{
+		// strings are given room for a few more glyphs than they have, so changing numbers rarely move them
+		const UInt32 kTextQuadGranularity = 8;
+	}
+
+	UILayer::UILayer(Platform& platform, UInt32 max_quads) :
+		platform_(platform),
+		vertex_buffer_(NULL),
+		max_quads_(max_quads),
+		num_allocated_quads_(0),
+		num_written_quads_(0),
+		num_atlas_text_widgets_(0),
+		runs_dirty_(false)
+	{
+		// zeroed vertices are degenerate quads, nothing is drawn for unused quads
+		vertices_.resize(max_quads_ * SpriteBatch::kVerticesPerSprite, SpriteBatch::Vertex());
+		vertex_buffer_ = VertexBuffer::Create(platform_);
+		if (vertex_buffer_->Init(platform_, vertices_.data(), (UInt32)vertices_.size(), sizeof(SpriteBatch::Vertex), true))
+		{
+			platform_.AddVertexBuffer(vertex_buffer_);
+		}
+		else
+		{
+			delete vertex_buffer_;
+			vertex_buffer_ = NULL;
+			max_quads_ = 0;
+		}
+	}
+
+	UILayer::~UILayer()
+	{
+		if (vertex_buffer_)
+		{
+			platform_.RemoveVertexBuffer(vertex_buffer_);
+			delete vertex_buffer_;
+		}
+	}
+
+	UInt32 UILayer::AddWidget(WidgetType type)
+	{
+		UInt32 widget_id;
+		if (!free_widgets_.empty())
+		{
+			widget_id = free_widgets_.back();
+			free_widgets_.pop_back();
+		}
+		else
+		{
+			widget_id = (UInt32)widgets_.size();
+			widgets_.push_back(Widget());
+		}
+
+		Widget& widget = widgets_[widget_id];
+		widget.type = type;
+		widget.in_use = true;
+		widget.visible = true;
+		widget.dirty = false;
+		widget.first_quad = 0;
+		widget.num_quads = 0;
+		widget.capacity = 0;
+		widget.runs.clear();
+		widget.font = NULL;
+		widget.scale = 1.0f;
+		widget.colour = 0xffffffff;
+		widget.justification = TextJustification::TJ_LEFT;
+		widget.text.clear();
+		widget.atlas_glyphs.clear();
+
+		draw_order_.push_back(widget_id);
+		MarkDirty(widget_id);
+		return widget_id;
+	}
+
+	UInt32 UILayer::AddSprite(const Sprite& sprite)
+	{
+		const UInt32 widget_id = AddWidget(kSpriteWidget);
+		widgets_[widget_id].sprite = sprite;
+		return widget_id;
+	}
+
+	UInt32 UILayer::AddText(const Font& font, const Vector4& position, const float scale, const UInt32 colour, const TextJustification justification, const std::wstring& text)
+	{
+		const UInt32 widget_id = AddWidget(kTextWidget);
+		Widget& widget = widgets_[widget_id];
+		widget.font = &font;
+		widget.position = position;
+		widget.scale = scale;
+		widget.colour = colour;
+		widget.justification = justification;
+		widget.text = text;
+		if (font.glyph_atlas())
+			++num_atlas_text_widgets_;
+		return widget_id;
+	}
+
+	void UILayer::RemoveWidget(UInt32 widget_id)
+	{
+		Widget& widget = widgets_[widget_id];
+		if (!widget.in_use)
+			return;
+
+		if (widget.type == kTextWidget && widget.font->glyph_atlas())
+			--num_atlas_text_widgets_;
+
+		// the quads of the widget are left in the buffer until it is compacted, nothing draws them
+		widget.in_use = false;
+		widget.runs.clear();
+		draw_order_.erase(std::find(draw_order_.begin(), draw_order_.end(), widget_id));
+		free_widgets_.push_back(widget_id);
+		runs_dirty_ = true;
+	}
+
+	void UILayer::Clear()
+	{
+		widgets_.clear();
+		free_widgets_.clear();
+		draw_order_.clear();
+		dirty_widgets_.clear();
+		runs_.clear();
+		num_allocated_quads_ = 0;
+		num_atlas_text_widgets_ = 0;
+		dirty_ranges_.clear();
+		runs_dirty_ = false;
+	}
+
+	void UILayer::MarkDirty(UInt32 widget_id)
+	{
+		Widget& widget = widgets_[widget_id];
+		if (!widget.dirty)
+		{
+			widget.dirty = true;
+			dirty_widgets_.push_back(widget_id);
+		}
+	}
+
+	void UILayer::SetSprite(UInt32 widget_id, const Sprite& sprite)
+	{
+		widgets_[widget_id].sprite = sprite;
+		MarkDirty(widget_id);
+	}
+
+	void UILayer::SetText(UInt32 widget_id, const std::wstring& text)
+	{
+		Widget& widget = widgets_[widget_id];
+		if (widget.text == text)
+			return;
+
+		widget.text = text;
+		MarkDirty(widget_id);
+	}
+
+	void UILayer::SetPosition(UInt32 widget_id, const Vector4& position)
+	{
+		Widget& widget = widgets_[widget_id];
+		if (widget.type == kSpriteWidget)
+			widget.sprite.set_position(position);
+		else
+			widget.position = position;
+		MarkDirty(widget_id);
+	}
+
+	void UILayer::SetColour(UInt32 widget_id, const UInt32 colour)
+	{
+		Widget& widget = widgets_[widget_id];
+		if (widget.type == kSpriteWidget)
+			widget.sprite.set_colour(colour);
+		else
+			widget.colour = colour;
+		MarkDirty(widget_id);
+	}
+
+	void UILayer::SetVisible(UInt32 widget_id, bool visible)
+	{
+		Widget& widget = widgets_[widget_id];
+		if (widget.visible != visible)
+		{
+			widget.visible = visible;
+			runs_dirty_ = true;
+		}
+	}
+
+	bool UILayer::Allocate(Widget& widget, UInt32 num_quads)
+	{
+		if (num_quads <= widget.capacity)
+			return true;
+
+		// the old range is given up, the widget is written again in full
+		widget.capacity = 0;
+		widget.num_quads = 0;
+		if (num_allocated_quads_ + num_quads > max_quads_)
+			Compact();
+		if (num_allocated_quads_ + num_quads > max_quads_)
+			return false;
+
+		widget.first_quad = num_allocated_quads_;
+		widget.capacity = num_quads;
+		num_allocated_quads_ += num_quads;
+		return true;
+	}
+
+	void UILayer::Compact()
+	{
+		compact_vertices_.clear();
+		for (const UInt32 widget_id : draw_order_)
+		{
+			Widget& widget = widgets_[widget_id];
+			const SpriteBatch::Vertex* widget_vertices = &vertices_[widget.first_quad * SpriteBatch::kVerticesPerSprite];
+			widget.first_quad = (UInt32)compact_vertices_.size() / SpriteBatch::kVerticesPerSprite;
+			widget.capacity = widget.num_quads;
+			compact_vertices_.insert(compact_vertices_.end(), widget_vertices, widget_vertices + widget.num_quads * SpriteBatch::kVerticesPerSprite);
+		}
+
+		// everything up to the end of the old allocation is written, so nothing past the compacted widgets is drawn
+		const UInt32 old_num_allocated_quads = num_allocated_quads_;
+		num_allocated_quads_ = (UInt32)compact_vertices_.size() / SpriteBatch::kVerticesPerSprite;
+		std::copy(compact_vertices_.begin(), compact_vertices_.end(), vertices_.begin());
+		std::fill(vertices_.begin() + compact_vertices_.size(), vertices_.begin() + old_num_allocated_quads * SpriteBatch::kVerticesPerSprite, SpriteBatch::Vertex());
+		dirty_ranges_.clear();
+		MarkQuadsDirty(0, old_num_allocated_quads);
+		runs_dirty_ = true;
+	}
+
+	void UILayer::MarkQuadsDirty(UInt32 first_quad, UInt32 num_quads)
+	{
+		if (num_quads == 0)
+			return;
+
+		// widgets written one after another are usually next to each other in the buffer
+		if (!dirty_ranges_.empty() && dirty_ranges_.back().first_quad + dirty_ranges_.back().num_quads == first_quad)
+		{
+			dirty_ranges_.back().num_quads += num_quads;
+			return;
+		}
+		QuadRange range;
+		range.first_quad = first_quad;
+		range.num_quads = num_quads;
+		dirty_ranges_.push_back(range);
+	}
+
+	void UILayer::UploadQuads()
+	{
+		std::sort(dirty_ranges_.begin(), dirty_ranges_.end(), [](const QuadRange& a, const QuadRange& b)
+		{
+			return a.first_quad < b.first_quad;
+		});
+
+		// overlapping and touching ranges are copied together
+		size_t range_num = 0;
+		while (range_num < dirty_ranges_.size())
+		{
+			const UInt32 first_quad = dirty_ranges_[range_num].first_quad;
+			UInt32 end_quad = first_quad + dirty_ranges_[range_num].num_quads;
+			for (++range_num; range_num < dirty_ranges_.size() && dirty_ranges_[range_num].first_quad <= end_quad; ++range_num)
+				end_quad = std::max(end_quad, dirty_ranges_[range_num].first_quad + dirty_ranges_[range_num].num_quads);
+
+			const UInt32 first_vertex = first_quad * SpriteBatch::kVerticesPerSprite;
+			vertex_buffer_->UpdateRange(platform_, &vertices_[first_vertex], first_vertex, (end_quad - first_quad) * SpriteBatch::kVerticesPerSprite);
+		}
+		dirty_ranges_.clear();
+	}
+
+	void UILayer::WriteSprite(Widget& widget)
+	{
+		if (!Allocate(widget, 1))
+			return;
+
+		SpriteBatch::BuildQuad(widget.sprite, &vertices_[widget.first_quad * SpriteBatch::kVerticesPerSprite]);
+		widget.num_quads = 1;
+
+		SpriteBatch::Run run;
+		run.texture = widget.sprite.texture();
+		run.first_sprite = 0;
+		run.num_sprites = 1;
+		widget.runs.push_back(run);
+	}
+
+	void UILayer::WriteText(UInt32 widget_id, Widget& widget)
+	{
+		const Font::TextLayout& layout = widget.font->LayoutText(widget.text, widget.scale, widget.justification);
+		widget.atlas_glyphs = layout.atlas_glyphs;
+		// glyphs left out of a full glyph atlas are tried again next frame
+		if (!layout.complete)
+			MarkDirty(widget_id);
+
+		widget.num_quads = 0;
+		const UInt32 num_quads = (UInt32)layout.quads.size();
+		const UInt32 capacity = (num_quads + kTextQuadGranularity - 1) / kTextQuadGranularity * kTextQuadGranularity;
+		if (num_quads == 0 || !Allocate(widget, capacity))
+			return;
+
+		Sprite sprite;
+		sprite.set_colour(widget.colour);
+		SpriteBatch::Vertex* quad_vertices = &vertices_[widget.first_quad * SpriteBatch::kVerticesPerSprite];
+		for (UInt32 quad_num = 0; quad_num < num_quads; ++quad_num)
+		{
+			const Font::GlyphQuad& quad = layout.quads[quad_num];
+			sprite.set_position(widget.position.x() + quad.x, widget.position.y() + quad.y, widget.position.z());
+			sprite.set_width(quad.width);
+			sprite.set_height(quad.height);
+			sprite.set_uv_position(quad.uv_position);
+			sprite.set_uv_width(quad.uv_width);
+			sprite.set_uv_height(quad.uv_height);
+			SpriteBatch::BuildQuad(sprite, quad_vertices + quad_num * SpriteBatch::kVerticesPerSprite);
+
+			if (widget.runs.empty() || widget.runs.back().texture != quad.texture)
+			{
+				SpriteBatch::Run run;
+				run.texture = quad.texture;
+				run.first_sprite = quad_num;
+				run.num_sprites = 0;
+				widget.runs.push_back(run);
+			}
+			++widget.runs.back().num_sprites;
+		}
+		widget.num_quads = num_quads;
+
+		// glyphs of a longer string the widget had before are cleared
+		std::fill(quad_vertices + num_quads * SpriteBatch::kVerticesPerSprite, quad_vertices + widget.capacity * SpriteBatch::kVerticesPerSprite, SpriteBatch::Vertex());
+	}
+
+	void UILayer::WriteWidget(UInt32 widget_id)
+	{
+		Widget& widget = widgets_[widget_id];
+		const UInt32 old_first_quad = widget.first_quad;
+		old_runs_.swap(widget.runs);
+		widget.runs.clear();
+
+		if (widget.type == kSpriteWidget)
+			WriteSprite(widget);
+		else
+			WriteText(widget_id, widget);
+
+		MarkQuadsDirty(widget.first_quad, widget.capacity);
+		num_written_quads_ += widget.num_quads;
+
+		// moving or changing the texture runs of the widget changes the runs of the layer
+		if (widget.first_quad != old_first_quad || widget.runs.size() != old_runs_.size())
+		{
+			runs_dirty_ = true;
+		}
+		else
+		{
+			for (size_t run_num = 0; run_num < old_runs_.size(); ++run_num)
+			{
+				const SpriteBatch::Run& run = widget.runs[run_num];
+				const SpriteBatch::Run& old_run = old_runs_[run_num];
+				if (run.texture != old_run.texture || run.first_sprite != old_run.first_sprite || run.num_sprites != old_run.num_sprites)
+				{
+					runs_dirty_ = true;
+					break;
+				}
+			}
+		}
+	}
+
+	void UILayer::CheckGlyphAtlases()
+	{
+		for (const UInt32 widget_id : draw_order_)
+		{
+			Widget& widget = widgets_[widget_id];
+			if (widget.type != kTextWidget || !widget.visible || widget.dirty || widget.font->glyph_atlas() == NULL)
+				continue;
+
+			// laying out a cached string marks its glyphs as drawn, so they stay in the atlas
+			// only widgets with a glyph that was replaced get a new layout, and only they are written again
+			const Font::TextLayout& layout = widget.font->LayoutText(widget.text, widget.scale, widget.justification);
+			if (layout.atlas_glyphs != widget.atlas_glyphs)
+				MarkDirty(widget_id);
+		}
+	}
+
+	void UILayer::BuildRuns()
+	{
+		runs_.clear();
+		// the last run can be extended by a run that starts here, past any degenerate quads at the end of the last widget
+		UInt32 run_end_quad = 0;
+		for (const UInt32 widget_id : draw_order_)
+		{
+			const Widget& widget = widgets_[widget_id];
+			if (!widget.visible)
+				continue;
+
+			// widgets next to each other in the buffer with the same texture are drawn together
+			for (const SpriteBatch::Run& widget_run : widget.runs)
+			{
+				const UInt32 first_quad = widget.first_quad + widget_run.first_sprite;
+				if (!runs_.empty() && runs_.back().texture == widget_run.texture && run_end_quad == first_quad)
+				{
+					runs_.back().num_sprites = first_quad + widget_run.num_sprites - runs_.back().first_sprite;
+				}
+				else
+				{
+					SpriteBatch::Run run = widget_run;
+					run.first_sprite = first_quad;
+					runs_.push_back(run);
+				}
+				run_end_quad = first_quad + widget_run.num_sprites;
+			}
+			if (!widget.runs.empty())
+				run_end_quad = widget.first_quad + widget.capacity;
+		}
+		runs_dirty_ = false;
+	}
+
+	void UILayer::Draw(SpriteRenderer& sprite_renderer)
+	{
+		if (vertex_buffer_ == NULL)
+			return;
+
+		num_written_quads_ = 0;
+		if (num_atlas_text_widgets_ > 0)
+			CheckGlyphAtlases();
+
+		if (!dirty_widgets_.empty())
+		{
+			// strings that could not be finished mark themselves dirty again while being written
+			writing_widgets_.swap(dirty_widgets_);
+			for (const UInt32 widget_id : writing_widgets_)
+			{
+				Widget& widget = widgets_[widget_id];
+				if (!widget.in_use || !widget.dirty)
+					continue;
+				widget.dirty = false;
+				WriteWidget(widget_id);
+			}
+			writing_widgets_.clear();
+		}
+
+		if (!dirty_ranges_.empty())
+			UploadQuads();
+
+		if (runs_dirty_)
+			BuildRuns();
+
+		sprite_renderer.DrawQuads(*vertex_buffer_, vertices_.data(), runs_.data(), (UInt32)runs_.size());
+	}
+}
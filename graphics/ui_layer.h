@@ -0,0 +1,164 @@
+#ifndef _GEF_UI_LAYER_H
+#define _GEF_UI_LAYER_H
+
+#include <gef.h>
+#include <graphics/font.h>
+#include <graphics/sprite.h>
+#include <graphics/sprite_batch.h>
+#include <maths/vector4.h>
+#include <vector>
+#include <string>
+
+namespace gef
+{
+	class Platform;
+	class SpriteRenderer;
+	class VertexBuffer;
+
+	/**
+	Retained 2D layer for HUDs and menus, drawn on top of whatever the sprite renderer drew before it.
+	Sprites and strings are added once as widgets. Each widget owns a range of quads in a vertex buffer
+	shared by the whole layer, and only widgets that have changed since the last Draw write their quads again.
+	The layer is drawn with one draw call per run of quads that share a texture, so a layer that uses one
+	texture atlas and one font page is two draw calls.
+	A layer that has not changed costs no more on the CPU than those draw calls.
+	Widgets are drawn in the order they were added.
+	*/
+	class UILayer
+	{
+	public:
+		static const UInt32 kDefaultMaxQuads = 4096;
+
+		/// @param[in] max_quads	The number of quads in the vertex buffer. Sprites are one quad, strings one per glyph with pixels.
+		UILayer(Platform& platform, UInt32 max_quads = kDefaultMaxQuads);
+		~UILayer();
+		// the vertex buffer is owned
+		UILayer(const UILayer&) = delete;
+		UILayer& operator=(const UILayer&) = delete;
+
+		/// @brief Adds a sprite widget. The texture of the sprite must outlive the widget.
+		/// @return The id of the widget.
+		UInt32 AddSprite(const Sprite& sprite);
+
+		/// @brief Adds a string widget, with the same arguments as Font::RenderText.
+		/// The font must outlive the widget. Fonts drawn through a GlyphAtlas are supported,
+		/// their strings are laid out again when glyphs move in the atlas. Set the atlas on the font before adding strings.
+		/// @return The id of the widget.
+		UInt32 AddText(const Font& font, const Vector4& position, const float scale, const UInt32 colour, const TextJustification justification, const std::wstring& text);
+
+		/// @brief Removes a widget. Its id may be returned by later calls to AddSprite and AddText.
+		void RemoveWidget(UInt32 widget_id);
+
+		/// @brief Removes all widgets.
+		void Clear();
+
+		/// @brief Changes the sprite of a sprite widget.
+		void SetSprite(UInt32 widget_id, const Sprite& sprite);
+		/// @brief Changes the string of a string widget. Setting the string it already has does nothing,
+		/// so it can be called every frame.
+		void SetText(UInt32 widget_id, const std::wstring& text);
+		void SetPosition(UInt32 widget_id, const Vector4& position);
+		void SetColour(UInt32 widget_id, const UInt32 colour);
+		/// @brief Shows or hides a widget. Hidden widgets keep their quads, so showing them again writes nothing.
+		void SetVisible(UInt32 widget_id, bool visible);
+
+		/// @brief Writes the quads of the changed widgets, then draws the layer.
+		/// Call between Begin and End of the sprite renderer.
+		/// Drawn with the sprite batch shader, which the application deploys, see SpriteRenderer::DrawQuads.
+		void Draw(SpriteRenderer& sprite_renderer);
+
+		inline UInt32 num_widgets() const { return (UInt32)draw_order_.size(); }
+		/// @return The number of quads allocated to widgets, including space freed by removed or grown widgets.
+		inline UInt32 num_quads() const { return num_allocated_quads_; }
+		inline UInt32 max_quads() const { return max_quads_; }
+		/// @return The number of draw calls the last Draw made.
+		inline UInt32 num_runs() const { return (UInt32)runs_.size(); }
+		/// @return The number of quads the last Draw wrote.
+		inline UInt32 num_written_quads() const { return num_written_quads_; }
+
+	private:
+		enum WidgetType
+		{
+			kSpriteWidget,
+			kTextWidget
+		};
+
+		// a range of quads in the vertex buffer
+		struct QuadRange
+		{
+			UInt32 first_quad;
+			UInt32 num_quads;
+		};
+
+		struct Widget
+		{
+			WidgetType type;
+			bool in_use;
+			bool visible;
+			bool dirty;
+
+			// range of the widget in the vertex buffer, in quads
+			// quads past num_quads up to capacity are degenerate, so runs can be drawn through them
+			UInt32 first_quad;
+			UInt32 num_quads;
+			UInt32 capacity;
+			// texture runs of the quads, relative to first_quad
+			std::vector<SpriteBatch::Run> runs;
+
+			Sprite sprite;
+
+			const Font* font;
+			Vector4 position;
+			float scale;
+			UInt32 colour;
+			TextJustification justification;
+			std::wstring text;
+			// glyph atlas handles of the glyphs the quads were written with
+			std::vector<UInt64> atlas_glyphs;
+		};
+
+		UInt32 AddWidget(WidgetType type);
+		void MarkDirty(UInt32 widget_id);
+		// writes the quads and runs of a widget
+		void WriteWidget(UInt32 widget_id);
+		void WriteSprite(Widget& widget);
+		void WriteText(UInt32 widget_id, Widget& widget);
+		// makes room for a number of quads in the range of a widget, moving it to the end of the buffer if it has grown
+		bool Allocate(Widget& widget, UInt32 num_quads);
+		// moves every widget to the start of the buffer in draw order, removing the space of removed and grown widgets
+		void Compact();
+		void MarkQuadsDirty(UInt32 first_quad, UInt32 num_quads);
+		// copies the changed ranges of quads to the vertex buffer
+		void UploadQuads();
+		// marks the string widgets of fonts with a glyph atlas as changed if their glyphs have moved
+		void CheckGlyphAtlases();
+		void BuildRuns();
+
+		Platform& platform_;
+		VertexBuffer* vertex_buffer_;
+		// copy of the vertex buffer, the buffer is read only so only changed ranges are copied to the device
+		std::vector<SpriteBatch::Vertex> vertices_;
+		UInt32 max_quads_;
+		UInt32 num_allocated_quads_;
+		UInt32 num_written_quads_;
+
+		std::vector<Widget> widgets_;
+		std::vector<UInt32> free_widgets_;
+		std::vector<UInt32> draw_order_;
+		std::vector<UInt32> dirty_widgets_;
+		// kept so Draw does not allocate
+		std::vector<UInt32> writing_widgets_;
+		std::vector<SpriteBatch::Vertex> compact_vertices_;
+		std::vector<SpriteBatch::Run> old_runs_;
+		UInt32 num_atlas_text_widgets_;
+
+		// quads written since the vertex buffer was last updated
+		std::vector<QuadRange> dirty_ranges_;
+
+		// runs of the whole layer, built again when a widget is added, removed, hidden or its runs change
+		std::vector<SpriteBatch::Run> runs_;
+		bool runs_dirty_;
+	};
+}
+
+#endif // _GEF_UI_LAYER_H
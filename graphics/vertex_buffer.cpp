@@ -1,5 +1,6 @@
 #include <graphics/vertex_buffer.h>
 #include <stdlib.h>
+#include <string.h>
 
 namespace gef
 {
@@ -14,4 +15,13 @@ namespace gef
 	{
 		free(vertex_data_);
 	}
+
+	bool VertexBuffer::UpdateRange(const Platform& platform, const void* vertices, UInt32 first_vertex, UInt32 num_vertices)
+	{
+		if (!vertex_data_ || first_vertex + num_vertices > num_vertices_)
+			return false;
+
+		memcpy(static_cast<UInt8*>(vertex_data_) + first_vertex * vertex_byte_size_, vertices, num_vertices * vertex_byte_size_);
+		return Update(platform);
+	}
 }
\ No newline at end of file
@@ -13,6 +13,11 @@ namespace gef
 		virtual ~VertexBuffer();
 		virtual bool Init(const Platform& platform, const void* vertices, const UInt32 num_vertices, const UInt32 vertex_byte_size, const bool read_only = true) = 0;
 		virtual bool Update(const Platform& platform) = 0;
+		/// @brief Copies vertices to a range of the buffer.
+		/// Read only buffers are updated on the device without a CPU copy, so only the range is copied.
+		/// Buffers created with read_only false copy the vertices to vertex_data, then update all of it.
+		/// @param[in] vertices		The first vertex of the range.
+		virtual bool UpdateRange(const Platform& platform, const void* vertices, UInt32 first_vertex, UInt32 num_vertices);
 
 		virtual void Bind(const Platform& platform) const = 0;
 		virtual void Unbind(const Platform& platform) const = 0;
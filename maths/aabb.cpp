@@ -34,10 +34,11 @@ namespace gef
 
 	const Aabb Aabb::Transform(const Matrix44& transform_matrix) const
 	{
-		// This can be optimised
+		Vector4 corners[kNumCorners];
+		GetCorners(corners);
+
 		Aabb result;
-		for(gef::Vector4& vertex : GetCorners()) {
-			vertex.set_w(1);
+		for(gef::Vector4& vertex : corners) {
 			gef::Vector4 tformed = vertex.TransformW(transform_matrix);
 			float factor = 1.f/tformed.w();
 			tformed *= factor;
@@ -49,14 +50,18 @@ namespace gef
 	}
 
 	std::vector<gef::Vector4> Aabb::GetCorners() const {
-		std::vector<gef::Vector4> vertices(8);
-		for(int i = 0; i < 8; i++){
-			vertices[i].set_x((i & 0b001) ? min_vtx_.x() : max_vtx_.x());
-			vertices[i].set_y((i & 0b010) ? min_vtx_.y() : max_vtx_.y());
-			vertices[i].set_z((i & 0b100) ? min_vtx_.z() : max_vtx_.z());
-			vertices[i].set_w(1);
-		}
+		std::vector<gef::Vector4> vertices(kNumCorners);
+		GetCorners(vertices.data());
 		return vertices;
 	}
 
+	void Aabb::GetCorners(Vector4* corners) const {
+		for(int i = 0; i < kNumCorners; i++){
+			corners[i].set_x((i & 0b001) ? min_vtx_.x() : max_vtx_.x());
+			corners[i].set_y((i & 0b010) ? min_vtx_.y() : max_vtx_.y());
+			corners[i].set_z((i & 0b100) ? min_vtx_.z() : max_vtx_.z());
+			corners[i].set_w(1);
+		}
+	}
+
 }
\ No newline at end of file
@@ -34,6 +34,12 @@ namespace gef
 
 		std::vector<gef::Vector4> GetCorners() const;
 
+		/// @brief Get the eight corners of the AABB without allocating memory.
+		/// @param[out] corners		Array of at least kNumCorners vectors that receives the corner positions.
+		void GetCorners(Vector4* corners) const;
+
+		static const int kNumCorners = 8;
+
 		/// @brief Sets the minimum bounds of the AABB.
 		/// @param[in] min_vtx		The minimum bounds.
 		inline void set_min_vtx(const Vector4& min_vtx) { min_vtx_ = min_vtx; }
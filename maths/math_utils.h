@@ -22,6 +22,48 @@ namespace gef
 		return start*(1.0f - time) + time*end;
 	}
 
+	/// @brief Square root that can be evaluated at compile time.
+	/// @param[in] value	The value. Must not be negative.
+	/// @return The square root. Slower than sqrtf, intended for constant expressions.
+	inline constexpr float ConstexprSqrt(float value)
+	{
+		if (value <= 0.0f)
+			return 0.0f;
+
+		// newton-raphson in double precision, starting above the root so the iteration decreases monotonically
+		double x = value;
+		double root = value > 1.0f ? x : 1.0;
+		for (int iteration = 0; iteration < 256; ++iteration)
+		{
+			const double next = 0.5 * (root + x / root);
+			if (next >= root)
+				break;
+			root = next;
+		}
+		return (float)root;
+	}
+
+	/// @brief Tangent that can be evaluated at compile time.
+	/// @param[in] angle	The angle in radians, in the range (-pi/2, pi/2).
+	/// @return The tangent. Slower than tanf, intended for constant expressions.
+	inline constexpr float ConstexprTan(float angle)
+	{
+		// taylor series for sin and cos in double precision, converges for the whole input range
+		const double x = angle;
+		double sin_sum = 0.0, cos_sum = 0.0;
+		double term = 1.0;
+		for (int n = 0; n < 40; ++n)
+		{
+			// term = x^n / n!
+			if (n % 4 == 0) cos_sum += term;
+			else if (n % 4 == 1) sin_sum += term;
+			else if (n % 4 == 2) cos_sum -= term;
+			else sin_sum -= term;
+			term *= x / (double)(n + 1);
+		}
+		return (float)(sin_sum / cos_sum);
+	}
+
 	inline float ShortestAngleDiff(float a, float b)
 	{
 		float diff = a - b;
@@ -3,10 +3,21 @@
 #include <maths/vector4.h>
 #include <maths/quaternion.h>
 #include <math.h>
+#include <type_traits>
 
 
 namespace gef
 {
+	static_assert(std::is_trivially_copyable<Matrix44>::value && std::is_trivially_default_constructible<Matrix44>::value, "Matrix44 must be a trivial type");
+	static_assert(sizeof(Matrix44) == 16 * sizeof(float), "Matrix44 must be tightly packed");
+
+	// the constexpr builders must fold to constants
+	static_assert(Matrix44::MakeIdentity().m(0, 0) == 1.0f && Matrix44::MakeIdentity().m(3, 0) == 0.0f, "MakeIdentity must be a compile time constant");
+	static_assert(Matrix44::MakePerspectiveFovD3D(FRAMEWORK_PI*0.5f, 1.0f, 1.0f, 2.0f).m(2, 3) == -1.0f, "MakePerspectiveFovD3D must be a compile time constant");
+	static_assert(Matrix44::MakePerspectiveFovD3D(FRAMEWORK_PI*0.5f, 1.0f, 1.0f, 2.0f).m(0, 0) > 0.9999f && Matrix44::MakePerspectiveFovD3D(FRAMEWORK_PI*0.5f, 1.0f, 1.0f, 2.0f).m(0, 0) < 1.0001f, "MakePerspectiveFovD3D with a 90 degree field of view must have a unit x scale");
+	static_assert(Matrix44::MakeLookAt(Vector4(0.0f, 0.0f, 5.0f), Vector4(0.0f, 0.0f, 0.0f), Vector4(0.0f, 1.0f, 0.0f)).m(3, 2) == -5.0f, "MakeLookAt must be a compile time constant");
+	static_assert(Matrix44::MakeOrthographicFrustumD3D(-1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 1.0f).m(2, 2) == 1.0f, "MakeOrthographicFrustumD3D must be a compile time constant");
+
 
 	Matrix44::Matrix44(const float *m)
 	{
@@ -17,22 +28,6 @@ namespace gef
 
 	}
 
-	void Matrix44::SetIdentity()
-	{
-		values_[0] = Vector4(1.0f, 0.0f, 0.0f, 0.0f);
-		values_[1] = Vector4(0.0f, 1.0f, 0.0f, 0.0f);
-		values_[2] = Vector4(0.0f, 0.0f, 1.0f, 0.0f);
-		values_[3] = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
-	}
-
-	void Matrix44::SetZero()
-	{
-		values_[0] = Vector4::kZero;
-		values_[1] = Vector4::kZero;
-		values_[2] = Vector4::kZero;
-		values_[3] = Vector4::kZero;
-	}
-
 	const Matrix44 Matrix44::operator*(const Matrix44& matrix) const
 	{
 		Matrix44 result;
@@ -351,6 +346,49 @@ namespace gef
 		return values_[0].x() * v[0] + values_[0].y() * v[1] + values_[0].z() * v[2] + values_[0].w() * v[3];
 	}
 
+	void Matrix44::InverseTranspose(const Matrix44& matrix)
+	{
+		// a projection needs the general inverse
+		if (matrix.m(0, 3) != 0.0f || matrix.m(1, 3) != 0.0f || matrix.m(2, 3) != 0.0f || matrix.m(3, 3) != 1.0f)
+		{
+			Matrix44 inverse;
+			float det;
+			inverse.Inverse(matrix, &det);
+			if (det != 0.0f)
+				Transpose(inverse);
+			return;
+		}
+
+		// the columns of the inverse of the 3x3 part are the cross products of its rows over the determinant,
+		// so they are the rows of the inverse transpose. For a rotation they are the rotation rows themselves
+		const Vector4 row0 = matrix.GetRow(0);
+		const Vector4 row1 = matrix.GetRow(1);
+		const Vector4 row2 = matrix.GetRow(2);
+		Vector4 column0 = row1.CrossProduct(row2);
+		Vector4 column1 = row2.CrossProduct(row0);
+		Vector4 column2 = row0.CrossProduct(row1);
+
+		const float det = row0.DotProduct(column0);
+		if (det == 0.0f)
+			return;
+
+		const float inv_det = 1.0f / det;
+		column0 *= inv_det;
+		column1 *= inv_det;
+		column2 *= inv_det;
+
+		// the translation of the inverse is -translation * inverse(3x3), which the transpose moves to the last column
+		const Vector4 translation = matrix.GetTranslation();
+		column0.set_w(-translation.DotProduct(column0));
+		column1.set_w(-translation.DotProduct(column1));
+		column2.set_w(-translation.DotProduct(column2));
+
+		values_[0] = column0;
+		values_[1] = column1;
+		values_[2] = column2;
+		values_[3] = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
 	void Matrix44::Inverse(const Matrix44 matrix, float* determinant)
 	{
 		int a, i, j;
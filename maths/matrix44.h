@@ -16,9 +16,37 @@ namespace gef
 	class Matrix44
 	{
 	public:
-		Matrix44() {};
+		Matrix44() = default;
 		Matrix44(const float *m);
 
+		/// @brief Construct a matrix from its rows.
+		constexpr Matrix44(const Vector4& row0, const Vector4& row1, const Vector4& row2, const Vector4& row3);
+
+		/// @brief Create an identity matrix.
+		/// @return The identity matrix.
+		static constexpr Matrix44 MakeIdentity();
+
+		/// @brief Create a view matrix. Same as LookAt, but can be evaluated at compile time.
+		static constexpr Matrix44 MakeLookAt(const Vector4& eye, const Vector4& lookat, const Vector4& up);
+
+		/// @brief Create an OpenGL style perspective projection matrix. Same as PerspectiveFrustumGL, but can be evaluated at compile time.
+		static constexpr Matrix44 MakePerspectiveFrustumGL(const float left, const float right, const float top, const float bottom, const float near_dist, const float far_dist);
+
+		/// @brief Create an OpenGL style perspective projection matrix. Same as PerspectiveFovGL, but can be evaluated at compile time.
+		static constexpr Matrix44 MakePerspectiveFovGL(const float fov, const float aspect_ratio, const float near_dist, const float far_dist);
+
+		/// @brief Create an OpenGL style orthographic projection matrix. Same as OrthographicFrustumGL, but can be evaluated at compile time.
+		static constexpr Matrix44 MakeOrthographicFrustumGL(const float left, const float right, const float top, const float bottom, const float near_dist, const float far_dist);
+
+		/// @brief Create a Direct3D style perspective projection matrix. Same as PerspectiveFrustumD3D, but can be evaluated at compile time.
+		static constexpr Matrix44 MakePerspectiveFrustumD3D(const float left, const float right, const float top, const float bottom, const float near_dist, const float far_dist);
+
+		/// @brief Create a Direct3D style perspective projection matrix. Same as PerspectiveFovD3D, but can be evaluated at compile time.
+		static constexpr Matrix44 MakePerspectiveFovD3D(const float fov, const float aspect_ratio, const float near_dist, const float far_dist);
+
+		/// @brief Create a Direct3D style orthographic projection matrix. Same as OrthographicFrustumD3D, but can be evaluated at compile time.
+		static constexpr Matrix44 MakeOrthographicFrustumD3D(const float left, const float right, const float top, const float bottom, const float near_dist, const float far_dist);
+
 		/// @brief Set this matrix to the identity matrix
 		void SetIdentity();
 
@@ -149,6 +177,12 @@ namespace gef
 		/// @param[out] determinant		the determinant calculated to carry out the inverse operation. This can be set to NULL if it's not required.
 		void Inverse(const Matrix44 matrix, float* determinant = NULL);
 
+		/// @brief Set this matrix to the transpose of the inverse of the matrix provided.
+		/// @param[in] matrix	The matrix to be inverted and transposed.
+		/// @note Affine matrices, with a last column of (0, 0, 0, 1), only invert their 3x3 part, others use the general Inverse.
+		/// This matrix is left unchanged if the matrix provided can't be inverted.
+		void InverseTranspose(const Matrix44& matrix);
+
 
 		/// @brief Calculate the product of two matrices.
 		/// @param[in] matrix	The matrix for the second operand of the operation.
@@ -158,7 +192,7 @@ namespace gef
 		/// @brief Get a particular row from this matrix.
 		/// @param[in] row		The row number.
 		/// @return The contents of selected row.
-		inline const Vector4& GetRow(int row) const
+		inline constexpr const Vector4& GetRow(int row) const
 		{
 			return values_[row];
 		}
@@ -193,9 +227,9 @@ namespace gef
 		/// @brief Get the value of a particular element from this matrix.
 		/// @param[in] row		The row number.
 		/// @param[in] column	The column number.
-		inline float m(int row, int column) const
+		inline constexpr float m(int row, int column) const
 		{
-			return *(((float*)&values_[row]) + column);
+			return values_[row][column];
 		}
 
 		/// @brief Set a particular element in this matrix to a the value provided.
@@ -215,4 +249,6 @@ namespace gef
 	};
 }
 
+#include "maths/matrix44.inl"
+
 #endif // _GEF_MATRIX_44_H
@@ -0,0 +1,116 @@
+#include <maths/math_utils.h>
+
+namespace gef
+{
+	inline constexpr Matrix44::Matrix44(const Vector4& row0, const Vector4& row1, const Vector4& row2, const Vector4& row3) :
+		values_{ row0, row1, row2, row3 }
+	{
+	}
+
+	inline constexpr Matrix44 Matrix44::MakeIdentity()
+	{
+		return Matrix44(
+			Vector4(1.0f, 0.0f, 0.0f, 0.0f),
+			Vector4(0.0f, 1.0f, 0.0f, 0.0f),
+			Vector4(0.0f, 0.0f, 1.0f, 0.0f),
+			Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	inline void Matrix44::SetIdentity()
+	{
+		*this = MakeIdentity();
+	}
+
+	inline void Matrix44::SetZero()
+	{
+		*this = Matrix44(Vector4::MakeZero(), Vector4::MakeZero(), Vector4::MakeZero(), Vector4::MakeZero());
+	}
+
+	inline constexpr Matrix44 Matrix44::MakeLookAt(const Vector4& eye, const Vector4& lookat, const Vector4& up)
+	{
+		// forward = normalise(eye - lookat)
+		float forward_x = eye.x() - lookat.x();
+		float forward_y = eye.y() - lookat.y();
+		float forward_z = eye.z() - lookat.z();
+		const float forward_length = ConstexprSqrt(forward_x*forward_x + forward_y*forward_y + forward_z*forward_z);
+		forward_x /= forward_length;
+		forward_y /= forward_length;
+		forward_z /= forward_length;
+
+		// side = normalise(up x forward)
+		float side_x = up.y()*forward_z - up.z()*forward_y;
+		float side_y = up.z()*forward_x - up.x()*forward_z;
+		float side_z = up.x()*forward_y - up.y()*forward_x;
+		const float side_length = ConstexprSqrt(side_x*side_x + side_y*side_y + side_z*side_z);
+		side_x /= side_length;
+		side_y /= side_length;
+		side_z /= side_length;
+
+		// calculated_up = forward x side
+		const float up_x = forward_y*side_z - forward_z*side_y;
+		const float up_y = forward_z*side_x - forward_x*side_z;
+		const float up_z = forward_x*side_y - forward_y*side_x;
+
+		return Matrix44(
+			Vector4(side_x, up_x, forward_x, 0.0f),
+			Vector4(side_y, up_y, forward_y, 0.0f),
+			Vector4(side_z, up_z, forward_z, 0.0f),
+			Vector4(
+				-(side_x*eye.x() + side_y*eye.y() + side_z*eye.z()),
+				-(up_x*eye.x() + up_y*eye.y() + up_z*eye.z()),
+				-(forward_x*eye.x() + forward_y*eye.y() + forward_z*eye.z()),
+				1.0f));
+	}
+
+	inline constexpr Matrix44 Matrix44::MakePerspectiveFrustumGL(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance)
+	{
+		return Matrix44(
+			Vector4((2.0f*near_distance) / (right - left), 0.0f, 0.0f, 0.0f),
+			Vector4(0.0f, (2.0f*near_distance) / (top - bottom), 0.0f, 0.0f),
+			Vector4((right + left) / (right - left), (top + bottom) / (top - bottom), -(far_distance+near_distance) / (far_distance - near_distance), -1.0f),
+			Vector4(0.0f, 0.0f, -(2.0f*far_distance*near_distance) / (far_distance - near_distance), 0.0f));
+	}
+
+	inline constexpr Matrix44 Matrix44::MakePerspectiveFovGL(const float fov, const float aspect_ratio, const float near_distance, const float far_distance)
+	{
+		return MakePerspectiveFrustumGL(
+			-ConstexprTan(fov*0.5f)*near_distance*aspect_ratio, ConstexprTan(fov*0.5f)*near_distance*aspect_ratio,
+			ConstexprTan(fov*0.5f)*near_distance, -ConstexprTan(fov*0.5f)*near_distance,
+			near_distance, far_distance);
+	}
+
+	inline constexpr Matrix44 Matrix44::MakeOrthographicFrustumGL(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance)
+	{
+		return Matrix44(
+			Vector4((2.0f) / (right - left), 0.0f, 0.0f, 0.0f),
+			Vector4(0.0f, (2.0f) / (top - bottom), 0.0f, 0.0f),
+			Vector4(0.0f, 0.0f, (2.0f) / (far_distance - near_distance), 0.0f),
+			Vector4(-(right+left) / (right - left), -(top+bottom) / (top - bottom), -(far_distance+near_distance) / (far_distance - near_distance), 1.0f));
+	}
+
+	inline constexpr Matrix44 Matrix44::MakePerspectiveFrustumD3D(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance)
+	{
+		return Matrix44(
+			Vector4((2.0f*near_distance) / (right - left), 0.0f, 0.0f, 0.0f),
+			Vector4(0.0f, (2.0f*near_distance) / (top - bottom), 0.0f, 0.0f),
+			Vector4((right + left) / (right - left), (top + bottom) / (top - bottom), (far_distance) / (near_distance - far_distance), -1.0f),
+			Vector4(0.0f, 0.0f, (far_distance*near_distance) / (near_distance - far_distance), 0.0f));
+	}
+
+	inline constexpr Matrix44 Matrix44::MakePerspectiveFovD3D(const float fov, const float aspect_ratio, const float near_distance, const float far_distance)
+	{
+		return MakePerspectiveFrustumD3D(
+			-ConstexprTan(fov*0.5f)*near_distance*aspect_ratio, ConstexprTan(fov*0.5f)*near_distance*aspect_ratio,
+			ConstexprTan(fov*0.5f)*near_distance, -ConstexprTan(fov*0.5f)*near_distance,
+			near_distance, far_distance);
+	}
+
+	inline constexpr Matrix44 Matrix44::MakeOrthographicFrustumD3D(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance)
+	{
+		return Matrix44(
+			Vector4((2.0f) / (right - left), 0.0f, 0.0f, 0.0f),
+			Vector4(0.0f, (2.0f) / (top - bottom), 0.0f, 0.0f),
+			Vector4(0.0f, 0.0f, (1.0f) / (far_distance - near_distance), 0.0f),
+			Vector4((right + left) / (left - right), (top + bottom) / (bottom - top), (near_distance) / (near_distance - far_distance), 1.0f));
+	}
+}
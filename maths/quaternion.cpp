@@ -1,10 +1,14 @@
 #include <maths/quaternion.h>
 #include <maths/matrix44.h>
+#include <type_traits>
 
 
 namespace gef
 {
-	const Quaternion Quaternion::kIdentity(0.0f, 0.0f, 0.0f, 1.0f);
+	constexpr Quaternion Quaternion::kIdentity = Quaternion::MakeIdentity();
+
+	static_assert(std::is_trivially_copyable<Quaternion>::value && std::is_trivially_default_constructible<Quaternion>::value, "Quaternion must be a trivial type");
+	static_assert(Quaternion::kIdentity.w == 1.0f, "Quaternion constants must be compile time constants");
 
 	Quaternion::Quaternion(const Matrix44& matrix)
 	{
@@ -13,10 +17,7 @@ namespace gef
 
 void Quaternion::Identity()
 {
-	x = 0.0f;
-	y = 0.0f;
-	z = 0.0f;
-	w = 1.0f;
+	*this = MakeIdentity();
 }
 
 
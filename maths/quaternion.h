@@ -11,8 +11,13 @@ namespace gef
 class Quaternion
 {
 public:
-	Quaternion();
-	Quaternion(float x, float y, float z, float w);
+	Quaternion() = default;
+	constexpr Quaternion(float x, float y, float z, float w);
+
+	/// @brief Create the identity rotation. Unlike kIdentity, folds to a constant wherever it is used.
+	/// @return The identity quaternion.
+	static constexpr Quaternion MakeIdentity();
+
 	Quaternion(const Matrix44& matrix);
 	void SetFromMatrix(const class Matrix44& matrix);
 	const Quaternion operator * (const Quaternion& quaternion) const;
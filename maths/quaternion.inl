@@ -1,11 +1,7 @@
 namespace gef
 {
 
-inline Quaternion::Quaternion()
-{
-}
-
-inline Quaternion::Quaternion(float new_x, float new_y, float new_z, float new_w) :
+inline constexpr Quaternion::Quaternion(float new_x, float new_y, float new_z, float new_w) :
 	x(new_x),
 	y(new_y),
 	z(new_z),
@@ -13,6 +9,11 @@ inline Quaternion::Quaternion(float new_x, float new_y, float new_z, float new_w
 {
 }
 
+inline constexpr Quaternion Quaternion::MakeIdentity()
+{
+	return Quaternion(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
 
 
 
@@ -1,4 +1,7 @@
 #include "transform.h"
+#ifdef GEF_FAST_MATH
+#include <maths/fast_math.h>
+#endif
 
 namespace gef
 {
@@ -38,7 +41,11 @@ namespace gef
 		Quaternion rotation;
 		scale.Lerp(start.scale(), end.scale(), time);
 		translation.Lerp(start.translation(), end.translation(), time);
+#ifdef GEF_FAST_MATH
+		FastSlerp(rotation, start.rotation(), end.rotation(), time);
+#else
 		rotation.Slerp(start.rotation(), end.rotation(), time);
+#endif
 		set_scale(scale);
 		set_rotation(rotation);
 		set_translation(translation);
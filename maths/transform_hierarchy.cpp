@@ -0,0 +1,195 @@
+#include <maths/transform_hierarchy.h>
+#include <maths/quaternion.h>
+#include <system/parallel_for.h>
+#include <emmintrin.h>
+#include <algorithm>
+
+namespace gef
+{
+	// result = a * b using SSE, four columns of a row at a time
+	static void MultiplyMatrices(Matrix44& result, const Matrix44& a, const Matrix44& b)
+	{
+		const float* b_values = reinterpret_cast<const float*>(&b.GetRow(0));
+		const __m128 b_row0 = _mm_loadu_ps(b_values);
+		const __m128 b_row1 = _mm_loadu_ps(b_values + 4);
+		const __m128 b_row2 = _mm_loadu_ps(b_values + 8);
+		const __m128 b_row3 = _mm_loadu_ps(b_values + 12);
+
+		const float* a_values = reinterpret_cast<const float*>(&a.GetRow(0));
+		for (int row = 0; row < 4; ++row)
+		{
+			const float* a_row = a_values + row * 4;
+			__m128 sum = _mm_mul_ps(_mm_set1_ps(a_row[0]), b_row0);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a_row[1]), b_row1));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a_row[2]), b_row2));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a_row[3]), b_row3));
+
+			float row_values[4];
+			_mm_storeu_ps(row_values, sum);
+			result.SetRow(row, Vector4(row_values[0], row_values[1], row_values[2], row_values[3]));
+		}
+	}
+
+	TransformHierarchy::TransformHierarchy() :
+		update_groups_dirty_(false),
+		any_dirty_(false)
+	{
+	}
+
+	Int32 TransformHierarchy::AddNode(const Int32 parent)
+	{
+		Transform identity;
+		identity.set_rotation(Quaternion(0.0f, 0.0f, 0.0f, 1.0f));
+		identity.set_scale(Vector4(1.0f, 1.0f, 1.0f));
+		identity.set_translation(Vector4(0.0f, 0.0f, 0.0f));
+		return AddNode(parent, identity);
+	}
+
+	Int32 TransformHierarchy::AddNode(const Int32 parent, const Transform& local_transform)
+	{
+		if (parent != kNoParent && (parent < 0 || parent >= node_count()))
+			return -1;
+
+		Int32 node = node_count();
+		Matrix44 identity;
+		identity.SetIdentity();
+
+		parents_.push_back(parent);
+		local_transforms_.push_back(local_transform);
+		world_matrices_.push_back(identity);
+		world_versions_.push_back(0);
+		local_dirty_.push_back(1);
+		world_changed_.push_back(0);
+
+		update_groups_dirty_ = true;
+		any_dirty_ = true;
+		return node;
+	}
+
+	void TransformHierarchy::Clear()
+	{
+		parents_.clear();
+		local_transforms_.clear();
+		world_matrices_.clear();
+		world_versions_.clear();
+		local_dirty_.clear();
+		world_changed_.clear();
+		update_order_.clear();
+		group_offsets_.clear();
+		update_groups_dirty_ = false;
+		any_dirty_ = false;
+	}
+
+	void TransformHierarchy::set_local_transform(const Int32 node, const Transform& local_transform)
+	{
+		local_transforms_[node] = local_transform;
+		local_dirty_[node] = 1;
+		any_dirty_ = true;
+	}
+
+	void TransformHierarchy::BuildUpdateGroups()
+	{
+		// children are always stored after their parents, so a backwards pass sums the size of every subtree
+		const Int32 num_nodes = node_count();
+		std::vector<UInt32> subtree_sizes(num_nodes, 1);
+		for (Int32 node = num_nodes - 1; node >= 0; --node)
+		{
+			if (parents_[node] != kNoParent)
+				subtree_sizes[parents_[node]] += subtree_sizes[node];
+		}
+
+		// a group is the highest subtree that is small enough, its ancestors are in no group
+		// group 0 holds the ancestors and the subtree groups are numbered from 1
+		std::vector<UInt32> group_index(num_nodes);
+		UInt32 num_groups = 1;
+		for (Int32 node = 0; node < num_nodes; ++node)
+		{
+			const Int32 parent = parents_[node];
+			if (parent != kNoParent && group_index[parent] != 0)
+				group_index[node] = group_index[parent];
+			else if (subtree_sizes[node] <= kMaxGroupNodes)
+				group_index[node] = num_groups++;
+			else
+				group_index[node] = 0;
+		}
+
+		// counting sort by group keeps the parent before child order within each group
+		std::vector<UInt32> offsets(num_groups + 1, 0);
+		for (Int32 node = 0; node < num_nodes; ++node)
+			offsets[group_index[node] + 1]++;
+		for (UInt32 group = 0; group < num_groups; ++group)
+			offsets[group + 1] += offsets[group];
+
+		std::vector<UInt32> insert_position(offsets.begin(), offsets.end() - 1);
+		update_order_.resize(num_nodes);
+		for (Int32 node = 0; node < num_nodes; ++node)
+			update_order_[insert_position[group_index[node]]++] = node;
+
+		group_offsets_.assign(offsets.begin() + 1, offsets.end());
+		update_groups_dirty_ = false;
+	}
+
+	void TransformHierarchy::UpdateNodes(const Int32* nodes, const UInt32 num_nodes)
+	{
+		for (UInt32 order_index = 0; order_index < num_nodes; ++order_index)
+		{
+			const Int32 node = nodes[order_index];
+			const Int32 parent = parents_[node];
+			const bool parent_changed = parent != kNoParent && world_changed_[parent];
+
+			if (local_dirty_[node] || parent_changed)
+			{
+				const Matrix44 local_matrix = local_transforms_[node].GetMatrix();
+				if (parent == kNoParent)
+					world_matrices_[node] = local_matrix;
+				else
+					MultiplyMatrices(world_matrices_[node], local_matrix, world_matrices_[parent]);
+
+				local_dirty_[node] = 0;
+				world_changed_[node] = 1;
+				world_versions_[node]++;
+			}
+			else
+			{
+				world_changed_[node] = 0;
+			}
+		}
+	}
+
+	void TransformHierarchy::UpdateWorldMatrices(const UInt32 num_threads)
+	{
+		if (!any_dirty_)
+			return;
+
+		if (update_groups_dirty_)
+			BuildUpdateGroups();
+
+		const UInt32 num_groups = (UInt32)group_offsets_.size() - 1;
+		if (num_threads == 1 || num_groups <= 1)
+		{
+			UpdateNodes(update_order_.data(), (UInt32)update_order_.size());
+		}
+		else
+		{
+			// the ancestors of the groups first, as every group reads the world matrix of its parent
+			const UInt32 groups_begin = group_offsets_.front();
+			UpdateNodes(update_order_.data(), groups_begin);
+
+			// subtrees are independent, so each thread updates the groups that start in an equal share of the nodes
+			// no group is larger than kMaxGroupNodes, which bounds the difference between the shares
+			const UInt32 num_chunks = num_threads > 0 ? num_threads : GetNumHardwareThreads();
+			const UInt32 num_group_nodes = group_offsets_.back() - groups_begin;
+			ParallelFor(num_chunks, num_chunks, [this, num_chunks, groups_begin, num_group_nodes](UInt32 begin, UInt32 end)
+			{
+				const UInt32 first_node = groups_begin + (UInt32)((UInt64)num_group_nodes * begin / num_chunks);
+				const UInt32 end_node = groups_begin + (UInt32)((UInt64)num_group_nodes * end / num_chunks);
+				const UInt32 first = *std::lower_bound(group_offsets_.begin(), group_offsets_.end(), first_node);
+				const UInt32 last = *std::lower_bound(group_offsets_.begin(), group_offsets_.end(), end_node);
+				if (last > first)
+					UpdateNodes(&update_order_[first], last - first);
+			});
+		}
+
+		any_dirty_ = false;
+	}
+}
@@ -0,0 +1,93 @@
+#ifndef _GEF_TRANSFORM_HIERARCHY_H
+#define _GEF_TRANSFORM_HIERARCHY_H
+
+#include <gef.h>
+#include <maths/transform.h>
+#include <maths/matrix44.h>
+#include <vector>
+
+namespace gef
+{
+	/**
+	A hierarchy of parent/child transforms stored in flat arrays.
+	Nodes are only ever appended and a parent must exist before its children are added,
+	so every parent is stored before its children and world matrices can be calculated in a single pass.
+	Only nodes whose local transform, or whose ancestors' transforms, have changed are recalculated.
+	*/
+	class TransformHierarchy
+	{
+	public:
+		/// Parent index of a root node.
+		static const Int32 kNoParent = -1;
+
+		/// @brief Default constructor.
+		TransformHierarchy();
+
+		/// @brief Add a node with an identity local transform.
+		/// @param[in] parent	The index of the parent node, or kNoParent to add a root node.
+		/// @return The index of the new node, or -1 if the parent index is not valid.
+		Int32 AddNode(const Int32 parent = kNoParent);
+
+		/// @brief Add a node.
+		/// @param[in] parent			The index of the parent node, or kNoParent to add a root node.
+		/// @param[in] local_transform	The transform of the node relative to its parent.
+		/// @return The index of the new node, or -1 if the parent index is not valid.
+		Int32 AddNode(const Int32 parent, const Transform& local_transform);
+
+		/// @brief Remove all nodes.
+		void Clear();
+
+		/// @brief Set the transform of a node relative to its parent.
+		/// @param[in] node				The node index.
+		/// @param[in] local_transform	The local transform.
+		/// @note The world matrices of the node and all of its descendants are recalculated in the next call to UpdateWorldMatrices.
+		void set_local_transform(const Int32 node, const Transform& local_transform);
+
+		/// @brief Recalculate the world matrices of all nodes that have changed.
+		/// @param[in] num_threads	The number of threads to use. 0 uses all hardware threads.
+		/// The ancestors of large subtrees are updated first on the calling thread, then the small subtrees below them
+		/// are shared between the threads by node count, so one large root does not leave the other threads idle.
+		void UpdateWorldMatrices(const UInt32 num_threads = 1);
+
+		inline Int32 node_count() const { return (Int32)parents_.size(); }
+		inline Int32 parent(const Int32 node) const { return parents_[node]; }
+		inline const Transform& local_transform(const Int32 node) const { return local_transforms_[node]; }
+
+		/// @brief Get the world matrix of a node, as calculated by the last call to UpdateWorldMatrices.
+		inline const Matrix44& world_matrix(const Int32 node) const { return world_matrices_[node]; }
+
+		/// @brief Get the world matrices of all nodes. Stored contiguously in node order.
+		inline const std::vector<Matrix44>& world_matrices() const { return world_matrices_; }
+
+		/// @brief Get a counter that is incremented every time the world matrix of a node changes.
+		/// Can be used to invalidate data cached from the world matrix.
+		inline UInt32 world_version(const Int32 node) const { return world_versions_[node]; }
+
+	private:
+		void BuildUpdateGroups();
+		void UpdateNodes(const Int32* nodes, const UInt32 num_nodes);
+
+		std::vector<Int32> parents_;
+		std::vector<Transform> local_transforms_;
+		std::vector<Matrix44> world_matrices_;
+		std::vector<UInt32> world_versions_;
+		// local transform has changed since the last update
+		std::vector<UInt8> local_dirty_;
+		// world matrix was recalculated during the current update
+		std::vector<UInt8> world_changed_;
+
+		// nodes with more than this many nodes in their subtree are updated before the groups, so no group is larger
+		static const UInt32 kMaxGroupNodes = 64;
+
+		// node indices, the ancestors of the groups first and then the nodes grouped by subtree,
+		// parent before child throughout
+		std::vector<Int32> update_order_;
+		// start of each group in update_order_, with an extra entry for the end of the last group
+		// the first group starts after the ancestors, which are updated before any group
+		std::vector<UInt32> group_offsets_;
+		bool update_groups_dirty_;
+		bool any_dirty_;
+	};
+}
+
+#endif // _GEF_TRANSFORM_HIERARCHY_H
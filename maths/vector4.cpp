@@ -3,11 +3,19 @@
 #include <maths/matrix33.h>
 #include <maths/math_utils.h>
 #include <math.h>
+#include <type_traits>
 
 namespace gef
 {
-	const Vector4 Vector4::kZero(0.0f, 0.0f, 0.0f);
-	const Vector4 Vector4::kOne(1.0f, 1.0f, 1.0f);
+	// constexpr definitions guarantee the constants are initialised at compile time, not during static initialisation.
+	// Other translation units only see them as const, so code that should fold uses MakeZero and MakeOne
+	constexpr Vector4 Vector4::kZero = Vector4::MakeZero();
+	constexpr Vector4 Vector4::kOne = Vector4::MakeOne();
+
+	static_assert(std::is_trivially_copyable<Vector4>::value && std::is_trivially_default_constructible<Vector4>::value, "Vector4 must be a trivial type");
+	static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 must be tightly packed");
+	static_assert(Vector4::kOne.x() == 1.0f && Vector4::kOne.w() == 0.0f, "Vector4 constants must be compile time constants");
+	static_assert(Vector4::MakeZero().x() == 0.0f && Vector4::MakeOne().z() == 1.0f, "Vector4 builders must be compile time constants");
 
 	float Vector4::LengthSqr() const
 	{
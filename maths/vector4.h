@@ -8,10 +8,17 @@ class Vector4
 {
 public:
 
-	Vector4();
-	~Vector4();
-	Vector4(const float new_x, const float new_y, const float new_z);
-	Vector4(const float new_x, const float new_y, const float new_z, const float new_w);
+	Vector4() = default;
+	constexpr Vector4(const float new_x, const float new_y, const float new_z);
+	constexpr Vector4(const float new_x, const float new_y, const float new_z, const float new_w);
+
+	/// @brief Create a vector with all components zero. Unlike kZero, folds to a constant wherever it is used.
+	/// @return The zero vector.
+	static constexpr Vector4 MakeZero();
+
+	/// @brief Create a vector with the xyz components one and w zero. Unlike kOne, folds to a constant wherever it is used.
+	/// @return The vector.
+	static constexpr Vector4 MakeOne();
 
 	const Vector4 operator - (const Vector4& _vec) const;
 	const Vector4 operator + (const Vector4& _vec) const;
@@ -24,7 +31,7 @@ public:
 	Vector4& operator *= (const float _scalar);
 	Vector4& operator /= (const float _scalar);
 	float& operator[] (int index);
-	const float& operator[] (int index) const;
+	constexpr const float& operator[] (int index) const;
 
 	const Vector4 operator - () const;
 
@@ -46,10 +53,10 @@ public:
 	const float* float_ptr() { return &values_[0]; }
 
 
-	float x() const;
-	float y() const;
-	float z() const;
-	float w() const;
+	constexpr float x() const;
+	constexpr float y() const;
+	constexpr float z() const;
+	constexpr float w() const;
 	void set_x(float x);
 	void set_y(float y);
 	void set_z(float z);
@@ -1,28 +1,24 @@
 namespace gef
 {
 
-	inline Vector4::Vector4()
+	inline constexpr Vector4::Vector4(const float new_x, const float new_y, const float new_z) :
+		values_{ new_x, new_y, new_z, 0.0f }
 	{
 	}
 
-	inline Vector4::~Vector4()
+	inline constexpr Vector4::Vector4(const float new_x, const float new_y, const float new_z, const float new_w) :
+		values_{ new_x, new_y, new_z, new_w }
 	{
 	}
 
-	inline Vector4::Vector4(const float new_x, const float new_y, const float new_z)
+	inline constexpr Vector4 Vector4::MakeZero()
 	{
-		values_[0] = new_x;
-		values_[1] = new_y;
-		values_[2] = new_z;
-		values_[3] = 0.0f;
+		return Vector4(0.0f, 0.0f, 0.0f, 0.0f);
 	}
 
-	inline Vector4::Vector4(const float new_x, const float new_y, const float new_z, const float new_w)
+	inline constexpr Vector4 Vector4::MakeOne()
 	{
-		values_[0] = new_x;
-		values_[1] = new_y;
-		values_[2] = new_z;
-		values_[3] = new_w;
+		return Vector4(1.0f, 1.0f, 1.0f, 0.0f);
 	}
 
 
@@ -99,7 +95,7 @@ namespace gef
 		return values_[index];
 	}
 
-	inline const float& Vector4::operator[] (int index) const
+	inline constexpr const float& Vector4::operator[] (int index) const
 	{
 		return values_[index];
 	}
@@ -109,17 +105,17 @@ namespace gef
 		return Vector4(-values_[0], -values_[1], -values_[2]);
 	}
 
-	inline float Vector4::x() const
+	inline constexpr float Vector4::x() const
 	{
 		return values_[0];
 	}
 
-	inline float Vector4::y() const
+	inline constexpr float Vector4::y() const
 	{
 		return values_[1];
 	}
 
-	inline float Vector4::z() const
+	inline constexpr float Vector4::z() const
 	{
 		return values_[2];
 	}
@@ -139,7 +135,7 @@ namespace gef
 		values_[2] = z;
 	}
 
-	inline float Vector4::w() const
+	inline constexpr float Vector4::w() const
 	{
 		return values_[3];
 	}
@@ -43,6 +43,8 @@ namespace gef
 		,default_blend_state_(NULL)
 		,default_depth_stencil_state_(NULL)
 		,always_depth_stencil_state_(NULL)
+		,instance_buffer_(NULL)
+		,instance_buffer_capacity_(0)
 
 	{
 		platform_.AddShader(&default_shader_);
@@ -142,6 +144,8 @@ namespace gef
 		ReleaseNull(default_blend_state_);
 		ReleaseNull(default_depth_stencil_state_);
 		ReleaseNull(always_depth_stencil_state_);
+		ReleaseNull(instance_buffer_);
+		instance_buffer_capacity_ = 0;
 
 		platform_.RemoveShader(&default_shader_);
 
@@ -174,14 +178,17 @@ namespace gef
 
 	void Renderer3DD3D11::DrawMesh(const  MeshInstance& mesh_instance)
 	{
+		if (IsOccluded(mesh_instance))
+			return;
+
 		// set up the shader data for default shader
 		if (shader_ == &default_shader_)
-			default_shader_.SetSceneData(mesh_instance.lit() ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_);
+			default_shader_.SetSceneData(mesh_instance.lit() ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_, GetLightClusters(mesh_instance.lit()));
 
 		const Mesh* mesh = mesh_instance.mesh();
 		if(mesh != NULL)
 		{
-			set_world_matrix(mesh_instance.transform());
+			set_world_matrix(mesh_instance);
 
 			const VertexBuffer* vertex_buffer = mesh->vertex_buffer();
 			//ShaderGL* shader_GL = static_cast<ShaderGL*>(shader_);
@@ -215,8 +222,7 @@ namespace gef
 						//only set default shader data if current shader is the default shader
 						shader_->SetMaterialData(material);
 
-						// GRC FIXME - probably want to split variable data into scene, object, primitive[material?] based
-						// rather than set all variables per primitive
+						// variable blocks are split by update frequency, only blocks that have changed are uploaded
 						shader_->device_interface()->SetVariableData();
 						shader_->device_interface()->BindTextureResources(platform());
 
@@ -251,9 +257,12 @@ namespace gef
 
 	void Renderer3DD3D11::DrawMesh(const Mesh& mesh, const gef::Matrix44& transform, bool lit)
 	{
+		if (IsOccluded(mesh, transform))
+			return;
+
 		// set up the shader data for default shader
 		if (shader_ == &default_shader_)
-			default_shader_.SetSceneData(lit ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_);
+			default_shader_.SetSceneData(lit ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_, GetLightClusters(lit));
 
 		{
 			set_world_matrix(transform);
@@ -290,8 +299,7 @@ namespace gef
 						//only set default shader data if current shader is the default shader
 						shader_->SetMaterialData(material);
 
-						// GRC FIXME - probably want to split variable data into scene, object, primitive[material?] based
-						// rather than set all variables per primitive
+						// variable blocks are split by update frequency, only blocks that have changed are uploaded
 						shader_->device_interface()->SetVariableData();
 						shader_->device_interface()->BindTextureResources(platform());
 
@@ -314,6 +322,148 @@ namespace gef
 	}
 
 
+	bool Renderer3DD3D11::UpdateInstanceBuffer(const Matrix44* transforms)
+	{
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+		const UInt32 num_instances = (UInt32)visible_instances_.size();
+
+		if (num_instances > instance_buffer_capacity_)
+		{
+			ReleaseNull(instance_buffer_);
+			instance_buffer_capacity_ = 0;
+
+			UInt32 capacity = 64;
+			while (capacity < num_instances)
+				capacity *= 2;
+
+			D3D11_BUFFER_DESC buffer_desc;
+			ZeroMemory(&buffer_desc, sizeof(D3D11_BUFFER_DESC));
+			buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+			buffer_desc.ByteWidth = capacity * sizeof(Matrix44);
+			buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			if (FAILED(platform_d3d.device()->CreateBuffer(&buffer_desc, NULL, &instance_buffer_)))
+				return false;
+			instance_buffer_capacity_ = capacity;
+		}
+
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		if (FAILED(platform_d3d.device_context()->Map(instance_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+			return false;
+		Matrix44* instance_data = static_cast<Matrix44*>(mapped.pData);
+		for (UInt32 instance_num = 0; instance_num < num_instances; ++instance_num)
+			instance_data[instance_num] = transforms[visible_instances_[instance_num]];
+		platform_d3d.device_context()->Unmap(instance_buffer_, 0);
+		return true;
+	}
+
+	void Renderer3DD3D11::DrawMeshInstanced(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit)
+	{
+		const VertexBuffer* vertex_buffer = mesh.vertex_buffer();
+		if (count == 0 || vertex_buffer == NULL || shader_ == NULL)
+			return;
+
+		visible_instances_.clear();
+		for (UInt32 instance_num = 0; instance_num < count; ++instance_num)
+		{
+			if (!IsOccluded(mesh, transforms[instance_num]))
+				visible_instances_.push_back(instance_num);
+		}
+		if (visible_instances_.empty())
+			return;
+
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+
+		// the default shader has an instanced variant that reads the transforms from a vertex stream
+		// other shaders only have per object variables, so each instance is drawn separately
+		// as is every instance when the instanced variant could not be created
+		Shader* shader = shader_;
+		bool hardware_instancing = false;
+		if (shader_ == &default_shader_)
+		{
+			Default3DInstancedShader* instanced_shader = GetDefaultInstancedShader();
+			hardware_instancing = instanced_shader && UpdateInstanceBuffer(transforms);
+			if (hardware_instancing)
+			{
+				shader = instanced_shader;
+				instanced_shader->SetSceneData(lit ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_, GetLightClusters(lit));
+			}
+			else
+				default_shader_.SetSceneData(lit ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_, GetLightClusters(lit));
+		}
+
+		const UInt32 num_instances = (UInt32)visible_instances_.size();
+		draw_count_ += (int)num_instances;
+
+		// the shader, vertex buffer, material and textures are bound once for all instances
+		shader->device_interface()->UseProgram();
+		vertex_buffer->Bind(platform_);
+		if (hardware_instancing)
+		{
+			UINT stride = sizeof(Matrix44);
+			UINT offset = 0;
+			platform_d3d.device_context()->IASetVertexBuffers(1, 1, &instance_buffer_, &stride, &offset);
+		}
+
+		// vertex format must be set after the vertex buffer is bound
+		shader->device_interface()->SetVertexFormat();
+
+		for (UInt32 primitive_index = 0; primitive_index < mesh.num_primitives(); ++primitive_index)
+		{
+			const Primitive* primitive = mesh.GetPrimitive(primitive_index);
+			const IndexBuffer* index_buffer = primitive->index_buffer();
+			if (primitive->type() != UNDEFINED && index_buffer)
+			{
+				const Material* material;
+				if (override_material_)
+					material = override_material_;
+				else
+					material = primitive->material();
+
+				shader->SetMaterialData(material);
+				shader->device_interface()->BindTextureResources(platform());
+
+				SetPrimitiveType(primitive->type());
+
+				int num_indices = index_buffer->num_indices() > 0 ? index_buffer->num_indices() : vertex_buffer->num_vertices();
+				index_buffer->Bind(platform_);
+
+				if (hardware_instancing)
+				{
+					shader->device_interface()->SetVariableData();
+					if (index_buffer->num_indices() > 0)
+						platform_d3d.device_context()->DrawIndexedInstanced(num_indices, num_instances, 0, 0, 0);
+					else
+						platform_d3d.device_context()->DrawInstanced(num_indices, num_instances, 0, 0);
+				}
+				else
+				{
+					// only the per object shader variables change between draws
+					for (UInt32 instance_num : visible_instances_)
+					{
+						set_world_matrix(transforms[instance_num]);
+						shader->SetMeshData(transforms[instance_num]);
+						shader->device_interface()->SetVariableData();
+						DrawPrimitive(index_buffer, num_indices);
+					}
+				}
+
+				index_buffer->Unbind(platform_);
+				shader->device_interface()->UnbindTextureResources(platform());
+			}
+		}
+
+		if (hardware_instancing)
+		{
+			ID3D11Buffer* null_buffer = NULL;
+			UINT stride = 0;
+			UINT offset = 0;
+			platform_d3d.device_context()->IASetVertexBuffers(1, 1, &null_buffer, &stride, &offset);
+		}
+		shader->device_interface()->ClearVertexFormat();
+		vertex_buffer->Unbind(platform_);
+	}
+
 	//void Renderer3DD3D11::DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices)
 	//{
 
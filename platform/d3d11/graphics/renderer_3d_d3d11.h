@@ -32,6 +32,7 @@ namespace gef
 
 		void DrawMesh(const MeshInstance& mesh_instance);
 		void DrawMesh(const Mesh& mesh, const gef::Matrix44& matrix, bool lit);
+		void DrawMeshInstanced(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit);
 //		void DrawPrimitive(const  MeshInstance& mesh_instance, Int32 primitive_index, Int32 num_indices = -1);
 		void SetFillMode(FillMode fill_mode);
 		void SetDepthTest(DepthTest depth_test);
@@ -39,6 +40,8 @@ namespace gef
 		void DrawPrimitive(const IndexBuffer* index_buffer, int num_indices);
 
 	protected:
+		bool UpdateInstanceBuffer(const Matrix44* transforms);
+
 		static const D3D11_PRIMITIVE_TOPOLOGY Renderer3DD3D11::primitive_types[NUM_PRIMITIVE_TYPES];
 
 	private:
@@ -48,6 +51,12 @@ namespace gef
 
 		ID3D11DepthStencilState* default_depth_stencil_state_;
 		ID3D11DepthStencilState* always_depth_stencil_state_;
+
+		// instances that passed occlusion culling in DrawMeshInstanced
+		std::vector<UInt32> visible_instances_;
+		// per instance world matrices for the instanced default shader, in vertex stream 1
+		ID3D11Buffer* instance_buffer_;
+		UInt32 instance_buffer_capacity_;
 	};
 }
 
@@ -110,42 +110,43 @@ namespace gef
 		device_context_->PSSetShader(this->pixel_shader_, NULL, 0);
 	}
 
+	void ShaderInterfaceD3D11::UploadBlock(UpdateFrequency frequency, ID3D11Buffer* constant_buffer)
+	{
+		// blocks that have not changed since the last upload keep their previous contents on the GPU
+		if (!PrepareBlockUpload(frequency))
+			return;
+
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		// Lock the constant buffer so it can be written to.
+		if (FAILED(device_context_->Map(constant_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		{
+			UploadFailed(frequency);
+			return;
+		}
+		// Copy data into buffer
+		memcpy(mapped.pData, GetBlockData(frequency), GetBlockSize(frequency));
+		//Unlock buffer
+		device_context_->Unmap(constant_buffer, 0);
+	}
+
 	void ShaderInterfaceD3D11::SetVariableData()
 	{	
 		if (vs_constant_buffer_)
 		{
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			// Lock the constant buffer so it can be written to.
-			if (FAILED(device_context_->Map(vs_constant_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return;
-			// Copy data into buffer
-			memcpy(mapped.pData, vertex_shader_variable_data_, vertex_shader_variable_data_size_);
-			//Unlock buffer
-			device_context_->Unmap(vs_constant_buffer_, 0);
+			UploadBlock(kPerObject, vs_constant_buffer_);
 			//Attach buffer to vertex shader
 			device_context_->VSSetConstantBuffers(VS_DATA_CBUFFER_SLOT, 1, &vs_constant_buffer_);
 		}
 
 		if (ps_constant_buffer_)
 		{
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			// Lock the constant buffer so it can be written to.
-			if (FAILED(device_context_->Map(ps_constant_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return;
-			// Copy data intp buffer
-			memcpy(mapped.pData, pixel_shader_variable_data_, pixel_shader_variable_data_size_);
-			// Unlock buffer
-			device_context_->Unmap(ps_constant_buffer_, 0);
+			UploadBlock(kPerMaterial, ps_constant_buffer_);
 			//Attach buffer to pixel shader
 			device_context_->PSSetConstantBuffers(PS_DATA_CBUFFER_SLOT, 1, &ps_constant_buffer_);
 		}
 
 		if (light_constant_buffer_) {
-			D3D11_MAPPED_SUBRESOURCE mapped;
-			// Lock the constant buffer so it can be written to.
-			if (FAILED(device_context_->Map(light_constant_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return;
-			// Copy data into buffer
-			memcpy(mapped.pData, light_shader_variable_data_, light_shader_variable_data_size_);
-			//Unlock buffer
-			device_context_->Unmap(light_constant_buffer_, 0);
+			UploadBlock(kPerFrame, light_constant_buffer_);
 			//Attach buffer to shaders
 			device_context_->VSSetConstantBuffers(LIGHT_DATA_CBUFFER_SLOT, 1, &light_constant_buffer_);
 			device_context_->PSSetConstantBuffers(LIGHT_DATA_CBUFFER_SLOT, 1, &light_constant_buffer_);
@@ -196,11 +197,11 @@ namespace gef
 		element.SemanticName = shader_parameter.semantic_name.c_str();
 		element.SemanticIndex = shader_parameter.semantic_index;
 		element.Format = GetVertexAttributeFormat(shader_parameter.type);
-		element.InputSlot = 0;
+		element.InputSlot = shader_parameter.input_slot;
 //		element.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
 		element.AlignedByteOffset = shader_parameter.byte_offset;
-		element.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-		element.InstanceDataStepRate = 0;
+		element.InputSlotClass = shader_parameter.per_instance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+		element.InstanceDataStepRate = shader_parameter.per_instance ? 1 : 0;
 	}
 
 	DXGI_FORMAT ShaderInterfaceD3D11::GetVertexAttributeFormat(VariableType type)
@@ -223,6 +224,12 @@ namespace gef
 		case kUByte4:
 			attribute_type = DXGI_FORMAT_R32_UINT;
 			break;
+		case kUInt4:
+			attribute_type = DXGI_FORMAT_R32G32B32A32_UINT;
+			break;
+		case kUByte4Norm:
+			attribute_type = DXGI_FORMAT_R8G8B8A8_UNORM;
+			break;
 		}
 
 		return attribute_type;
@@ -28,6 +28,7 @@ namespace gef
 
 	protected:
 		void SetInputAssemblyElement(const ShaderParameter& shader_parameter, D3D11_INPUT_ELEMENT_DESC& element);
+		void UploadBlock(UpdateFrequency frequency, ID3D11Buffer* constant_buffer);
 		void CreateVertexShaderConstantBuffer();
 		void CreatePixelShaderConstantBuffer();
 		void CreateLightShaderConstantBuffer();
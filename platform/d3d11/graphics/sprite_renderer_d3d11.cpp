@@ -4,8 +4,12 @@
 #include <system/platform.h>
 #include <graphics/texture.h>
 #include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
 #include <graphics/sprite.h>
 #include <graphics/shader_interface.h>
+#include <algorithm>
+#include <vector>
+#include <cstring>
 
 namespace gef
 {
@@ -17,6 +21,9 @@ namespace gef
 	SpriteRendererD3D11::SpriteRendererD3D11(Platform& platform)
 		:SpriteRenderer(platform)
 		,vertex_buffer_(NULL)
+		,batch_vertex_buffer_(NULL)
+		,batch_vertex_offset_(0)
+		,batch_index_buffer_(NULL)
 		,default_render_state_(NULL)
 		,default_blend_state_(NULL)
 		,default_depth_stencil_state_(NULL)
@@ -112,6 +119,14 @@ namespace gef
 			delete vertex_buffer_;
 		}
 
+		ReleaseNull(batch_vertex_buffer_);
+		if (batch_index_buffer_)
+		{
+			platform_.RemoveIndexBuffer(batch_index_buffer_);
+			delete batch_index_buffer_;
+			batch_index_buffer_ = NULL;
+		}
+
 		if (default_texture_)
 		{
 			platform_.RemoveTexture(default_texture_);
@@ -126,6 +141,19 @@ namespace gef
 		if(clear)
 			platform_.Clear();
 
+		// batched sprites bind their buffers and shader when the batch is drawn
+		sprite_quad_bound_ = false;
+		if (!BatchingActive())
+			BindSpriteQuad();
+
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+		platform_d3d.device_context()->RSSetState(default_render_state_);
+		platform_d3d.device_context()->OMSetBlendState(default_blend_state_, NULL, 0xffffffff);
+		platform_d3d.device_context()->OMSetDepthStencilState(default_depth_stencil_state_, 0);
+	}
+
+	void SpriteRendererD3D11::BindSpriteQuad()
+	{
 		vertex_buffer_->Bind(platform_);
 
 		if (shader_ == &default_shader_)
@@ -139,14 +167,20 @@ namespace gef
 			default_shader_.device_interface()->SetVertexFormat();
 		}
 
-		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
-		platform_d3d.device_context()->RSSetState(default_render_state_);
-		platform_d3d.device_context()->OMSetBlendState(default_blend_state_, NULL, 0xffffffff);
-		platform_d3d.device_context()->OMSetDepthStencilState(default_depth_stencil_state_, 0);
+		sprite_quad_bound_ = true;
 	}
 
-	void SpriteRendererD3D11::DrawSprite(const Sprite& sprite)
+	void SpriteRendererD3D11::RenderSprite(const Sprite& sprite)
 	{
+		if (BatchingActive())
+		{
+			BatchSprite(sprite, sprite.texture() ? sprite.texture() : default_texture_);
+			return;
+		}
+
+		if (!sprite_quad_bound_)
+			BindSpriteQuad();
+
 		if (shader_ == &default_shader_)
 		{
 			const Texture* texture = sprite.texture();
@@ -171,11 +205,132 @@ namespace gef
 		}
 	}
 
+	bool SpriteRendererD3D11::CreateBatchBuffers()
+	{
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+
+		D3D11_BUFFER_DESC buffer_desc;
+		ZeroMemory(&buffer_desc, sizeof(D3D11_BUFFER_DESC));
+		buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+		buffer_desc.ByteWidth = kBatchRingBufferSprites * SpriteBatch::kVerticesPerSprite * sizeof(SpriteBatch::Vertex);
+		buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		if (FAILED(platform_d3d.device()->CreateBuffer(&buffer_desc, NULL, &batch_vertex_buffer_)))
+			return false;
+		batch_vertex_offset_ = 0;
+
+		// the quads of every batch are drawn with the same indices, offset by the first vertex of the batch
+		std::vector<UInt16> indices(batch_.max_sprites() * SpriteBatch::kIndicesPerSprite);
+		SpriteBatch::BuildIndices(indices.data(), batch_.max_sprites());
+		batch_index_buffer_ = IndexBuffer::Create(platform_);
+		if (!batch_index_buffer_->Init(platform_, indices.data(), (UInt32)indices.size(), sizeof(UInt16)))
+		{
+			delete batch_index_buffer_;
+			batch_index_buffer_ = NULL;
+			ReleaseNull(batch_vertex_buffer_);
+			return false;
+		}
+		platform_.AddIndexBuffer(batch_index_buffer_);
+		return true;
+	}
+
+	void SpriteRendererD3D11::FlushBatch()
+	{
+		if (batch_.empty())
+			return;
+
+		if (batch_vertex_buffer_ || CreateBatchBuffers())
+		{
+			const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+			const UInt32 num_vertices = batch_.num_vertices();
+
+			// append to the ring buffer without waiting for draws still reading earlier vertices
+			// the buffer is discarded when it wraps around
+			if (batch_vertex_offset_ + num_vertices > kBatchRingBufferSprites * SpriteBatch::kVerticesPerSprite)
+				batch_vertex_offset_ = 0;
+			const D3D11_MAP map_type = batch_vertex_offset_ == 0 ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
+			D3D11_MAPPED_SUBRESOURCE mapped;
+			if (SUCCEEDED(platform_d3d.device_context()->Map(batch_vertex_buffer_, 0, map_type, 0, &mapped)))
+			{
+				SpriteBatch::Vertex* vertices = static_cast<SpriteBatch::Vertex*>(mapped.pData) + batch_vertex_offset_;
+				memcpy(vertices, batch_.vertices(), num_vertices * sizeof(SpriteBatch::Vertex));
+				platform_d3d.device_context()->Unmap(batch_vertex_buffer_, 0);
+
+				DefaultSpriteBatchShader& batch_shader = *GetBatchShader();
+				batch_shader.device_interface()->UseProgram();
+				batch_shader.SetSceneData(projection_matrix_);
+
+				UINT stride = sizeof(SpriteBatch::Vertex);
+				UINT offset = 0;
+				platform_d3d.device_context()->IASetVertexBuffers(0, 1, &batch_vertex_buffer_, &stride, &offset);
+				batch_shader.device_interface()->SetVertexFormat();
+				batch_index_buffer_->Bind(platform_);
+				platform_d3d.device_context()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+				// one draw for each run of sprites with the same texture
+				for (const SpriteBatch::Run& run : batch_.runs())
+				{
+					batch_shader.SetTexture(run.texture ? run.texture : default_texture_);
+					batch_shader.device_interface()->SetVariableData();
+					batch_shader.device_interface()->BindTextureResources(platform_);
+
+					platform_d3d.device_context()->DrawIndexed(run.num_sprites * SpriteBatch::kIndicesPerSprite, run.first_sprite * SpriteBatch::kIndicesPerSprite, batch_vertex_offset_);
+
+					batch_shader.device_interface()->UnbindTextureResources(platform_);
+				}
+
+				batch_index_buffer_->Unbind(platform_);
+				batch_vertex_offset_ += num_vertices;
+			}
+		}
+
+		batch_.Clear();
+		sprite_quad_bound_ = false;
+	}
+
+	void SpriteRendererD3D11::RenderQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Run* runs, UInt32 num_runs)
+	{
+		if (!batch_vertex_buffer_ && !CreateBatchBuffers())
+			return;
+
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform_);
+		DefaultSpriteBatchShader& batch_shader = *GetBatchShader();
+		batch_shader.device_interface()->UseProgram();
+		batch_shader.SetSceneData(projection_matrix_);
+		vertex_buffer.Bind(platform_);
+		batch_shader.device_interface()->SetVertexFormat();
+		batch_index_buffer_->Bind(platform_);
+		platform_d3d.device_context()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		for (UInt32 run_num = 0; run_num < num_runs; ++run_num)
+		{
+			const SpriteBatch::Run& run = runs[run_num];
+			batch_shader.SetTexture(run.texture ? run.texture : default_texture_);
+			batch_shader.device_interface()->SetVariableData();
+			batch_shader.device_interface()->BindTextureResources(platform_);
+
+			// the index buffer covers one full batch, so the base vertex selects the quads and long runs are split
+			for (UInt32 sprite_num = 0; sprite_num < run.num_sprites; sprite_num += batch_.max_sprites())
+			{
+				const UInt32 num_sprites = std::min(run.num_sprites - sprite_num, batch_.max_sprites());
+				platform_d3d.device_context()->DrawIndexed(num_sprites * SpriteBatch::kIndicesPerSprite, 0, (run.first_sprite + sprite_num) * SpriteBatch::kVerticesPerSprite);
+			}
+
+			batch_shader.device_interface()->UnbindTextureResources(platform_);
+		}
+
+		batch_index_buffer_->Unbind(platform_);
+		sprite_quad_bound_ = false;
+	}
+
 	void SpriteRendererD3D11::End()
 	{
+		DrawSortedSprites();
+		FlushBatch();
+
 		vertex_buffer_->Unbind(platform_);
 
 		platform_.EndScene();
 	}
 }
-
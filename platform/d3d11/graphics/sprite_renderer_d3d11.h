@@ -9,6 +9,7 @@ namespace gef
 	class Platform;
 	class Texture;
 	class VertexBuffer;
+	class IndexBuffer;
 
 	class SpriteRendererD3D11 : public SpriteRenderer
 	{
@@ -17,15 +18,27 @@ namespace gef
 		~SpriteRendererD3D11();
 
 		void Begin(bool clear = true);
-		void DrawSprite(const Sprite& sprite);
 		void End();
 
+	protected:
+		void RenderSprite(const Sprite& sprite);
+		void FlushBatch();
+		void RenderQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Run* runs, UInt32 num_runs);
+
 	private:
 		void CleanUp();
+		void BindSpriteQuad();
+		bool CreateBatchBuffers();
 
 		Texture* default_texture_;
 		VertexBuffer* vertex_buffer_;
 
+		// ring buffer of batched sprite vertices, created the first time a batch is drawn
+		ID3D11Buffer* batch_vertex_buffer_;
+		// next free vertex in the ring buffer
+		UInt32 batch_vertex_offset_;
+		IndexBuffer* batch_index_buffer_;
+
 		ID3D11RasterizerState* default_render_state_;
 		ID3D11BlendState* default_blend_state_;
 		ID3D11DepthStencilState* default_depth_stencil_state_;
@@ -72,6 +72,23 @@ void TextureD3D11::Unbind(const Platform& platform, const int texture_stage_num)
 	Unbind(device_context_, texture_stage_num);
 }
 
+bool TextureD3D11::Update(const Platform& platform, UInt32 x, UInt32 y, UInt32 width, UInt32 height, const UInt8* pixels, UInt32 row_pitch)
+{
+	if (texture_ == NULL || device_context_ == NULL)
+		return false;
+
+	// textures are created with default usage, so only the rectangle is copied to the device
+	D3D11_BOX box;
+	box.left = x;
+	box.top = y;
+	box.front = 0;
+	box.right = x + width;
+	box.bottom = y + height;
+	box.back = 1;
+	device_context_->UpdateSubresource(texture_, 0, &box, pixels, row_pitch, 0);
+	return true;
+}
+
 bool TextureD3D11::CreateTexture(const class Platform& platform, Int32 width, Int32 height, UInt8* image_data, bool has_alpha)
 {
 	const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform);
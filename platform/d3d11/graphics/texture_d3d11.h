@@ -18,6 +18,7 @@ public:
 
 	void Bind(const Platform& platform, const int texture_stage_num) const;
 	void Unbind(const Platform& platform, const int texture_stage_num) const;
+	bool Update(const Platform& platform, UInt32 x, UInt32 y, UInt32 width, UInt32 height, const UInt8* pixels, UInt32 row_pitch);
 
 	inline ID3D11ShaderResourceView* shader_resource_view() const { return shader_resource_view_; }
 	inline void set_shader_resource_view(ID3D11ShaderResourceView* shader_resource_view) {shader_resource_view_ = shader_resource_view; }
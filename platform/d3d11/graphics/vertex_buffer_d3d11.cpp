@@ -94,6 +94,28 @@ namespace gef
 		return success;
 	}
 
+	bool VertexBufferD3D11::UpdateRange(const Platform& platform, const void* vertices, UInt32 first_vertex, UInt32 num_vertices)
+	{
+		// dynamic buffers can only be written whole
+		if (vertex_data_)
+			return VertexBuffer::UpdateRange(platform, vertices, first_vertex, num_vertices);
+
+		if (!vertex_buffer_ || first_vertex + num_vertices > num_vertices_)
+			return false;
+
+		// read only buffers have default usage, so the range is copied on the device timeline without waiting for draws using it
+		D3D11_BOX box;
+		box.left = first_vertex * vertex_byte_size_;
+		box.right = (first_vertex + num_vertices) * vertex_byte_size_;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform);
+		platform_d3d.device_context()->UpdateSubresource(vertex_buffer_, 0, &box, vertices, 0, 0);
+		return true;
+	}
+
 	void VertexBufferD3D11::Bind(const Platform& platform) const
 	{
 		const PlatformD3D11& platform_d3d = static_cast<const PlatformD3D11&>(platform);
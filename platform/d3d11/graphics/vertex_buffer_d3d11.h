@@ -13,6 +13,7 @@ namespace gef
 		~VertexBufferD3D11();
 		bool Init(const Platform& platform, const void* vertices, const UInt32 num_vertices, const UInt32 vertex_byte_size, const bool read_only = true);
 		bool Update(const Platform& platform);
+		bool UpdateRange(const Platform& platform, const void* vertices, UInt32 first_vertex, UInt32 num_vertices);
 
 		void Bind(const Platform& platform) const;
 		void Unbind(const Platform& platform) const;
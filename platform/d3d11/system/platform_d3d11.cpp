@@ -435,6 +435,8 @@ namespace gef
 	//	device_context_->ClearRenderTargetView( render_target_view_, clear_colour );
 	//	device_context_->ClearDepthStencilView( depth_stencil_view_, D3D11_CLEAR_DEPTH, 1.0f, 0 );
 		//Clear(true, true, true);
+
+		frame_allocator_.NextFrame();
 	}
 
 	void PlatformD3D11::PostRender()
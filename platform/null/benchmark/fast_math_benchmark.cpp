@@ -0,0 +1,243 @@
+/*
+ * fast_math_benchmark.cpp
+ *
+ * Measures the error of the approximations in maths/fast_math.h in double precision,
+ * checks it against the bounds documented in the header, then compares their speed
+ * with the functions they replace, Quaternion::Slerp, sinf/cosf and 1/sqrtf.
+ * Needs no device, so it runs on machines without a GPU, e.g. CI servers.
+ *
+ * Build it as a console program with maths/quaternion.cpp, maths/matrix44.cpp and the maths/vector source files.
+ * The include path is the gef root.
+ *
+ * Usage: fast_math_benchmark [num_iterations]
+ * Returns 1 if an error is over its documented bound.
+ */
+
+#include <gef.h>
+#include <maths/fast_math.h>
+#include <maths/quaternion.h>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace gef;
+
+namespace
+{
+	// documented in maths/fast_math.h
+	const double kMaxRsqrtError = 5e-7;
+	const double kMaxSinCosError = 5e-6;
+	const double kMaxSlerpError = 0.005;
+	const double kMaxSlerpErrorHalfTurn = 0.05;
+	const double kSlerpBoundAngle = 130.0;
+
+	// same sequence on every platform, so results can be compared between machines
+	class Random
+	{
+	public:
+		Random() : state_(12345) {}
+		float Next(float min, float max)
+		{
+			state_ = state_ * 1664525u + 1013904223u;
+			return min + (max - min) * (float)(state_ >> 8) / (float)(1u << 24);
+		}
+	private:
+		UInt32 state_;
+	};
+
+	Quaternion RandomRotation(Random& random)
+	{
+		Quaternion rotation(random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f));
+		rotation.Normalise();
+		return rotation;
+	}
+
+	struct DoubleQuaternion
+	{
+		double x, y, z, w;
+	};
+
+	double Dot(const DoubleQuaternion& a, const DoubleQuaternion& b)
+	{
+		return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+	}
+
+	DoubleQuaternion ToDouble(const Quaternion& quaternion)
+	{
+		const DoubleQuaternion result = { quaternion.x, quaternion.y, quaternion.z, quaternion.w };
+		return result;
+	}
+
+	// shortest path slerp in double precision, the reference both float versions are measured against
+	DoubleQuaternion ExactSlerp(const Quaternion& start, const Quaternion& end, float time)
+	{
+		const DoubleQuaternion a = ToDouble(start);
+		DoubleQuaternion b = ToDouble(end);
+		double dot = Dot(a, b);
+		if (dot < 0.0)
+		{
+			dot = -dot;
+			b.x = -b.x; b.y = -b.y; b.z = -b.z; b.w = -b.w;
+		}
+		if (dot > 1.0)
+			dot = 1.0;
+
+		const double angle = acos(dot);
+		const double sin_angle = sin(angle);
+		const double start_weight = sin_angle > 1e-12 ? sin(angle * (1.0 - time)) / sin_angle : 1.0 - time;
+		const double end_weight = sin_angle > 1e-12 ? sin(angle * time) / sin_angle : time;
+		const DoubleQuaternion result = { a.x*start_weight + b.x*end_weight, a.y*start_weight + b.y*end_weight,
+			a.z*start_weight + b.z*end_weight, a.w*start_weight + b.w*end_weight };
+		return result;
+	}
+
+	// angle of the rotation from one quaternion to another in degrees
+	double RotationAngle(const DoubleQuaternion& a, const DoubleQuaternion& b)
+	{
+		double dot = fabs(Dot(a, b)) / sqrt(Dot(a, a) * Dot(b, b));
+		if (dot > 1.0)
+			dot = 1.0;
+		return 2.0 * acos(dot) * 180.0 / 3.14159265358979323846;
+	}
+
+	bool Check(const char* name, double error, double max_error)
+	{
+		const bool passed = error < max_error;
+		printf("%-36s %12.3g %12.3g %s\n", name, error, max_error, passed ? "" : "FAILED");
+		return passed;
+	}
+
+	template<typename Function>
+	double TimeNs(UInt32 num_iterations, UInt32 num_items, Function function)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+		for (UInt32 iteration = 0; iteration < num_iterations; ++iteration)
+			function();
+		const auto end_time = std::chrono::steady_clock::now();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() / ((double)num_iterations * num_items);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const UInt32 num_iterations = argc > 1 ? (UInt32)atoi(argv[1]) : 1000;
+	if (num_iterations == 0)
+		return 1;
+
+	bool success = true;
+	printf("%-36s %12s %12s\n", "error", "measured", "bound");
+
+	double rsqrt_error = 0.0;
+	for (double x = 1e-30; x < 1e30; x *= 1.0001)
+	{
+		const double exact = 1.0 / sqrt((double)(float)x);
+		rsqrt_error = fmax(rsqrt_error, fabs(FastRsqrt((float)x) - exact) / exact);
+	}
+	success &= Check("FastRsqrt, relative", rsqrt_error, kMaxRsqrtError);
+
+	double sin_cos_error = 0.0;
+	for (float x = -100.0f; x < 100.0f; x += 0.0001f)
+	{
+		__m128 sin_4, cos_4;
+		FastSinCos(_mm_set1_ps(x), sin_4, cos_4);
+		sin_cos_error = fmax(sin_cos_error, fmax(fabs(_mm_cvtss_f32(sin_4) - sin((double)x)), fabs(_mm_cvtss_f32(cos_4) - cos((double)x))));
+	}
+	success &= Check("FastSinCos, absolute", sin_cos_error, kMaxSinCosError);
+
+	// random pairs of rotations, error in degrees against a double precision slerp, split by the angle between them.
+	// Quaternion::Slerp is measured the same way for comparison, it loses precision for rotations close together
+	Random random;
+	double slerp_error = 0.0;
+	double slerp_error_half_turn = 0.0;
+	double float_slerp_error = 0.0;
+	for (UInt32 pair_num = 0; pair_num < 1000000; ++pair_num)
+	{
+		const Quaternion start = RandomRotation(random);
+		const Quaternion end = RandomRotation(random);
+		const float time = random.Next(0.0f, 1.0f);
+
+		const DoubleQuaternion exact = ExactSlerp(start, end, time);
+		Quaternion fast, float_slerp;
+		FastSlerp(fast, start, end, time);
+		float_slerp.Slerp(start, end, time);
+		const double error = RotationAngle(exact, ToDouble(fast));
+		if (RotationAngle(ToDouble(start), ToDouble(end)) <= kSlerpBoundAngle)
+			slerp_error = fmax(slerp_error, error);
+		slerp_error_half_turn = fmax(slerp_error_half_turn, error);
+		float_slerp_error = fmax(float_slerp_error, RotationAngle(exact, ToDouble(float_slerp)));
+	}
+	success &= Check("FastSlerp up to 130 degrees, degrees", slerp_error, kMaxSlerpError);
+	success &= Check("FastSlerp up to 180 degrees, degrees", slerp_error_half_turn, kMaxSlerpErrorHalfTurn);
+	printf("%-36s %12.3g\n", "Quaternion::Slerp, degrees", float_slerp_error);
+
+	// the sums are printed so the loops are not optimised away
+	const UInt32 kNumItems = 1024;
+	std::vector<float> values(kNumItems);
+	std::vector<Quaternion> starts(kNumItems);
+	std::vector<Quaternion> ends(kNumItems);
+	for (UInt32 item_num = 0; item_num < kNumItems; ++item_num)
+	{
+		values[item_num] = random.Next(0.01f, 100.0f);
+		starts[item_num] = RandomRotation(random);
+		ends[item_num] = RandomRotation(random);
+	}
+	float sum = 0.0f;
+
+	printf("\n%-36s %12s %12s\n", "ns per call", "exact", "fast");
+
+	const double sqrt_ns = TimeNs(num_iterations, kNumItems, [&]()
+	{
+		for (float value : values)
+			sum += 1.0f / sqrtf(value);
+	});
+	const double rsqrt_ns = TimeNs(num_iterations, kNumItems, [&]()
+	{
+		for (float value : values)
+			sum += FastRsqrt(value);
+	});
+	printf("%-36s %12.2f %12.2f\n", "1/sqrtf, FastRsqrt", sqrt_ns, rsqrt_ns);
+
+	const double sin_cos_ns = TimeNs(num_iterations, kNumItems, [&]()
+	{
+		for (float value : values)
+			sum += sinf(value) + cosf(value);
+	});
+	const double fast_sin_cos_ns = TimeNs(num_iterations, kNumItems, [&]()
+	{
+		__m128 sin_sum = _mm_setzero_ps();
+		for (UInt32 item_num = 0; item_num < kNumItems; item_num += 4)
+		{
+			__m128 sin_values, cos_values;
+			FastSinCos(_mm_loadu_ps(&values[item_num]), sin_values, cos_values);
+			sin_sum = _mm_add_ps(sin_sum, _mm_add_ps(sin_values, cos_values));
+		}
+		sum += _mm_cvtss_f32(sin_sum);
+	});
+	printf("%-36s %12.2f %12.2f\n", "sinf and cosf, FastSinCos", sin_cos_ns, fast_sin_cos_ns);
+
+	const double slerp_ns = TimeNs(num_iterations, kNumItems, [&]()
+	{
+		for (UInt32 item_num = 0; item_num < kNumItems; ++item_num)
+		{
+			Quaternion result;
+			result.Slerp(starts[item_num], ends[item_num], (float)item_num / kNumItems);
+			sum += result.x;
+		}
+	});
+	const double fast_slerp_ns = TimeNs(num_iterations, kNumItems, [&]()
+	{
+		for (UInt32 item_num = 0; item_num < kNumItems; ++item_num)
+		{
+			Quaternion result;
+			FastSlerp(result, starts[item_num], ends[item_num], (float)item_num / kNumItems);
+			sum += result.x;
+		}
+	});
+	printf("%-36s %12.2f %12.2f\n", "Quaternion::Slerp, FastSlerp", slerp_ns, fast_slerp_ns);
+
+	printf("\naverages over %u iterations of %u items, sum %g\n", num_iterations, kNumItems, sum);
+
+	return success ? 0 : 1;
+}
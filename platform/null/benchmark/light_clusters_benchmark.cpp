@@ -0,0 +1,215 @@
+/*
+ * light_clusters_benchmark.cpp
+ *
+ * Checks LightClusters::GatherLights, the CPU reference of the clustered shader light loop,
+ * against testing every light's radius for random points in and around the view frustum,
+ * then measures the cost of building the clusters and of looking up the lights for a point.
+ * Needs no device, so it runs on machines without a GPU, e.g. CI servers.
+ *
+ * Build it as a console program with graphics/light_clusters.cpp, graphics/light_data.cpp, graphics/colour.cpp,
+ * maths/quaternion.cpp, maths/matrix44.cpp and the maths/vector source files. The include path is the gef root.
+ *
+ * Usage: light_clusters_benchmark [num_points]
+ * Returns 1 if a check fails.
+ */
+
+#include <graphics/light_clusters.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace gef;
+
+namespace
+{
+	constexpr float kNearDistance = 0.1f;
+	constexpr float kFarDistance = 100.0f;
+
+	// same sequence on every platform, so results can be compared between machines
+	class Random
+	{
+	public:
+		Random() : state_(12345) {}
+		float Next(float min, float max)
+		{
+			state_ = state_ * 1664525u + 1013904223u;
+			return min + (max - min) * (float)(state_ >> 8) / (float)(1u << 24);
+		}
+	private:
+		UInt32 state_;
+	};
+
+	struct Camera
+	{
+		Matrix44 view_matrix;
+		Matrix44 projection_matrix;
+	};
+
+	Camera MakeCamera()
+	{
+		Camera camera;
+		camera.view_matrix = Matrix44::MakeLookAt(Vector4(0.0f, 2.0f, 10.0f), Vector4(0.0f, 0.0f, -20.0f), Vector4(0.0f, 1.0f, 0.0f));
+		camera.projection_matrix = Matrix44::MakePerspectiveFovD3D(1.0f, 16.0f / 9.0f, kNearDistance, kFarDistance);
+		return camera;
+	}
+
+	// lights spread over a box around the frustum, including some behind the camera and crossing the near plane
+	std::vector<LightData::Light> MakeLights(Random& random, UInt32 num_lights, float min_radius, float max_radius)
+	{
+		std::vector<LightData::Light> lights(num_lights);
+		for (LightData::Light& light : lights)
+		{
+			light.position_ = Vector4(random.Next(-60.0f, 60.0f), random.Next(-30.0f, 30.0f), random.Next(-100.0f, 15.0f), 1.0f);
+			light.radius_ = random.Next(min_radius, max_radius);
+		}
+		return lights;
+	}
+
+	Vector4 RandomPoint(Random& random)
+	{
+		return Vector4(random.Next(-70.0f, 70.0f), random.Next(-35.0f, 35.0f), random.Next(-110.0f, 15.0f), 1.0f);
+	}
+
+	// a point around a light, just inside or outside its radius as often as well inside it
+	Vector4 RandomPointNearLight(Random& random, const LightData::Light& light)
+	{
+		const float range = light.radius_ > 0.0f ? light.radius_ * 1.2f : 1.0f;
+		return Vector4(
+			light.position_.x() + random.Next(-range, range),
+			light.position_.y() + random.Next(-range, range),
+			light.position_.z() + random.Next(-range, range),
+			1.0f);
+	}
+
+	UInt32 GatherLightsBruteForce(const std::vector<LightData::Light>& lights, const Vector4& point, UInt16* light_indices)
+	{
+		UInt32 num_affecting = 0;
+		for (UInt32 light_num = 0; light_num < lights.size(); ++light_num)
+		{
+			if (lights[light_num].radius_ > 0.0f && LightClusters::LightAffectsPoint(lights[light_num], point))
+				light_indices[num_affecting++] = (UInt16)light_num;
+		}
+		return num_affecting;
+	}
+
+	// every light affecting a point must be in the list of the point's cluster, no more and no fewer than the brute force test finds
+	bool CheckGatherLights(const char* name, const std::vector<LightData::Light>& lights, const Camera& camera, bool expect_enabled, UInt32 num_points)
+	{
+		LightClusters light_clusters;
+		const bool enabled = light_clusters.Build(lights.data(), (Int32)lights.size(), camera.view_matrix, camera.projection_matrix);
+		if (enabled != expect_enabled || enabled != light_clusters.enabled())
+		{
+			printf("FAILED: %s, clustering %s\n", name, enabled ? "enabled" : "disabled");
+			return false;
+		}
+
+		Random random;
+		UInt32 num_inside = 0;
+		UInt32 num_lit = 0;
+		UInt16 clustered[MAX_LIGHTS];
+		UInt16 brute_force[MAX_LIGHTS];
+		for (UInt32 point_num = 0; point_num < num_points; ++point_num)
+		{
+			// random points are rarely lit by small lights, so half of them are placed around a light
+			const Vector4 point = (point_num & 1) && !lights.empty() ? RandomPointNearLight(random, lights[point_num / 2 % lights.size()]) : RandomPoint(random);
+			if (light_clusters.GetClusterIndex(point) != -1)
+				++num_inside;
+
+			UInt32 num_clustered = light_clusters.GatherLights(lights.data(), (Int32)lights.size(), point, clustered, MAX_LIGHTS);
+			const UInt32 num_brute_force = GatherLightsBruteForce(lights, point, brute_force);
+			std::sort(clustered, clustered + num_clustered);
+			if (num_clustered != num_brute_force || !std::equal(clustered, clustered + num_clustered, brute_force))
+			{
+				printf("FAILED: %s, point %u (%f, %f, %f) has %u lights, expected %u\n",
+					name, point_num, point.x(), point.y(), point.z(), num_clustered, num_brute_force);
+				return false;
+			}
+			if (num_brute_force > 0)
+				++num_lit;
+		}
+
+		printf("%-26s %4u lights %6u indices %6.1f%% of points in clusters %6.1f%% lit\n",
+			name, (UInt32)lights.size(), light_clusters.num_light_indices(), 100.0 * num_inside / num_points, 100.0 * num_lit / num_points);
+		return true;
+	}
+
+	template<typename Function>
+	double TimeCalls(UInt32 num_calls, Function function)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+		for (UInt32 call_num = 0; call_num < num_calls; ++call_num)
+			function(call_num);
+		const auto end_time = std::chrono::steady_clock::now();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() / num_calls;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const UInt32 num_points = argc > 1 ? (UInt32)atoi(argv[1]) : 100000;
+	if (num_points == 0)
+		return 1;
+
+	const Camera camera = MakeCamera();
+	Random random;
+
+	bool success = true;
+	success &= CheckGatherLights("no lights", std::vector<LightData::Light>(), camera, true, num_points);
+	success &= CheckGatherLights("one light", MakeLights(random, 1, 20.0f, 30.0f), camera, true, num_points);
+	success &= CheckGatherLights("64 small lights", MakeLights(random, 64, 0.5f, 4.0f), camera, true, num_points);
+	success &= CheckGatherLights("512 small lights", MakeLights(random, MAX_LIGHTS, 0.25f, 1.5f), camera, true, num_points);
+	success &= CheckGatherLights("128 mixed lights", MakeLights(random, 128, 0.25f, 5.0f), camera, true, num_points);
+
+	// lights with no radius never affect a point
+	std::vector<LightData::Light> unlit_lights = MakeLights(random, 64, 0.5f, 4.0f);
+	for (UInt32 light_num = 0; light_num < unlit_lights.size(); light_num += 2)
+		unlit_lights[light_num].radius_ = light_num % 4 == 0 ? 0.0f : -1.0f;
+	success &= CheckGatherLights("lights with no radius", unlit_lights, camera, true, num_points);
+
+	// too many cluster entries for the index list, every light is tested instead
+	success &= CheckGatherLights("overflowing lights", MakeLights(random, MAX_LIGHTS, 40.0f, 60.0f), camera, false, num_points);
+
+	// only perspective projections are clustered
+	Camera orthographic_camera = camera;
+	orthographic_camera.projection_matrix = Matrix44::MakeOrthographicFrustumD3D(-20.0f, 20.0f, 10.0f, -10.0f, kNearDistance, kFarDistance);
+	success &= CheckGatherLights("orthographic projection", MakeLights(random, 64, 0.5f, 4.0f), orthographic_camera, false, num_points);
+
+	printf("checks %s\n\n", success ? "passed" : "FAILED");
+
+	// timings, 512 lights as in a scene with hundreds of point lights
+	const std::vector<LightData::Light> lights = MakeLights(random, MAX_LIGHTS, 0.25f, 1.5f);
+	LightClusters light_clusters;
+	const UInt32 num_builds = 100;
+	const double build_ns = TimeCalls(num_builds, [&](UInt32)
+	{
+		light_clusters.Build(lights.data(), (Int32)lights.size(), camera.view_matrix, camera.projection_matrix);
+	});
+
+	// points outside the frustum test every light, so only time points in the clusters
+	std::vector<Vector4> points;
+	while (points.size() < num_points)
+	{
+		const Vector4 point = RandomPoint(random);
+		if (light_clusters.GetClusterIndex(point) != -1)
+			points.push_back(point);
+	}
+
+	UInt16 light_indices[MAX_LIGHTS];
+	UInt32 total_lights = 0;
+	const double clustered_ns = TimeCalls(num_points, [&](UInt32 point_num)
+	{
+		total_lights += light_clusters.GatherLights(lights.data(), (Int32)lights.size(), points[point_num], light_indices, MAX_LIGHTS);
+	});
+	const double brute_force_ns = TimeCalls(num_points, [&](UInt32 point_num)
+	{
+		total_lights += GatherLightsBruteForce(lights, points[point_num], light_indices);
+	});
+
+	printf("%u lights: build %.0f ns, lights for a point %.1f ns clustered, %.1f ns testing every light\n",
+		(UInt32)lights.size(), build_ns, clustered_ns, brute_force_ns);
+	printf("averages over %u builds and %u points in the view frustum, %u lights found\n", num_builds, num_points, total_lights);
+
+	return success ? 0 : 1;
+}
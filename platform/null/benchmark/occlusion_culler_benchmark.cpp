@@ -0,0 +1,220 @@
+/*
+ * occlusion_culler_benchmark.cpp
+ *
+ * Checks OcclusionCuller::IsVisible for boxes behind, beside and in front of a wall occluder,
+ * boxes crossing the near plane and boxes off screen, and that rasterizing on several threads
+ * gives the same depth buffer and results as one thread, then measures the cost of rasterizing
+ * the occluders and of testing a box.
+ * Needs no device, so it runs on machines without a GPU, e.g. CI servers.
+ *
+ * Build it as a console program with graphics/occlusion_culler.cpp, system/parallel_for.cpp, system/frame_allocator.cpp,
+ * and the maths source files. The include path is the gef root.
+ *
+ * Usage: occlusion_culler_benchmark [num_boxes]
+ * Returns 1 if a check fails.
+ */
+
+#include <graphics/occlusion_culler.h>
+#include <maths/aabb.h>
+#include <maths/math_utils.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace gef;
+
+namespace
+{
+	constexpr float kNearDistance = 0.1f;
+	constexpr float kFarDistance = 100.0f;
+	constexpr Vector4 kEyePosition(0.0f, 0.0f, 10.0f);
+
+	// same sequence on every platform, so results can be compared between machines
+	class Random
+	{
+	public:
+		Random() : state_(12345) {}
+		float Next(float min, float max)
+		{
+			state_ = state_ * 1664525u + 1013904223u;
+			return min + (max - min) * (float)(state_ >> 8) / (float)(1u << 24);
+		}
+	private:
+		UInt32 state_;
+	};
+
+	Matrix44 MakeViewProjection()
+	{
+		constexpr Matrix44 view_matrix = Matrix44::MakeLookAt(kEyePosition, Vector4(0.0f, 0.0f, 0.0f), Vector4(0.0f, 1.0f, 0.0f));
+		constexpr Matrix44 projection_matrix = Matrix44::MakePerspectiveFovD3D(FRAMEWORK_PI / 3.0f, 2.0f, kNearDistance, kFarDistance);
+		return view_matrix * projection_matrix;
+	}
+
+	Matrix44 MakeTranslation(float x, float y, float z)
+	{
+		Matrix44 transform;
+		transform.SetIdentity();
+		transform.SetTranslation(Vector4(x, y, z));
+		return transform;
+	}
+
+	bool CheckVisible(const char* name, const OcclusionCuller& occlusion_culler, const Aabb& box, const Matrix44& transform, bool expect_visible)
+	{
+		const bool visible = occlusion_culler.IsVisible(box, transform);
+		printf("%-32s %s\n", name, visible ? "visible" : "culled");
+		if (visible != expect_visible)
+		{
+			printf("FAILED: %s, expected %s\n", name, expect_visible ? "visible" : "culled");
+			return false;
+		}
+		return true;
+	}
+
+	// a 6x6 wall at the origin, facing the camera 10 units away
+	bool CheckWall(UInt32 num_threads)
+	{
+		OcclusionCuller occlusion_culler(256, 128, num_threads);
+		occlusion_culler.Begin(MakeViewProjection());
+		occlusion_culler.AddOccluder(Aabb(Vector4(-3.0f, -3.0f, -0.5f), Vector4(3.0f, 3.0f, 0.5f)), MakeTranslation(0.0f, 0.0f, 0.0f));
+		occlusion_culler.RasterizeOccluders();
+
+		const Aabb box(Vector4(-0.5f, -0.5f, -0.5f), Vector4(0.5f, 0.5f, 0.5f));
+		bool success = true;
+		success &= CheckVisible("box behind the wall", occlusion_culler, box, MakeTranslation(0.0f, 0.0f, -5.0f), false);
+		success &= CheckVisible("box far behind the wall", occlusion_culler, box, MakeTranslation(1.0f, -1.0f, -50.0f), false);
+		success &= CheckVisible("box beside the wall", occlusion_culler, box, MakeTranslation(6.0f, 0.0f, -5.0f), true);
+		success &= CheckVisible("box partly behind the wall", occlusion_culler, box, MakeTranslation(4.5f, 0.0f, -5.0f), true);
+		success &= CheckVisible("box in front of the wall", occlusion_culler, box, MakeTranslation(0.0f, 0.0f, 5.0f), true);
+		// crosses the near plane, so its projection is unbounded
+		success &= CheckVisible("box straddling the near plane", occlusion_culler, box, MakeTranslation(0.0f, 0.0f, kEyePosition.z() - kNearDistance), true);
+		success &= CheckVisible("box off screen", occlusion_culler, box, MakeTranslation(100.0f, 0.0f, -5.0f), false);
+		success &= CheckVisible("box with no bounds", occlusion_culler, Aabb(), MakeTranslation(0.0f, 0.0f, -5.0f), true);
+		return success;
+	}
+
+	struct Scene
+	{
+		std::vector<Matrix44> occluder_transforms;
+		std::vector<Matrix44> box_transforms;
+	};
+
+	// walls spread over the view, some crossing the near plane, with boxes between and behind them and a few off screen
+	Scene MakeScene(UInt32 num_occluders, UInt32 num_boxes)
+	{
+		Random random;
+		Scene scene;
+		for (UInt32 occluder_num = 0; occluder_num < num_occluders; ++occluder_num)
+			scene.occluder_transforms.push_back(MakeTranslation(random.Next(-20.0f, 20.0f), random.Next(-10.0f, 10.0f), random.Next(-60.0f, 10.0f)));
+		for (UInt32 box_num = 0; box_num < num_boxes; ++box_num)
+			scene.box_transforms.push_back(MakeTranslation(random.Next(-25.0f, 25.0f), random.Next(-12.0f, 12.0f), random.Next(-90.0f, 12.0f)));
+		return scene;
+	}
+
+	void RasterizeScene(OcclusionCuller& occlusion_culler, const Scene& scene)
+	{
+		const Aabb wall(Vector4(-2.0f, -2.0f, -0.25f), Vector4(2.0f, 2.0f, 0.25f));
+		occlusion_culler.Begin(MakeViewProjection());
+		for (const Matrix44& transform : scene.occluder_transforms)
+			occlusion_culler.AddOccluder(wall, transform);
+		occlusion_culler.RasterizeOccluders();
+	}
+
+	// every tile is rasterized by exactly one thread, so the depth buffer must not depend on the number of threads
+	bool CheckThreads(const Scene& scene, UInt32 num_threads)
+	{
+		OcclusionCuller single_thread_culler(256, 128, 1);
+		OcclusionCuller multi_thread_culler(256, 128, num_threads);
+		RasterizeScene(single_thread_culler, scene);
+		RasterizeScene(multi_thread_culler, scene);
+
+		const size_t depth_buffer_size = single_thread_culler.width() * single_thread_culler.height() * sizeof(float);
+		if (memcmp(single_thread_culler.depth_buffer(), multi_thread_culler.depth_buffer(), depth_buffer_size) != 0)
+		{
+			printf("FAILED: depth buffers differ between 1 and %u threads\n", num_threads);
+			return false;
+		}
+
+		const Aabb box(Vector4(-0.5f, -0.5f, -0.5f), Vector4(0.5f, 0.5f, 0.5f));
+		UInt32 num_culled = 0;
+		for (UInt32 box_num = 0; box_num < scene.box_transforms.size(); ++box_num)
+		{
+			const bool visible = single_thread_culler.IsVisible(box, scene.box_transforms[box_num]);
+			if (visible != multi_thread_culler.IsVisible(box, scene.box_transforms[box_num]))
+			{
+				printf("FAILED: box %u is %s with 1 thread and not with %u threads\n", box_num, visible ? "visible" : "culled", num_threads);
+				return false;
+			}
+			if (!visible)
+				++num_culled;
+		}
+
+		// a scene where nothing is culled would not test anything
+		if (num_culled == 0 || num_culled == scene.box_transforms.size())
+		{
+			printf("FAILED: %u of %u boxes culled\n", num_culled, (UInt32)scene.box_transforms.size());
+			return false;
+		}
+
+		printf("1 and %2u threads match, %u occluder triangles, %u of %u boxes culled\n",
+			num_threads, single_thread_culler.num_occluder_triangles(), num_culled, (UInt32)scene.box_transforms.size());
+		return true;
+	}
+
+	template<typename Function>
+	double TimeCalls(UInt32 num_calls, Function function)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+		for (UInt32 call_num = 0; call_num < num_calls; ++call_num)
+			function(call_num);
+		const auto end_time = std::chrono::steady_clock::now();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count() / num_calls;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const UInt32 num_boxes = argc > 1 ? (UInt32)atoi(argv[1]) : 10000;
+	if (num_boxes == 0)
+		return 1;
+
+	const UInt32 hardware_threads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 2;
+
+	bool success = true;
+	success &= CheckWall(1);
+	success &= CheckWall(hardware_threads);
+
+	const Scene scene = MakeScene(200, num_boxes);
+	success &= CheckThreads(scene, 2);
+	success &= CheckThreads(scene, 3);
+	success &= CheckThreads(scene, hardware_threads);
+
+	printf("checks %s\n\n", success ? "passed" : "FAILED");
+
+	// timings, rasterizing the scene once a frame and testing every box against it
+	const UInt32 num_frames = 100;
+	const Aabb box(Vector4(-0.5f, -0.5f, -0.5f), Vector4(0.5f, 0.5f, 0.5f));
+	for (UInt32 num_threads : { 1u, hardware_threads })
+	{
+		OcclusionCuller occlusion_culler(256, 128, num_threads);
+		const double rasterize_ns = TimeCalls(num_frames, [&](UInt32)
+		{
+			RasterizeScene(occlusion_culler, scene);
+		});
+
+		UInt32 num_visible = 0;
+		const double is_visible_ns = TimeCalls(num_boxes, [&](UInt32 box_num)
+		{
+			if (occlusion_culler.IsVisible(box, scene.box_transforms[box_num]))
+				++num_visible;
+		});
+
+		printf("%2u threads: rasterize %u occluders %.0f ns, IsVisible %.1f ns, %u of %u boxes visible\n",
+			num_threads, (UInt32)scene.occluder_transforms.size(), rasterize_ns, is_visible_ns, num_visible, num_boxes);
+	}
+	printf("averages over %u frames and %u boxes\n", num_frames, num_boxes);
+
+	return success ? 0 : 1;
+}
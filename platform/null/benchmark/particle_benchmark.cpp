@@ -0,0 +1,150 @@
+/*
+ * particle_benchmark.cpp
+ *
+ * Measures the CPU cost of updating and drawing particle emitters.
+ * Uses the null platform, so it runs on machines without a GPU, e.g. CI servers.
+ *
+ * Build it the same way as render_benchmark.cpp.
+ *
+ * Usage: particle_benchmark [num_frames]
+ */
+
+#include <platform/null/system/platform_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <graphics/sprite_renderer.h>
+#include <graphics/particle_emitter.h>
+#include <graphics/particle_system.h>
+#include <graphics/sprite.h>
+#include <graphics/texture.h>
+#include <system/parallel_for.h>
+#include <maths/math_utils.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace gef;
+
+namespace
+{
+	const UInt32 kNumEmitters = 64;
+	const UInt32 kMaxParticlesPerEmitter = 4096;
+	const float kDeltaTime = 1.0f / 60.0f;
+
+	// the particle loop effects were written with before emitters, one Sprite per particle
+	void DrawAsSprites(SpriteRenderer& sprite_renderer, const ParticleEmitter& emitter)
+	{
+		const SpriteArrays& arrays = emitter.sprite_arrays();
+		Sprite sprite;
+		sprite.set_texture(emitter.texture());
+		for (UInt32 particle = 0; particle < emitter.num_particles(); ++particle)
+		{
+			sprite.set_position(arrays.x[particle], arrays.y[particle], 0.0f);
+			sprite.set_width(arrays.width[particle]);
+			sprite.set_height(arrays.height[particle]);
+			sprite.set_rotation(arrays.rotation[particle]);
+			sprite.set_colour(arrays.colour[particle]);
+			sprite_renderer.DrawSprite(sprite);
+		}
+	}
+
+	template<typename Function>
+	double TimeFrames(UInt32 num_frames, Function function)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+		for (UInt32 frame_num = 0; frame_num < num_frames; ++frame_num)
+			function();
+		const auto end_time = std::chrono::steady_clock::now();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const UInt32 num_frames = argc > 1 ? (UInt32)atoi(argv[1]) : 100;
+	if (num_frames == 0)
+		return 1;
+
+	PlatformNull platform;
+	CommandStreamNull& command_stream = platform.command_stream();
+	command_stream.set_record_commands(false);
+	std::unique_ptr<SpriteRenderer> sprite_renderer(SpriteRenderer::Create(platform));
+	sprite_renderer->set_batching(true);
+	std::unique_ptr<Texture> texture(Texture::CreateCheckerTexture(16, 2, platform));
+
+	// fountains spread over the screen, each near its pool size once running
+	ParticleSystem particle_system;
+	std::vector<std::unique_ptr<ParticleEmitter>> emitters;
+	for (UInt32 emitter_num = 0; emitter_num < kNumEmitters; ++emitter_num)
+	{
+		ParticleEmitter* emitter = new ParticleEmitter(kMaxParticlesPerEmitter);
+		emitter->set_position(Vector2((float)(emitter_num % 8) * 120.0f + 60.0f, (float)(emitter_num / 8) * 60.0f + 30.0f));
+		emitter->set_emit_rate(2500.0f);
+		emitter->set_direction(-0.5f * FRAMEWORK_PI, 0.4f);
+		emitter->set_speed(100.0f, 200.0f);
+		emitter->set_lifetime(1.0f, 2.0f);
+		emitter->set_angular_velocity(-3.0f, 3.0f);
+		emitter->set_acceleration(Vector2(0.0f, 150.0f));
+		emitter->set_size(8.0f, 2.0f);
+		emitter->set_colour(Colour(1.0f, 0.9f, 0.3f, 1.0f), Colour(1.0f, 0.1f, 0.0f, 0.0f));
+		emitter->set_texture(texture.get());
+		emitter->set_random_seed(emitter_num + 1);
+		particle_system.AddEmitter(emitter);
+		emitters.emplace_back(emitter);
+	}
+
+	// run until the emitters reach a steady state
+	particle_system.set_num_threads(1);
+	for (UInt32 frame_num = 0; frame_num < 180; ++frame_num)
+		particle_system.Update(kDeltaTime);
+
+	printf("%u emitters, %u particles, %u hardware threads\n\n", kNumEmitters, particle_system.num_particles(), GetNumHardwareThreads());
+	printf("%-26s %10s %10s\n", "test", "ns/part", "calls");
+
+	UInt32 num_particles = 0;
+	const double update_ns = TimeFrames(num_frames, [&]()
+	{
+		particle_system.Update(kDeltaTime);
+		num_particles += particle_system.num_particles();
+	});
+	printf("%-26s %10.2f %10s\n", "update, 1 thread", update_ns / num_particles, "-");
+
+	particle_system.set_num_threads(0);
+	num_particles = 0;
+	const double parallel_update_ns = TimeFrames(num_frames, [&]()
+	{
+		particle_system.Update(kDeltaTime);
+		num_particles += particle_system.num_particles();
+	});
+	printf("%-26s %10.2f %10s\n", "update, all threads", parallel_update_ns / num_particles, "-");
+
+	const UInt32 frame_particles = particle_system.num_particles();
+	command_stream.GetAndResetStats();
+	const double draw_ns = TimeFrames(num_frames, [&]()
+	{
+		platform.PreRender();
+		sprite_renderer->Begin();
+		particle_system.Draw(*sprite_renderer);
+		sprite_renderer->End();
+		platform.PostRender();
+		command_stream.Clear();
+	});
+	printf("%-26s %10.2f %10u\n", "draw, emitter arrays", draw_ns / ((double)num_frames * frame_particles), command_stream.GetAndResetStats().num_draw_calls() / num_frames);
+
+	const double sprite_draw_ns = TimeFrames(num_frames, [&]()
+	{
+		platform.PreRender();
+		sprite_renderer->Begin();
+		for (const std::unique_ptr<ParticleEmitter>& emitter : emitters)
+			DrawAsSprites(*sprite_renderer, *emitter);
+		sprite_renderer->End();
+		platform.PostRender();
+		command_stream.Clear();
+	});
+	printf("%-26s %10.2f %10u\n", "draw, one Sprite each", sprite_draw_ns / ((double)num_frames * frame_particles), command_stream.GetAndResetStats().num_draw_calls() / num_frames);
+
+	printf("\nper particle averages over %u frames of %.1f ms\n", num_frames, kDeltaTime * 1000.0f);
+
+	return 0;
+}
@@ -0,0 +1,368 @@
+/*
+ * render_benchmark.cpp
+ *
+ * Measures the CPU cost of submitting draws through Renderer3D, RenderQueue and SpriteRenderer.
+ * Uses the null platform, so it runs on machines without a GPU, e.g. CI servers.
+ * The device commands each scene would make are counted by the PlatformNull command stream.
+ *
+ * Build it as a console program with the source files in graphics, maths, system and animation,
+ * plus platform/null/graphics, platform/null/system and platform/std/system in place of a device platform.
+ * The include paths are the gef root and external/libpng, and it links against libpng.
+ *
+ * Usage: render_benchmark [num_frames]
+ */
+
+#include <platform/null/system/platform_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <graphics/renderer_3d.h>
+#include <graphics/sprite_renderer.h>
+#include <graphics/render_queue.h>
+#include <graphics/mesh.h>
+#include <graphics/primitive.h>
+#include <graphics/material.h>
+#include <graphics/texture.h>
+#include <graphics/sprite.h>
+#include <graphics/texture_atlas.h>
+#include <graphics/image_data.h>
+#include <graphics/shader_interface.h>
+#include <maths/math_utils.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace gef;
+
+namespace
+{
+	const UInt32 kNumMeshes = 8;
+	const UInt32 kNumTextures = 4;
+	const UInt32 kNumMeshDraws = 2000;
+	const UInt32 kNumSprites = 5000;
+	const UInt32 kNumManySprites = 100000;
+	const UInt32 kNumLights = 16;
+
+	struct BenchmarkData
+	{
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		std::vector<std::unique_ptr<Texture>> textures;
+		std::vector<Material> materials;
+		std::vector<Matrix44> transforms;
+		std::vector<Sprite> sprites;
+		std::vector<Sprite> atlas_sprites;
+		std::vector<Sprite> layered_sprites;
+		// the same rotated sprites as Sprite objects and as arrays
+		std::vector<Sprite> many_sprites;
+		std::vector<float> many_x;
+		std::vector<float> many_y;
+		std::vector<float> many_width;
+		std::vector<float> many_height;
+		std::vector<float> many_rotation;
+		std::vector<UInt32> many_colour;
+		SpriteArrays many_sprite_arrays;
+		TextureAtlas atlas;
+		RenderQueue render_queue;
+	};
+
+	struct Scene
+	{
+		const char* name;
+		bool sprites;
+		UInt32 num_draws;
+		bool batching;
+		SpriteRenderer::SortMode sort_mode;
+		void(*draw)(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data);
+	};
+
+	// a unit cube with the faces split over two primitives
+	Mesh* CreateCube(PlatformNull& platform, const Material* material0, const Material* material1)
+	{
+		static const float kNormals[6][3] = { {1,0,0}, {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1} };
+
+		Mesh::Vertex vertices[24];
+		UInt16 indices[36];
+		for (Int32 face = 0; face < 6; ++face)
+		{
+			const Vector4 normal(kNormals[face][0], kNormals[face][1], kNormals[face][2]);
+			const Vector4 tangent = face < 2 ? Vector4(0, 1, 0) : Vector4(1, 0, 0);
+			const Vector4 bitangent = normal.CrossProduct(tangent);
+			for (Int32 corner = 0; corner < 4; ++corner)
+			{
+				const float s = (corner & 1) ? 0.5f : -0.5f;
+				const float t = (corner & 2) ? 0.5f : -0.5f;
+				const Vector4 position = normal*0.5f + tangent*s + bitangent*t;
+				Mesh::Vertex& vertex = vertices[face * 4 + corner];
+				vertex.px = position.x(); vertex.py = position.y(); vertex.pz = position.z();
+				vertex.nx = normal.x(); vertex.ny = normal.y(); vertex.nz = normal.z();
+				vertex.u = s + 0.5f; vertex.v = t + 0.5f;
+			}
+
+			const UInt16 base = (UInt16)(face * 4);
+			const UInt16 face_indices[6] = { base, (UInt16)(base + 1), (UInt16)(base + 3), base, (UInt16)(base + 3), (UInt16)(base + 2) };
+			for (Int32 index = 0; index < 6; ++index)
+				indices[face * 6 + index] = face_indices[index];
+		}
+
+		Mesh* mesh = Mesh::Create(platform);
+		mesh->InitVertexBuffer(platform, vertices, 24, sizeof(Mesh::Vertex));
+		mesh->set_aabb(Aabb(Vector4(-0.5f, -0.5f, -0.5f), Vector4(0.5f, 0.5f, 0.5f)));
+		mesh->AllocatePrimitives(2);
+		for (UInt32 primitive_num = 0; primitive_num < 2; ++primitive_num)
+		{
+			Primitive* primitive = mesh->GetPrimitive(primitive_num);
+			primitive->InitIndexBuffer(platform, &indices[primitive_num * 18], 18, sizeof(UInt16));
+			primitive->set_type(TRIANGLE_LIST);
+			primitive->set_material(primitive_num == 0 ? material0 : material1);
+		}
+		return mesh;
+	}
+
+	void DrawOneMesh(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (UInt32 draw_num = 0; draw_num < kNumMeshDraws; ++draw_num)
+			renderer.DrawMesh(*data.meshes[0], data.transforms[draw_num], true);
+	}
+
+	void DrawMixedMeshes(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (UInt32 draw_num = 0; draw_num < kNumMeshDraws; ++draw_num)
+			renderer.DrawMesh(*data.meshes[draw_num % kNumMeshes], data.transforms[draw_num], true);
+	}
+
+	// every other draw full bright, so the default shader switches light data between draws
+	void DrawLitAndUnlitMeshes(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (UInt32 draw_num = 0; draw_num < kNumMeshDraws; ++draw_num)
+			renderer.DrawMesh(*data.meshes[draw_num % kNumMeshes], data.transforms[draw_num], (draw_num & 1) == 0);
+	}
+
+	void DrawMixedMeshesQueued(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (UInt32 draw_num = 0; draw_num < kNumMeshDraws; ++draw_num)
+			data.render_queue.DrawMesh(renderer, *data.meshes[draw_num % kNumMeshes], data.transforms[draw_num], true);
+		data.render_queue.Submit(renderer);
+	}
+
+	void DrawSprites(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (const Sprite& sprite : data.sprites)
+			sprite_renderer.DrawSprite(sprite);
+	}
+
+	void DrawAtlasSprites(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (const Sprite& sprite : data.atlas_sprites)
+			sprite_renderer.DrawSprite(sprite);
+	}
+
+	void DrawLayeredSprites(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (const Sprite& sprite : data.layered_sprites)
+			sprite_renderer.DrawSprite(sprite);
+	}
+
+	void DrawManySprites(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		for (const Sprite& sprite : data.many_sprites)
+			sprite_renderer.DrawSprite(sprite);
+	}
+
+	void DrawManySpriteArrays(Renderer3D& renderer, SpriteRenderer& sprite_renderer, BenchmarkData& data)
+	{
+		sprite_renderer.DrawSprites(data.many_sprite_arrays, kNumManySprites, data.textures[0].get());
+	}
+
+	const Scene kScenes[] =
+	{
+		{ "meshes, one mesh", false, kNumMeshDraws, false, SpriteRenderer::kSortNone, DrawOneMesh },
+		{ "meshes, 8 meshes", false, kNumMeshDraws, false, SpriteRenderer::kSortNone, DrawMixedMeshes },
+		{ "meshes, lit and unlit", false, kNumMeshDraws, false, SpriteRenderer::kSortNone, DrawLitAndUnlitMeshes },
+		{ "render queue, 8 meshes", false, kNumMeshDraws, false, SpriteRenderer::kSortNone, DrawMixedMeshesQueued },
+		{ "sprites, 4 textures", true, kNumSprites, false, SpriteRenderer::kSortNone, DrawSprites },
+		{ "batched sprites", true, kNumSprites, true, SpriteRenderer::kSortNone, DrawSprites },
+		{ "batched sprites, atlas", true, kNumSprites, true, SpriteRenderer::kSortNone, DrawAtlasSprites },
+		{ "batched, 8 layers", true, kNumSprites, true, SpriteRenderer::kSortNone, DrawLayeredSprites },
+		{ "batched, depth sort", true, kNumSprites, true, SpriteRenderer::kSortDepth, DrawLayeredSprites },
+		{ "batched, depth+texture", true, kNumSprites, true, SpriteRenderer::kSortDepthTexture, DrawLayeredSprites },
+		{ "batched, 100k rotated", true, kNumManySprites, true, SpriteRenderer::kSortNone, DrawManySprites },
+		{ "batched, 100k arrays", true, kNumManySprites, true, SpriteRenderer::kSortNone, DrawManySpriteArrays },
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const UInt32 num_frames = argc > 1 ? (UInt32)atoi(argv[1]) : 100;
+	if (num_frames == 0)
+		return 1;
+
+	PlatformNull platform;
+	CommandStreamNull& command_stream = platform.command_stream();
+	std::unique_ptr<Renderer3D> renderer(Renderer3D::Create(platform));
+	std::unique_ptr<SpriteRenderer> sprite_renderer(SpriteRenderer::Create(platform));
+
+	BenchmarkData data;
+	for (UInt32 texture_num = 0; texture_num < kNumTextures; ++texture_num)
+		data.textures.emplace_back(Texture::CreateCheckerTexture(64, (Int32)texture_num + 2, platform));
+
+	data.materials.resize(kNumMeshes * 2);
+	for (UInt32 material_num = 0; material_num < data.materials.size(); ++material_num)
+	{
+		Material& material = data.materials[material_num];
+		material.set_diffuse(Vector4((float)(material_num & 1), (float)((material_num >> 1) & 1), (float)((material_num >> 2) & 1), 1.0f));
+		material.set_texture_diffuse(data.textures[material_num % kNumTextures].get());
+	}
+
+	for (UInt32 mesh_num = 0; mesh_num < kNumMeshes; ++mesh_num)
+		data.meshes.emplace_back(CreateCube(platform, &data.materials[mesh_num * 2], &data.materials[mesh_num * 2 + 1]));
+
+	// a grid of objects in front of the camera
+	for (UInt32 draw_num = 0; draw_num < kNumMeshDraws; ++draw_num)
+	{
+		Matrix44 transform;
+		transform.RotationY((float)draw_num * 0.1f);
+		transform.SetTranslation(Vector4((float)(draw_num % 50) * 2.0f - 50.0f, (float)((draw_num / 50) % 8) * 2.0f - 8.0f, -10.0f - (float)(draw_num / 400) * 4.0f));
+		data.transforms.push_back(transform);
+	}
+
+	for (UInt32 sprite_num = 0; sprite_num < kNumSprites; ++sprite_num)
+	{
+		Sprite sprite;
+		sprite.set_position((float)(sprite_num % 100) * 9.6f, (float)(sprite_num / 100) * 10.8f, 0.0f);
+		sprite.set_width(16.0f);
+		sprite.set_height(16.0f);
+		sprite.set_texture(data.textures[(sprite_num / 8) % kNumTextures].get());
+		data.sprites.push_back(sprite);
+	}
+
+	// sprites in 8 depth layers with the textures mixed, as a particle effect or tile map might submit them
+	for (UInt32 sprite_num = 0; sprite_num < kNumSprites; ++sprite_num)
+	{
+		Sprite sprite = data.sprites[sprite_num];
+		sprite.set_position(sprite.position().x(), sprite.position().y(), (float)(sprite_num % 8) * 0.1f);
+		sprite.set_texture(data.textures[(sprite_num * 7 / 3) % kNumTextures].get());
+		data.layered_sprites.push_back(sprite);
+	}
+
+	// rotating coloured sprites covering the screen, one texture
+	for (UInt32 sprite_num = 0; sprite_num < kNumManySprites; ++sprite_num)
+	{
+		Sprite sprite;
+		sprite.set_position((float)(sprite_num % 400) * 2.4f, (float)(sprite_num / 400) * 2.16f, 0.0f);
+		sprite.set_width(8.0f);
+		sprite.set_height(8.0f);
+		sprite.set_rotation((float)sprite_num * 0.01f);
+		sprite.set_colour(0xff000000 | (sprite_num * 2654435761u >> 8));
+		sprite.set_texture(data.textures[0].get());
+		data.many_sprites.push_back(sprite);
+
+		data.many_x.push_back(sprite.position().x());
+		data.many_y.push_back(sprite.position().y());
+		data.many_width.push_back(sprite.width());
+		data.many_height.push_back(sprite.height());
+		data.many_rotation.push_back(sprite.rotation());
+		data.many_colour.push_back(sprite.colour());
+	}
+	data.many_sprite_arrays.x = data.many_x.data();
+	data.many_sprite_arrays.y = data.many_y.data();
+	data.many_sprite_arrays.width = data.many_width.data();
+	data.many_sprite_arrays.height = data.many_height.data();
+	data.many_sprite_arrays.rotation = data.many_rotation.data();
+	data.many_sprite_arrays.colour = data.many_colour.data();
+
+	// the same sprites with their textures packed in one atlas
+	std::vector<ImageData> atlas_images(kNumTextures);
+	for (UInt32 texture_num = 0; texture_num < kNumTextures; ++texture_num)
+	{
+		UInt32* pixels = new UInt32[64 * 64];
+		for (UInt32 pixel_num = 0; pixel_num < 64 * 64; ++pixel_num)
+			pixels[pixel_num] = 0xff000000 | (0x3f << (texture_num * 8));
+		atlas_images[texture_num].set_image(reinterpret_cast<UInt8*>(pixels));
+		atlas_images[texture_num].set_width(64);
+		atlas_images[texture_num].set_height(64);
+		data.atlas.AddImage(std::to_string(texture_num).c_str(), atlas_images[texture_num]);
+	}
+	data.atlas.Build();
+	data.atlas.CreateTexture(platform);
+	for (UInt32 sprite_num = 0; sprite_num < kNumSprites; ++sprite_num)
+	{
+		Sprite sprite = data.sprites[sprite_num];
+		data.atlas.SetSprite(GetStringId(std::to_string((sprite_num / 8) % kNumTextures)), sprite);
+		data.atlas_sprites.push_back(sprite);
+	}
+
+	for (UInt32 light_num = 0; light_num < kNumLights; ++light_num)
+	{
+		LightData::Light light;
+		light.position_ = Vector4((float)light_num * 6.0f - 48.0f, 4.0f, -20.0f);
+		light.radius_ = 15.0f;
+		renderer->default_shader_data().AddLight(light);
+	}
+
+	constexpr Matrix44 view_matrix = Matrix44::MakeLookAt(Vector4(0.0f, 0.0f, 10.0f), Vector4(0.0f, 0.0f, 0.0f), Vector4(0.0f, 1.0f, 0.0f));
+	renderer->set_view_matrix(view_matrix);
+	renderer->set_projection_matrix(platform.PerspectiveProjectionFov(gef::DegToRad(60.0f), (float)platform.width() / (float)platform.height(), 0.1f, 200.0f));
+
+	// only count the commands, storing them would be measured too
+	command_stream.set_record_commands(false);
+
+	printf("%-26s %10s %10s %10s %12s %10s\n", "scene", "ns/draw", "draws", "calls", "bytes", "redundant");
+	for (const Scene& scene : kScenes)
+	{
+		const UInt32 num_draws = scene.num_draws;
+		sprite_renderer->set_batching(scene.batching);
+		sprite_renderer->set_sort_mode(scene.sort_mode);
+
+		// one frame to warm up caches and scratch buffers
+		double total_ns = 0.0;
+		for (UInt32 frame_num = 0; frame_num <= num_frames; ++frame_num)
+		{
+			if (frame_num == 1)
+			{
+				command_stream.GetAndResetStats();
+				ShaderInterface::GetAndResetBytesUploaded();
+			}
+
+			const auto start_time = std::chrono::steady_clock::now();
+
+			platform.PreRender();
+			if (scene.sprites)
+			{
+				sprite_renderer->Begin();
+				scene.draw(*renderer, *sprite_renderer, data);
+				sprite_renderer->End();
+			}
+			else
+			{
+				renderer->Begin();
+				scene.draw(*renderer, *sprite_renderer, data);
+				renderer->End();
+			}
+			platform.PostRender();
+			command_stream.Clear();
+
+			const auto end_time = std::chrono::steady_clock::now();
+			if (frame_num == 0)
+				continue;
+
+			total_ns += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+
+			if (frame_num == num_frames)
+			{
+				const CommandStreamNull::Stats stats = command_stream.GetAndResetStats();
+				printf("%-26s %10.1f %10u %10u %12llu %10u\n",
+					scene.name,
+					total_ns / ((double)num_frames * num_draws),
+					num_draws,
+					stats.num_draw_calls() / num_frames,
+					(unsigned long long)(stats.total_bytes() / num_frames),
+					stats.num_redundant_binds / num_frames);
+			}
+		}
+	}
+
+	printf("\nper frame averages over %u frames, bytes include shader variable uploads and buffer updates\n", num_frames);
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * ui_benchmark.cpp
+ *
+ * Measures the CPU cost of drawing a HUD each frame with DrawSprite and RenderText,
+ * compared to a UILayer that is static or has a few widgets changing every frame.
+ * Uses the null platform, so it runs on machines without a GPU, e.g. CI servers.
+ *
+ * Build it the same way as render_benchmark.cpp.
+ *
+ * Usage: ui_benchmark [num_frames] [font_name]
+ * Without a font the HUD is sprites only.
+ */
+
+#include <platform/null/system/platform_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <graphics/sprite_renderer.h>
+#include <graphics/ui_layer.h>
+#include <graphics/font.h>
+#include <graphics/sprite.h>
+#include <graphics/texture.h>
+#include <maths/vector4.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace gef;
+
+namespace
+{
+	const UInt32 kNumSprites = 256;
+	const UInt32 kNumStrings = 64;
+
+	struct HudString
+	{
+		Vector4 position;
+		std::wstring text;
+	};
+
+	template<typename Function>
+	double TimeFrames(UInt32 num_frames, Function function)
+	{
+		const auto start_time = std::chrono::steady_clock::now();
+		for (UInt32 frame_num = 0; frame_num < num_frames; ++frame_num)
+			function(frame_num);
+		const auto end_time = std::chrono::steady_clock::now();
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const UInt32 num_frames = argc > 1 ? (UInt32)atoi(argv[1]) : 1000;
+	if (num_frames == 0)
+		return 1;
+
+	PlatformNull platform;
+	CommandStreamNull& command_stream = platform.command_stream();
+	command_stream.set_record_commands(false);
+	std::unique_ptr<SpriteRenderer> sprite_renderer(SpriteRenderer::Create(platform));
+	sprite_renderer->set_batching(true);
+	std::unique_ptr<Texture> texture(Texture::CreateCheckerTexture(16, 2, platform));
+
+	std::unique_ptr<Font> font;
+	if (argc > 2)
+	{
+		font.reset(new Font(platform));
+		if (!font->Load(argv[2]))
+		{
+			printf("could not load font %s\n", argv[2]);
+			return 1;
+		}
+	}
+
+	// icons and bars on a grid, with labels under the first rows
+	std::vector<Sprite> sprites(kNumSprites);
+	for (UInt32 sprite_num = 0; sprite_num < kNumSprites; ++sprite_num)
+	{
+		Sprite& sprite = sprites[sprite_num];
+		sprite.set_position((float)(sprite_num % 32) * 30.0f + 15.0f, (float)(sprite_num / 32) * 60.0f + 15.0f, 0.0f);
+		sprite.set_width(24.0f);
+		sprite.set_height(24.0f);
+		sprite.set_texture(texture.get());
+	}
+	std::vector<HudString> strings(font ? kNumStrings : 0);
+	for (UInt32 string_num = 0; string_num < strings.size(); ++string_num)
+	{
+		strings[string_num].position = Vector4((float)(string_num % 8) * 120.0f, (float)(string_num / 8) * 60.0f + 30.0f, 0.0f);
+		strings[string_num].text = L"Label " + std::to_wstring(string_num * 1000);
+	}
+
+	UILayer ui_layer(platform, UILayer::kDefaultMaxQuads);
+	std::vector<UInt32> sprite_widgets;
+	std::vector<UInt32> string_widgets;
+	for (const Sprite& sprite : sprites)
+		sprite_widgets.push_back(ui_layer.AddSprite(sprite));
+	for (const HudString& hud_string : strings)
+		string_widgets.push_back(ui_layer.AddText(*font, hud_string.position, 1.0f, 0xffffffff, TextJustification::TJ_LEFT, hud_string.text));
+
+	printf("%u sprites, %u strings\n\n", kNumSprites, (UInt32)strings.size());
+	printf("%-26s %10s %10s %10s\n", "test", "ns/frame", "calls", "vb kb");
+
+	auto report = [&](const char* name, double total_ns)
+	{
+		const CommandStreamNull::Stats stats = command_stream.GetAndResetStats();
+		printf("%-26s %10.0f %10u %10.1f\n", name, total_ns / num_frames, stats.num_draw_calls() / num_frames, stats.num_bytes[CommandStreamNull::kUpdateVertexBuffer] / (1024.0 * num_frames));
+	};
+
+	command_stream.GetAndResetStats();
+	const double immediate_ns = TimeFrames(num_frames, [&](UInt32 frame_num)
+	{
+		platform.PreRender();
+		sprite_renderer->Begin();
+		for (const Sprite& sprite : sprites)
+			sprite_renderer->DrawSprite(sprite);
+		for (const HudString& hud_string : strings)
+			font->RenderText(sprite_renderer.get(), hud_string.position, 1.0f, 0xffffffff, TextJustification::TJ_LEFT, hud_string.text);
+		sprite_renderer->End();
+		platform.PostRender();
+		command_stream.Clear();
+	});
+	report("immediate", immediate_ns);
+
+	// the first frame writes every widget
+	sprite_renderer->Begin();
+	ui_layer.Draw(*sprite_renderer);
+	sprite_renderer->End();
+	command_stream.Clear();
+	command_stream.GetAndResetStats();
+
+	const double static_ns = TimeFrames(num_frames, [&](UInt32 frame_num)
+	{
+		platform.PreRender();
+		sprite_renderer->Begin();
+		ui_layer.Draw(*sprite_renderer);
+		sprite_renderer->End();
+		platform.PostRender();
+		command_stream.Clear();
+	});
+	report("ui layer, static", static_ns);
+
+	// a score counting up and a health bar changing width, every frame
+	const double changing_ns = TimeFrames(num_frames, [&](UInt32 frame_num)
+	{
+		platform.PreRender();
+		sprite_renderer->Begin();
+		if (!string_widgets.empty())
+			ui_layer.SetText(string_widgets[0], L"Score " + std::to_wstring(frame_num));
+		Sprite bar = sprites[0];
+		bar.set_width(24.0f + (float)(frame_num % 16));
+		ui_layer.SetSprite(sprite_widgets[0], bar);
+		ui_layer.Draw(*sprite_renderer);
+		sprite_renderer->End();
+		platform.PostRender();
+		command_stream.Clear();
+	});
+	report("ui layer, 2 changing", changing_ns);
+
+	printf("\naverages over %u frames\n", num_frames);
+
+	return 0;
+}
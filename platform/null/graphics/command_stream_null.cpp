@@ -0,0 +1,109 @@
+#include <platform/null/graphics/command_stream_null.h>
+#include <cstring>
+
+namespace gef
+{
+	CommandStreamNull::CommandStreamNull() :
+		record_commands_(true)
+	{
+		memset(&stats_, 0, sizeof(Stats));
+		Clear();
+	}
+
+	void CommandStreamNull::Record(CommandType type, const void* object, UInt32 arg, UInt32 num_instances, UInt32 num_bytes)
+	{
+		stats_.num_commands[type]++;
+		stats_.num_bytes[type] += num_bytes;
+
+		if (record_commands_)
+		{
+			Command command;
+			command.type = type;
+			command.object = object;
+			command.arg = arg;
+			command.num_instances = num_instances;
+			command.num_bytes = num_bytes;
+			commands_.push_back(command);
+		}
+	}
+
+	void CommandStreamNull::Bind(CommandType type, const void* object, UInt32 slot)
+	{
+		const void** bound_object = NULL;
+		switch (type)
+		{
+		case kUseProgram: bound_object = &bound_program_; break;
+		case kBindVertexBuffer: bound_object = &bound_vertex_buffer_; break;
+		case kBindInstanceBuffer: bound_object = &bound_instance_buffer_; break;
+		case kBindIndexBuffer: bound_object = &bound_index_buffer_; break;
+		case kBindTexture: bound_object = slot < kMaxTextureStages ? &bound_textures_[slot] : NULL; break;
+		default: break;
+		}
+
+		if (bound_object)
+		{
+			if (*bound_object == object)
+				stats_.num_redundant_binds++;
+			*bound_object = object;
+		}
+
+		Record(type, object, slot);
+	}
+
+	void CommandStreamNull::Clear()
+	{
+		commands_.clear();
+		bound_program_ = NULL;
+		bound_vertex_buffer_ = NULL;
+		bound_instance_buffer_ = NULL;
+		bound_index_buffer_ = NULL;
+		for (UInt32 stage = 0; stage < kMaxTextureStages; ++stage)
+			bound_textures_[stage] = NULL;
+	}
+
+	CommandStreamNull::Stats CommandStreamNull::GetAndResetStats()
+	{
+		Stats stats = stats_;
+		memset(&stats_, 0, sizeof(Stats));
+		return stats;
+	}
+
+	UInt32 CommandStreamNull::Stats::num_draw_calls() const
+	{
+		return num_commands[kDraw] + num_commands[kDrawIndexed] + num_commands[kDrawInstanced] + num_commands[kDrawIndexedInstanced];
+	}
+
+	UInt64 CommandStreamNull::Stats::total_bytes() const
+	{
+		UInt64 total = 0;
+		for (Int32 type = 0; type < kNumCommandTypes; ++type)
+			total += num_bytes[type];
+		return total;
+	}
+
+	const char* CommandStreamNull::GetCommandName(CommandType type)
+	{
+		static const char* command_names[kNumCommandTypes] =
+		{
+			"UseProgram",
+			"SetVertexFormat",
+			"UploadVariables",
+			"BindVertexBuffer",
+			"BindInstanceBuffer",
+			"BindIndexBuffer",
+			"BindTexture",
+			"UpdateVertexBuffer",
+			"UpdateIndexBuffer",
+			"UpdateInstanceBuffer",
+			"UpdateTexture",
+			"SetPrimitiveType",
+			"SetFillMode",
+			"SetDepthTest",
+			"Draw",
+			"DrawIndexed",
+			"DrawInstanced",
+			"DrawIndexedInstanced"
+		};
+		return type < kNumCommandTypes ? command_names[type] : "Unknown";
+	}
+}
@@ -0,0 +1,106 @@
+#ifndef _GEF_COMMAND_STREAM_NULL_H
+#define _GEF_COMMAND_STREAM_NULL_H
+
+#include <gef.h>
+#include <vector>
+
+namespace gef
+{
+	/**
+	The device commands made by the null platform objects, in submission order.
+	Takes the place of a device context, so the CPU side of rendering can be inspected and measured without a GPU.
+	Every command is counted along with the bytes it would send to the device.
+	Binds of an object that is already bound are counted as redundant, which shows how well draws are sorted by state.
+	*/
+	class CommandStreamNull
+	{
+	public:
+		enum CommandType
+		{
+			kUseProgram,
+			kSetVertexFormat,
+			kUploadVariables,
+			kBindVertexBuffer,
+			kBindInstanceBuffer,
+			kBindIndexBuffer,
+			kBindTexture,
+			kUpdateVertexBuffer,
+			kUpdateIndexBuffer,
+			kUpdateInstanceBuffer,
+			kUpdateTexture,
+			kSetPrimitiveType,
+			kSetFillMode,
+			kSetDepthTest,
+			kDraw,
+			kDrawIndexed,
+			kDrawInstanced,
+			kDrawIndexedInstanced,
+			kNumCommandTypes
+		};
+
+		struct Command
+		{
+			CommandType type;
+			/// The shader interface, buffer or texture used by the command, NULL for render state.
+			const void* object;
+			/// The texture stage, variable block, state value, or the vertex or index count of a draw.
+			UInt32 arg;
+			/// The number of instances drawn.
+			UInt32 num_instances;
+			/// The number of bytes sent to the device.
+			UInt32 num_bytes;
+		};
+
+		struct Stats
+		{
+			UInt32 num_commands[kNumCommandTypes];
+			UInt64 num_bytes[kNumCommandTypes];
+			/// Binds of the shader program, buffers and textures that were already bound.
+			UInt32 num_redundant_binds;
+
+			UInt32 num_draw_calls() const;
+			UInt64 total_bytes() const;
+		};
+
+		CommandStreamNull();
+
+		/// @brief Record a command.
+		void Record(CommandType type, const void* object, UInt32 arg = 0, UInt32 num_instances = 0, UInt32 num_bytes = 0);
+
+		/// @brief Record a bind and track the bound object.
+		/// @param[in] type		kUseProgram, kBindVertexBuffer, kBindInstanceBuffer, kBindIndexBuffer or kBindTexture.
+		/// @param[in] object	The object bound.
+		/// @param[in] slot		The texture stage for kBindTexture.
+		void Bind(CommandType type, const void* object, UInt32 slot = 0);
+
+		/// @brief Remove all recorded commands and forget the bound objects. The stats are kept.
+		void Clear();
+
+		/// @brief Get the counters and reset them to zero.
+		Stats GetAndResetStats();
+
+		inline const std::vector<Command>& commands() const { return commands_; }
+		inline const Stats& stats() const { return stats_; }
+
+		/// @brief Keep the commands as well as counting them. Turn off to measure the cost of submitting draws on its own.
+		inline void set_record_commands(bool record_commands) { record_commands_ = record_commands; }
+		inline bool record_commands() const { return record_commands_; }
+
+		static const char* GetCommandName(CommandType type);
+
+		static const UInt32 kMaxTextureStages = 16;
+
+	private:
+		std::vector<Command> commands_;
+		Stats stats_;
+		bool record_commands_;
+
+		const void* bound_program_;
+		const void* bound_vertex_buffer_;
+		const void* bound_instance_buffer_;
+		const void* bound_index_buffer_;
+		const void* bound_textures_[kMaxTextureStages];
+	};
+}
+
+#endif // _GEF_COMMAND_STREAM_NULL_H
@@ -1,10 +1,63 @@
-#include <graphics/index_buffer.h>
-#include <cstddef> // for NULL definition
+#include <platform/null/graphics/index_buffer_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <platform/null/system/platform_null.h>
+#include <system/platform.h>
+#include <stdlib.h>
+#include <string.h>
 
 namespace gef
 {
 	IndexBuffer* IndexBuffer::Create(Platform& platform)
 	{
-		return NULL;
+		return new IndexBufferNull(PlatformNull::GetCommandStream(platform));
 	}
-}
\ No newline at end of file
+
+	IndexBufferNull::IndexBufferNull(CommandStreamNull* command_stream) :
+		command_stream_(command_stream)
+	{
+	}
+
+	IndexBufferNull::~IndexBufferNull()
+	{
+	}
+
+	bool IndexBufferNull::Init(const Platform& platform, const void* indices, const UInt32 num_indices, const UInt32 index_byte_size, const bool read_only)
+	{
+		num_indices_ = num_indices;
+		index_byte_size_ = index_byte_size;
+
+		// like the device buffers, a copy of the index data is only kept if it can be updated
+		if (!read_only)
+		{
+			index_data_ = malloc(index_byte_size_ * num_indices_);
+			if (!index_data_)
+				return false;
+			if (indices)
+				memcpy(index_data_, indices, index_byte_size_ * num_indices_);
+		}
+
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kUpdateIndexBuffer, this, num_indices_, 0, index_byte_size_ * num_indices_);
+		return true;
+	}
+
+	void IndexBufferNull::Bind(const Platform& platform) const
+	{
+		if (command_stream_)
+			command_stream_->Bind(CommandStreamNull::kBindIndexBuffer, this);
+	}
+
+	void IndexBufferNull::Unbind(const Platform& platform) const
+	{
+	}
+
+	bool IndexBufferNull::Update(const Platform& platform)
+	{
+		if (!index_data_)
+			return false;
+
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kUpdateIndexBuffer, this, num_indices_, 0, index_byte_size_ * num_indices_);
+		return true;
+	}
+}
@@ -0,0 +1,27 @@
+#ifndef _GEF_INDEX_BUFFER_NULL_H
+#define _GEF_INDEX_BUFFER_NULL_H
+
+#include <graphics/index_buffer.h>
+
+namespace gef
+{
+	class CommandStreamNull;
+
+	class IndexBufferNull : public IndexBuffer
+	{
+	public:
+		/// @param[in] command_stream	The stream to record into, or NULL to make no recording.
+		IndexBufferNull(CommandStreamNull* command_stream);
+		~IndexBufferNull();
+
+		bool Init(const Platform& platform, const void* indices, const UInt32 num_indices, const UInt32 index_byte_size, const bool read_only = true);
+		void Bind(const Platform& platform) const;
+		void Unbind(const Platform& platform) const;
+		bool Update(const Platform& platform);
+
+	private:
+		CommandStreamNull* command_stream_;
+	};
+}
+
+#endif // _GEF_INDEX_BUFFER_NULL_H
@@ -0,0 +1,206 @@
+#include <platform/null/graphics/renderer_3d_null.h>
+#include <platform/null/system/platform_null.h>
+#include <graphics/shader.h>
+#include <graphics/shader_interface.h>
+#include <graphics/mesh.h>
+#include <graphics/mesh_instance.h>
+#include <graphics/primitive.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
+
+namespace gef
+{
+	Renderer3D* Renderer3D::Create(Platform& platform)
+	{
+		return new Renderer3DNull(platform);
+	}
+
+	Renderer3DNull::Renderer3DNull(Platform& platform) :
+		Renderer3D(platform),
+		command_stream_(PlatformNull::GetCommandStream(platform))
+	{
+		shader_ = &default_shader_;
+	}
+
+	void Renderer3DNull::Begin(bool clear)
+	{
+		platform_.BeginScene();
+		if (clear)
+			platform_.Clear(clear_render_target_enabled_, clear_depth_buffer_enabled_, clear_stencil_buffer_enabled_);
+	}
+
+	void Renderer3DNull::End()
+	{
+		platform_.EndScene();
+
+		set_clear_render_target_enabled(true);
+		set_clear_depth_buffer_enabled(true);
+		set_clear_stencil_buffer_enabled(true);
+	}
+
+	void Renderer3DNull::DrawMesh(const MeshInstance& mesh_instance)
+	{
+		if (mesh_instance.mesh() == NULL || IsOccluded(mesh_instance))
+			return;
+
+		const Matrix44& transform = mesh_instance.transform();
+		RecordDraw(*mesh_instance.mesh(), &transform, 1, mesh_instance.lit(), false);
+	}
+
+	void Renderer3DNull::DrawMesh(const Mesh& mesh, const gef::Matrix44& transform, bool lit)
+	{
+		if (IsOccluded(mesh, transform))
+			return;
+
+		RecordDraw(mesh, &transform, 1, lit, false);
+	}
+
+	void Renderer3DNull::DrawMeshInstanced(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit)
+	{
+		visible_transforms_.clear();
+		for (UInt32 instance_num = 0; instance_num < count; ++instance_num)
+		{
+			if (!IsOccluded(mesh, transforms[instance_num]))
+				visible_transforms_.push_back(transforms[instance_num]);
+		}
+
+		if (!visible_transforms_.empty())
+			RecordDraw(mesh, visible_transforms_.data(), (UInt32)visible_transforms_.size(), lit, true);
+	}
+
+	void Renderer3DNull::RecordDraw(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit, bool instanced)
+	{
+		const VertexBuffer* vertex_buffer = mesh.vertex_buffer();
+		if (vertex_buffer == NULL || shader_ == NULL)
+			return;
+
+		// match the device renderers, the default shader switches to its instanced variant
+		// other shaders draw each instance separately
+		Shader* shader = shader_;
+		bool hardware_instancing = false;
+		if (shader_ == &default_shader_)
+		{
+			Default3DInstancedShader* instanced_shader = instanced ? GetDefaultInstancedShader() : NULL;
+			if (instanced_shader)
+			{
+				hardware_instancing = true;
+				shader = instanced_shader;
+				instanced_shader->SetSceneData(lit ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_, GetLightClusters(lit));
+				if (command_stream_)
+					command_stream_->Record(CommandStreamNull::kUpdateInstanceBuffer, this, count, 0, count * sizeof(Matrix44));
+			}
+			else
+				default_shader_.SetSceneData(lit ? light_data_ : full_bright_light_data_, view_matrix_, projection_matrix_, GetLightClusters(lit));
+		}
+
+		if (!instanced)
+		{
+			set_world_matrix(transforms[0]);
+			shader->SetMeshData(transforms[0]);
+		}
+
+		draw_count_ += (int)count;
+
+		shader->device_interface()->UseProgram();
+		vertex_buffer->Bind(platform_);
+		if (hardware_instancing)
+			if (command_stream_)
+				command_stream_->Bind(CommandStreamNull::kBindInstanceBuffer, this);
+
+		// vertex format must be set after the vertex buffer is bound
+		shader->device_interface()->SetVertexFormat();
+
+		for (UInt32 primitive_index = 0; primitive_index < mesh.num_primitives(); ++primitive_index)
+		{
+			const Primitive* primitive = mesh.GetPrimitive(primitive_index);
+			const IndexBuffer* index_buffer = primitive->index_buffer();
+			if (primitive->type() == UNDEFINED || index_buffer == NULL)
+				continue;
+
+			shader->SetMaterialData(override_material_ ? override_material_ : primitive->material());
+			shader->device_interface()->BindTextureResources(platform_);
+
+			SetPrimitiveType(primitive->type());
+
+			const int num_indices = index_buffer->num_indices() > 0 ? index_buffer->num_indices() : vertex_buffer->num_vertices();
+			index_buffer->Bind(platform_);
+
+			if (hardware_instancing)
+			{
+				shader->device_interface()->SetVariableData();
+				if (command_stream_)
+					command_stream_->Record(index_buffer->num_indices() > 0 ? CommandStreamNull::kDrawIndexedInstanced : CommandStreamNull::kDrawInstanced, index_buffer, num_indices, count);
+			}
+			else if (instanced)
+			{
+				// only the per object shader variables change between draws
+				for (UInt32 instance_num = 0; instance_num < count; ++instance_num)
+				{
+					set_world_matrix(transforms[instance_num]);
+					shader->SetMeshData(transforms[instance_num]);
+					shader->device_interface()->SetVariableData();
+					DrawPrimitive(index_buffer, num_indices);
+				}
+			}
+			else
+			{
+				shader->device_interface()->SetVariableData();
+				DrawPrimitive(index_buffer, num_indices);
+			}
+
+			index_buffer->Unbind(platform_);
+			shader->device_interface()->UnbindTextureResources(platform_);
+		}
+
+		shader->device_interface()->ClearVertexFormat();
+		vertex_buffer->Unbind(platform_);
+
+		if (command_stream_ && command_stream_->record_commands())
+		{
+			DrawCall draw_call;
+			draw_call.mesh = &mesh;
+			draw_call.shader = shader;
+			draw_call.override_material = override_material_;
+			draw_call.first_instance = (UInt32)instance_transforms_.size();
+			draw_call.num_instances = count;
+			draw_call.lit = lit;
+			draw_calls_.push_back(draw_call);
+			instance_transforms_.insert(instance_transforms_.end(), transforms, transforms + count);
+		}
+	}
+
+	void Renderer3DNull::ClearDrawCalls()
+	{
+		draw_calls_.clear();
+		instance_transforms_.clear();
+	}
+
+	void Renderer3DNull::SetFillMode(FillMode fill_mode)
+	{
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kSetFillMode, NULL, fill_mode);
+	}
+
+	void Renderer3DNull::SetDepthTest(DepthTest depth_test)
+	{
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kSetDepthTest, NULL, depth_test);
+	}
+
+	void Renderer3DNull::SetPrimitiveType(gef::PrimitiveType type)
+	{
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kSetPrimitiveType, NULL, type);
+	}
+
+	void Renderer3DNull::DrawPrimitive(const IndexBuffer* index_buffer, int num_indices)
+	{
+		if (!command_stream_)
+			return;
+
+		if (index_buffer)
+			command_stream_->Record(CommandStreamNull::kDrawIndexed, index_buffer, num_indices, 1);
+		else
+			command_stream_->Record(CommandStreamNull::kDraw, NULL, num_indices, 1);
+	}
+}
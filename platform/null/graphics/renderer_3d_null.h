@@ -0,0 +1,58 @@
+#ifndef _GEF_RENDERER_3D_NULL_H
+#define _GEF_RENDERER_3D_NULL_H
+
+#include <graphics/renderer_3d.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <vector>
+
+namespace gef
+{
+	/**
+	Renderer that records draw calls instead of drawing, so code that submits draws can be tested without a graphics device.
+	Shader data is still set up the same way as the device renderers, and the device commands
+	are recorded in the command stream of the platform the renderer was created with, if it has one.
+	Draw calls are only kept while the command stream records commands.
+	*/
+	class Renderer3DNull : public Renderer3D
+	{
+	public:
+		struct DrawCall
+		{
+			const Mesh* mesh;
+			Shader* shader;
+			const Material* override_material;
+			/// Index of the first instance transform in instance_transforms().
+			UInt32 first_instance;
+			UInt32 num_instances;
+			bool lit;
+		};
+
+		Renderer3DNull(Platform& platform);
+
+		void Begin(bool clear = true);
+		void End();
+
+		void DrawMesh(const MeshInstance& mesh_instance);
+		void DrawMesh(const Mesh& mesh, const gef::Matrix44& matrix, bool lit);
+		void DrawMeshInstanced(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit);
+		void SetFillMode(FillMode fill_mode);
+		void SetDepthTest(DepthTest depth_test);
+		void SetPrimitiveType(gef::PrimitiveType type);
+		void DrawPrimitive(const IndexBuffer* index_buffer, int num_indices);
+
+		inline const std::vector<DrawCall>& draw_calls() const { return draw_calls_; }
+		inline const std::vector<Matrix44>& instance_transforms() const { return instance_transforms_; }
+		void ClearDrawCalls();
+
+	private:
+		void RecordDraw(const Mesh& mesh, const Matrix44* transforms, UInt32 count, bool lit, bool instanced);
+
+		// NULL if the platform does not record commands
+		CommandStreamNull* command_stream_;
+		std::vector<DrawCall> draw_calls_;
+		std::vector<Matrix44> instance_transforms_;
+		std::vector<Matrix44> visible_transforms_;
+	};
+}
+
+#endif // _GEF_RENDERER_3D_NULL_H
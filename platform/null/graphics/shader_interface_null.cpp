@@ -0,0 +1,77 @@
+#include <platform/null/graphics/shader_interface_null.h>
+#include <platform/null/system/platform_null.h>
+#include <graphics/texture.h>
+
+namespace gef
+{
+	ShaderInterface* ShaderInterface::Create(const Platform& platform)
+	{
+		return new ShaderInterfaceNull(PlatformNull::GetCommandStream(platform));
+	}
+
+	ShaderInterfaceNull::ShaderInterfaceNull(CommandStreamNull* command_stream)
+		: command_stream_(command_stream)
+		, num_use_program_calls_(0)
+		, num_block_uploads_(0)
+	{
+	}
+
+	void ShaderInterfaceNull::CreateProgram()
+	{
+		AllocateVariableData();
+	}
+
+	void ShaderInterfaceNull::CreateVertexFormat()
+	{
+	}
+
+	void ShaderInterfaceNull::UseProgram()
+	{
+		num_use_program_calls_++;
+		if (command_stream_)
+			command_stream_->Bind(CommandStreamNull::kUseProgram, this);
+	}
+
+	void ShaderInterfaceNull::SetVariableData()
+	{
+		// count the uploads a device would make
+		for (Int32 frequency = 0; frequency < kNumUpdateFrequencies; ++frequency)
+		{
+			if (GetBlockSize((UpdateFrequency)frequency) > 0 && PrepareBlockUpload((UpdateFrequency)frequency))
+			{
+				num_block_uploads_++;
+				if (command_stream_)
+					command_stream_->Record(CommandStreamNull::kUploadVariables, this, frequency, 0, GetBlockSize((UpdateFrequency)frequency));
+			}
+		}
+	}
+
+	void ShaderInterfaceNull::SetVertexFormat()
+	{
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kSetVertexFormat, this);
+	}
+
+	void ShaderInterfaceNull::ClearVertexFormat()
+	{
+	}
+
+	void ShaderInterfaceNull::BindTextureResources(const Platform& platform) const
+	{
+		// same fallbacks as the device shader interfaces
+		Int32 texture_stage_num = 0;
+		for (auto texture_sampler = texture_samplers_.begin(); texture_sampler != texture_samplers_.end(); ++texture_sampler, ++texture_stage_num)
+		{
+			if (texture_sampler->texture)
+				texture_sampler->texture->Bind(platform, texture_stage_num);
+			else if (texture_sampler->type == TextureType::NORMAL && platform.default_normal())
+				platform.default_normal()->Bind(platform, texture_stage_num);
+			else if (platform.default_texture())
+				platform.default_texture()->Bind(platform, texture_stage_num);
+		}
+	}
+
+	void ShaderInterfaceNull::UnbindTextureResources(const Platform& platform) const
+	{
+	}
+}
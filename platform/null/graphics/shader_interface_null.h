@@ -0,0 +1,52 @@
+#ifndef _GEF_SHADER_INTERFACE_NULL_H
+#define _GEF_SHADER_INTERFACE_NULL_H
+
+#include <graphics/shader_interface.h>
+#include <platform/null/graphics/command_stream_null.h>
+
+namespace gef
+{
+	/**
+	Shader interface that keeps the variable data on the CPU and records how it is used,
+	so shaders and renderers can be tested without a graphics device.
+	Program, variable upload and texture commands go to the recorded command stream of the platform it was created with, if it has one.
+	*/
+	class ShaderInterfaceNull : public ShaderInterface
+	{
+	public:
+		/// @param[in] command_stream	The stream to record into, or NULL to make no recording.
+		ShaderInterfaceNull(CommandStreamNull* command_stream);
+
+		void CreateProgram();
+		void CreateVertexFormat();
+
+		void UseProgram();
+
+		void SetVariableData();
+		void SetVertexFormat();
+		void ClearVertexFormat();
+
+		void BindTextureResources(const Platform& platform) const;
+		void UnbindTextureResources(const Platform& platform) const;
+
+		inline const UInt8* vertex_shader_variable_data() const { return vertex_shader_variable_data_; }
+		inline const UInt8* pixel_shader_variable_data() const { return pixel_shader_variable_data_; }
+		inline const UInt8* light_shader_variable_data() const { return light_shader_variable_data_; }
+		inline const std::vector<ShaderVariable>& vertex_shader_variables() const { return vertex_shader_variables_; }
+		inline const std::vector<ShaderVariable>& pixel_shader_variables() const { return pixel_shader_variables_; }
+		inline const std::vector<ShaderVariable>& light_shader_variables() const { return light_shader_variables_; }
+		inline const std::vector<ShaderParameter>& parameters() const { return parameters_; }
+
+		/// @brief The number of times UseProgram has been called.
+		inline UInt32 num_use_program_calls() const { return num_use_program_calls_; }
+		/// @brief The number of variable blocks uploaded by SetVariableData.
+		inline UInt32 num_block_uploads() const { return num_block_uploads_; }
+
+	private:
+		CommandStreamNull* command_stream_;
+		UInt32 num_use_program_calls_;
+		UInt32 num_block_uploads_;
+	};
+}
+
+#endif // _GEF_SHADER_INTERFACE_NULL_H
@@ -0,0 +1,233 @@
+#include <platform/null/graphics/sprite_renderer_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <platform/null/system/platform_null.h>
+#include <system/platform.h>
+#include <graphics/texture.h>
+#include <graphics/vertex_buffer.h>
+#include <graphics/index_buffer.h>
+#include <graphics/sprite.h>
+#include <graphics/shader_interface.h>
+#include <graphics/primitive.h>
+#include <algorithm>
+#include <vector>
+
+namespace gef
+{
+	SpriteRenderer* SpriteRenderer::Create(Platform& platform)
+	{
+		return new SpriteRendererNull(platform);
+	}
+
+	SpriteRendererNull::SpriteRendererNull(Platform& platform)
+		:SpriteRenderer(platform)
+		,command_stream_(PlatformNull::GetCommandStream(platform))
+		,default_texture_(NULL)
+		,vertex_buffer_(NULL)
+		,batch_buffers_created_(false)
+		,batch_vertex_offset_(0)
+		,batch_index_buffer_(NULL)
+	{
+		vertex_buffer_ = gef::VertexBuffer::Create(platform);
+
+		float vertices[] = {-0.5f,-0.5f,0.0f, 0.5f,-0.5f,0.0f, 0.5f,0.5f,0.0f,    // triangle 1
+			-0.5f,-0.5f,0.0f, 0.5f,0.5f,0.0f, -0.5f,0.5f,0.0f};   // triangle 2
+		vertex_buffer_->Init(platform, vertices, 6, sizeof(float)*3);
+		platform_.AddVertexBuffer(vertex_buffer_);
+
+		default_texture_ = Texture::CreateCheckerTexture(16, 1, platform);
+		platform_.AddTexture(default_texture_);
+
+		platform_.AddShader(&default_shader_);
+		shader_ = &default_shader_;
+
+		projection_matrix_ = platform_.OrthographicFrustum(0.0f, (float)platform_.width(), 0.0f, (float)platform_.height(), -1.0f, 1.0f);
+	}
+
+	SpriteRendererNull::~SpriteRendererNull()
+	{
+		platform_.RemoveShader(&default_shader_);
+
+		if (vertex_buffer_)
+		{
+			platform_.RemoveVertexBuffer(vertex_buffer_);
+			delete vertex_buffer_;
+		}
+
+		if (batch_index_buffer_)
+		{
+			platform_.RemoveIndexBuffer(batch_index_buffer_);
+			delete batch_index_buffer_;
+		}
+
+		if (default_texture_)
+		{
+			platform_.RemoveTexture(default_texture_);
+			delete default_texture_;
+		}
+	}
+
+	void SpriteRendererNull::Begin(bool clear)
+	{
+		platform_.BeginScene();
+		if (clear)
+			platform_.Clear();
+
+		sprite_quad_bound_ = false;
+		if (!BatchingActive())
+			BindSpriteQuad();
+	}
+
+	void SpriteRendererNull::BindSpriteQuad()
+	{
+		vertex_buffer_->Bind(platform_);
+
+		if (shader_ == &default_shader_)
+		{
+			default_shader_.device_interface()->UseProgram();
+			default_shader_.SetSceneData(projection_matrix_);
+			default_shader_.device_interface()->SetVertexFormat();
+		}
+
+		sprite_quad_bound_ = true;
+	}
+
+	void SpriteRendererNull::RenderSprite(const Sprite& sprite)
+	{
+		if (BatchingActive())
+		{
+			BatchSprite(sprite, sprite.texture() ? sprite.texture() : default_texture_);
+			return;
+		}
+
+		if (!sprite_quad_bound_)
+			BindSpriteQuad();
+
+		if (shader_ == &default_shader_)
+		{
+			const Texture* texture = sprite.texture();
+			if (!texture)
+				texture = default_texture_;
+
+			default_shader_.SetSpriteData(sprite, texture);
+			default_shader_.device_interface()->SetVariableData();
+
+			default_shader_.device_interface()->BindTextureResources(platform_);
+		}
+
+		if (command_stream_)
+		{
+			command_stream_->Record(CommandStreamNull::kSetPrimitiveType, NULL, TRIANGLE_LIST);
+			command_stream_->Record(CommandStreamNull::kDraw, NULL, 6, 1);
+		}
+
+		if (shader_ == &default_shader_)
+			default_shader_.device_interface()->UnbindTextureResources(platform_);
+	}
+
+	bool SpriteRendererNull::CreateBatchBuffers()
+	{
+		std::vector<UInt16> indices(batch_.max_sprites() * SpriteBatch::kIndicesPerSprite);
+		SpriteBatch::BuildIndices(indices.data(), batch_.max_sprites());
+		batch_index_buffer_ = IndexBuffer::Create(platform_);
+		if (!batch_index_buffer_->Init(platform_, indices.data(), (UInt32)indices.size(), sizeof(UInt16)))
+		{
+			delete batch_index_buffer_;
+			batch_index_buffer_ = NULL;
+			return false;
+		}
+		platform_.AddIndexBuffer(batch_index_buffer_);
+
+		batch_buffers_created_ = true;
+		batch_vertex_offset_ = 0;
+		return true;
+	}
+
+	void SpriteRendererNull::FlushBatch()
+	{
+		if (batch_.empty())
+			return;
+
+		if (batch_buffers_created_ || CreateBatchBuffers())
+		{
+			DefaultSpriteBatchShader& batch_shader = *GetBatchShader();
+			const UInt32 num_vertices = batch_.num_vertices();
+
+			if (batch_vertex_offset_ + num_vertices > kBatchRingBufferSprites * SpriteBatch::kVerticesPerSprite)
+				batch_vertex_offset_ = 0;
+			if (command_stream_)
+				command_stream_->Record(CommandStreamNull::kUpdateVertexBuffer, &batch_, num_vertices, 0, num_vertices * sizeof(SpriteBatch::Vertex));
+
+			batch_shader.device_interface()->UseProgram();
+			batch_shader.SetSceneData(projection_matrix_);
+			if (command_stream_)
+				command_stream_->Bind(CommandStreamNull::kBindVertexBuffer, &batch_);
+			batch_shader.device_interface()->SetVertexFormat();
+			batch_index_buffer_->Bind(platform_);
+			if (command_stream_)
+				command_stream_->Record(CommandStreamNull::kSetPrimitiveType, NULL, TRIANGLE_LIST);
+
+			for (const SpriteBatch::Run& run : batch_.runs())
+			{
+				batch_shader.SetTexture(run.texture ? run.texture : default_texture_);
+				batch_shader.device_interface()->SetVariableData();
+				batch_shader.device_interface()->BindTextureResources(platform_);
+
+				if (command_stream_)
+					command_stream_->Record(CommandStreamNull::kDrawIndexed, batch_index_buffer_, run.num_sprites * SpriteBatch::kIndicesPerSprite, 1);
+
+				batch_shader.device_interface()->UnbindTextureResources(platform_);
+			}
+
+			batch_index_buffer_->Unbind(platform_);
+			batch_vertex_offset_ += num_vertices;
+		}
+
+		batch_.Clear();
+		sprite_quad_bound_ = false;
+	}
+
+	void SpriteRendererNull::RenderQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Run* runs, UInt32 num_runs)
+	{
+		if (!batch_buffers_created_ && !CreateBatchBuffers())
+			return;
+
+		DefaultSpriteBatchShader& batch_shader = *GetBatchShader();
+		batch_shader.device_interface()->UseProgram();
+		batch_shader.SetSceneData(projection_matrix_);
+		vertex_buffer.Bind(platform_);
+		batch_shader.device_interface()->SetVertexFormat();
+		batch_index_buffer_->Bind(platform_);
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kSetPrimitiveType, NULL, TRIANGLE_LIST);
+
+		for (UInt32 run_num = 0; run_num < num_runs; ++run_num)
+		{
+			const SpriteBatch::Run& run = runs[run_num];
+			batch_shader.SetTexture(run.texture ? run.texture : default_texture_);
+			batch_shader.device_interface()->SetVariableData();
+			batch_shader.device_interface()->BindTextureResources(platform_);
+
+			for (UInt32 sprite_num = 0; sprite_num < run.num_sprites; sprite_num += batch_.max_sprites())
+			{
+				const UInt32 num_sprites = std::min(run.num_sprites - sprite_num, batch_.max_sprites());
+				if (command_stream_)
+					command_stream_->Record(CommandStreamNull::kDrawIndexed, batch_index_buffer_, num_sprites * SpriteBatch::kIndicesPerSprite, 1);
+			}
+
+			batch_shader.device_interface()->UnbindTextureResources(platform_);
+		}
+
+		batch_index_buffer_->Unbind(platform_);
+		sprite_quad_bound_ = false;
+	}
+
+	void SpriteRendererNull::End()
+	{
+		DrawSortedSprites();
+		FlushBatch();
+
+		vertex_buffer_->Unbind(platform_);
+
+		platform_.EndScene();
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef _GEF_SPRITE_RENDERER_NULL_H
+#define _GEF_SPRITE_RENDERER_NULL_H
+
+#include <graphics/sprite_renderer.h>
+
+namespace gef
+{
+	class Platform;
+	class Texture;
+	class VertexBuffer;
+	class IndexBuffer;
+	class CommandStreamNull;
+
+	/**
+	Sprite renderer that records the device commands of the D3D11 sprite renderer
+	in the command stream of the platform it was created with, if it has one.
+	*/
+	class SpriteRendererNull : public SpriteRenderer
+	{
+	public:
+		SpriteRendererNull(Platform& platform);
+		~SpriteRendererNull();
+
+		void Begin(bool clear = true);
+		void End();
+
+	protected:
+		void RenderSprite(const Sprite& sprite);
+		void FlushBatch();
+		void RenderQuads(const VertexBuffer& vertex_buffer, const SpriteBatch::Run* runs, UInt32 num_runs);
+
+	private:
+		void BindSpriteQuad();
+		bool CreateBatchBuffers();
+
+		CommandStreamNull* command_stream_;
+		Texture* default_texture_;
+		VertexBuffer* vertex_buffer_;
+
+		// stands in for the D3D11 ring buffer, the batched vertices are counted but not copied
+		bool batch_buffers_created_;
+		UInt32 batch_vertex_offset_;
+		IndexBuffer* batch_index_buffer_;
+	};
+}
+
+#endif // _GEF_SPRITE_RENDERER_NULL_H
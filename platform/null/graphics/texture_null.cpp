@@ -1,10 +1,40 @@
-#include <graphics/texture.h>
-#include <cstddef> // for NULL definition
+#include <platform/null/graphics/texture_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <platform/null/system/platform_null.h>
+#include <system/platform.h>
+#include <graphics/image_data.h>
 
 namespace gef
 {
 	Texture* Texture::Create(const Platform& platform, const ImageData& image_data)
 	{
-		return NULL;
+		return new TextureNull(platform, image_data);
 	}
-}
\ No newline at end of file
+
+	TextureNull::TextureNull(const Platform& platform, const ImageData& image_data) :
+		command_stream_(PlatformNull::GetCommandStream(platform)),
+		width_(image_data.width()),
+		height_(image_data.height())
+	{
+	}
+
+	void TextureNull::Bind(const Platform& platform, const int texture_stage_num) const
+	{
+		if (command_stream_)
+			command_stream_->Bind(CommandStreamNull::kBindTexture, this, texture_stage_num);
+	}
+
+	void TextureNull::Unbind(const Platform& platform, const int texture_stage_num) const
+	{
+	}
+
+	bool TextureNull::Update(const Platform& platform, UInt32 x, UInt32 y, UInt32 width, UInt32 height, const UInt8* pixels, UInt32 row_pitch)
+	{
+		if (x + width > width_ || y + height > height_)
+			return false;
+
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kUpdateTexture, this, width * height, 0, width * height * 4);
+		return true;
+	}
+}
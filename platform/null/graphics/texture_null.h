@@ -0,0 +1,32 @@
+#ifndef _GEF_TEXTURE_NULL_H
+#define _GEF_TEXTURE_NULL_H
+
+#include <graphics/texture.h>
+
+namespace gef
+{
+	class CommandStreamNull;
+
+	/**
+	Texture that only keeps its size, the image data is not copied.
+	*/
+	class TextureNull : public Texture
+	{
+	public:
+		TextureNull(const Platform& platform, const ImageData& image_data);
+
+		void Bind(const Platform& platform, const int texture_stage_num) const;
+		void Unbind(const Platform& platform, const int texture_stage_num) const;
+		bool Update(const Platform& platform, UInt32 x, UInt32 y, UInt32 width, UInt32 height, const UInt8* pixels, UInt32 row_pitch);
+
+		inline UInt32 width() const { return width_; }
+		inline UInt32 height() const { return height_; }
+
+	private:
+		CommandStreamNull* command_stream_;
+		UInt32 width_;
+		UInt32 height_;
+	};
+}
+
+#endif // _GEF_TEXTURE_NULL_H
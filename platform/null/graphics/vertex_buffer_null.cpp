@@ -1,10 +1,76 @@
-#include <graphics/vertex_buffer.h>
-#include <cstddef> // for NULL definition
+#include <platform/null/graphics/vertex_buffer_null.h>
+#include <platform/null/graphics/command_stream_null.h>
+#include <platform/null/system/platform_null.h>
+#include <system/platform.h>
+#include <stdlib.h>
+#include <string.h>
 
 namespace gef
 {
 	VertexBuffer* VertexBuffer::Create(Platform& platform)
 	{
-		return NULL;
+		return new VertexBufferNull(PlatformNull::GetCommandStream(platform));
 	}
-}
\ No newline at end of file
+
+	VertexBufferNull::VertexBufferNull(CommandStreamNull* command_stream) :
+		command_stream_(command_stream)
+	{
+	}
+
+	VertexBufferNull::~VertexBufferNull()
+	{
+	}
+
+	bool VertexBufferNull::Init(const Platform& platform, const void* vertices, const UInt32 num_vertices, const UInt32 vertex_byte_size, const bool read_only)
+	{
+		num_vertices_ = num_vertices;
+		vertex_byte_size_ = vertex_byte_size;
+
+		// like the device buffers, a copy of the vertex data is only kept if it can be updated
+		if (!read_only)
+		{
+			vertex_data_ = malloc(vertex_byte_size_ * num_vertices_);
+			if (!vertex_data_)
+				return false;
+			if (vertices)
+				memcpy(vertex_data_, vertices, vertex_byte_size_ * num_vertices_);
+		}
+
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kUpdateVertexBuffer, this, num_vertices_, 0, vertex_byte_size_ * num_vertices_);
+		return true;
+	}
+
+	bool VertexBufferNull::Update(const Platform& platform)
+	{
+		if (!vertex_data_)
+			return false;
+
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kUpdateVertexBuffer, this, num_vertices_, 0, vertex_byte_size_ * num_vertices_);
+		return true;
+	}
+
+	bool VertexBufferNull::UpdateRange(const Platform& platform, const void* vertices, UInt32 first_vertex, UInt32 num_vertices)
+	{
+		if (first_vertex + num_vertices > num_vertices_)
+			return false;
+
+		if (vertex_data_)
+			memcpy(static_cast<UInt8*>(vertex_data_) + first_vertex * vertex_byte_size_, vertices, num_vertices * vertex_byte_size_);
+
+		if (command_stream_)
+			command_stream_->Record(CommandStreamNull::kUpdateVertexBuffer, this, num_vertices, 0, vertex_byte_size_ * num_vertices);
+		return true;
+	}
+
+	void VertexBufferNull::Bind(const Platform& platform) const
+	{
+		if (command_stream_)
+			command_stream_->Bind(CommandStreamNull::kBindVertexBuffer, this);
+	}
+
+	void VertexBufferNull::Unbind(const Platform& platform) const
+	{
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef _GEF_VERTEX_BUFFER_NULL_H
+#define _GEF_VERTEX_BUFFER_NULL_H
+
+#include <graphics/vertex_buffer.h>
+
+namespace gef
+{
+	class CommandStreamNull;
+
+	class VertexBufferNull : public VertexBuffer
+	{
+	public:
+		/// @param[in] command_stream	The stream to record into, or NULL to make no recording.
+		VertexBufferNull(CommandStreamNull* command_stream);
+		~VertexBufferNull();
+
+		bool Init(const Platform& platform, const void* vertices, const UInt32 num_vertices, const UInt32 vertex_byte_size, const bool read_only = true);
+		bool Update(const Platform& platform);
+		bool UpdateRange(const Platform& platform, const void* vertices, UInt32 first_vertex, UInt32 num_vertices);
+
+		void Bind(const Platform& platform) const;
+		void Unbind(const Platform& platform) const;
+
+	private:
+		CommandStreamNull* command_stream_;
+	};
+}
+
+#endif // _GEF_VERTEX_BUFFER_NULL_H
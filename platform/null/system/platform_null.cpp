@@ -0,0 +1,151 @@
+#include <platform/null/system/platform_null.h>
+#include <graphics/texture.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace gef
+{
+	namespace
+	{
+		// the live null platforms, so graphics objects created with a Platform& can find their command stream
+		struct PlatformRegistry
+		{
+			static PlatformRegistry& Get()
+			{
+				// created on first use, so platforms can be constructed during static initialisation
+				static PlatformRegistry registry;
+				return registry;
+			}
+
+			std::mutex mutex;
+			std::vector<const PlatformNull*> platforms;
+		};
+	}
+
+	PlatformNull::PlatformNull(Int32 width, Int32 height) :
+		frame_time_(1.0f / 60.0f),
+		num_frames_(0)
+	{
+		{
+			// registered first, the default textures below record their creation
+			PlatformRegistry& registry = PlatformRegistry::Get();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.platforms.push_back(this);
+		}
+
+		set_width(width);
+		set_height(height);
+
+		default_texture_ = Texture::CreateSolidTexture(16, gef::Colour{ 1.f, 1.f, 1.f }, *this);
+		AddTexture(default_texture_);
+		default_normal_ = Texture::CreateSolidTexture(16, gef::Colour{ .5f, .5f, 1.f }, *this);
+		AddTexture(default_normal_);
+	}
+
+	PlatformNull::~PlatformNull()
+	{
+		if (default_texture_)
+		{
+			RemoveTexture(default_texture_);
+			delete default_texture_;
+			default_texture_ = NULL;
+		}
+
+		if (default_normal_)
+		{
+			RemoveTexture(default_normal_);
+			delete default_normal_;
+			default_normal_ = NULL;
+		}
+
+		PlatformRegistry& registry = PlatformRegistry::Get();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.platforms.erase(std::remove(registry.platforms.begin(), registry.platforms.end(), this), registry.platforms.end());
+	}
+
+	bool PlatformNull::Update()
+	{
+		return true;
+	}
+
+	float PlatformNull::GetFrameTime()
+	{
+		return frame_time_;
+	}
+
+	void PlatformNull::PreRender()
+	{
+		frame_allocator_.NextFrame();
+	}
+
+	void PlatformNull::PostRender()
+	{
+		num_frames_++;
+	}
+
+	void PlatformNull::Clear(const bool clear_render_target, const bool clear_depth_buffer, const bool clear_stencil_buffer) const
+	{
+	}
+
+	std::string PlatformNull::FormatFilename(const std::string& filename) const
+	{
+		return filename;
+	}
+
+	std::string PlatformNull::FormatFilename(const char* filename) const
+	{
+		return std::string(filename);
+	}
+
+	Matrix44 PlatformNull::PerspectiveProjectionFov(const float fov, const float aspect_ratio, const float near_distance, const float far_distance) const
+	{
+		Matrix44 projection_matrix;
+		projection_matrix.PerspectiveFovD3D(fov, aspect_ratio, near_distance, far_distance);
+		return projection_matrix;
+	}
+
+	Matrix44 PlatformNull::PerspectiveProjectionFrustum(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance) const
+	{
+		Matrix44 projection_matrix;
+		projection_matrix.PerspectiveFrustumD3D(left, right, top, bottom, near_distance, far_distance);
+		return projection_matrix;
+	}
+
+	Matrix44 PlatformNull::OrthographicFrustum(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance) const
+	{
+		Matrix44 projection_matrix;
+		projection_matrix.OrthographicFrustumD3D(left, right, top, bottom, near_distance, far_distance);
+		return projection_matrix;
+	}
+
+	void PlatformNull::BeginScene() const
+	{
+	}
+
+	void PlatformNull::EndScene() const
+	{
+	}
+
+	std::wstring PlatformNull::GetShaderDirectory() const
+	{
+		return L"null";
+	}
+
+	std::wstring PlatformNull::GetShaderFileExtension() const
+	{
+		return L"";
+	}
+
+	CommandStreamNull* PlatformNull::GetCommandStream(const Platform& platform)
+	{
+		PlatformRegistry& registry = PlatformRegistry::Get();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (const PlatformNull* platform_null : registry.platforms)
+		{
+			if (static_cast<const Platform*>(platform_null) == &platform)
+				return &platform_null->command_stream_;
+		}
+		return NULL;
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef _GEF_PLATFORM_NULL_H
+#define _GEF_PLATFORM_NULL_H
+
+#include <system/platform.h>
+#include <platform/null/graphics/command_stream_null.h>
+
+namespace gef
+{
+	/**
+	Platform without a window or graphics device.
+	The null graphics objects record the device commands they would make into the platform command stream,
+	so the CPU side of rendering can be tested and benchmarked on machines without a GPU.
+	Projections use the Direct3D conventions, the same as the D3D11 platform.
+	*/
+	class PlatformNull : public Platform
+	{
+	public:
+		PlatformNull(Int32 width = 960, Int32 height = 544);
+		~PlatformNull();
+
+		bool Update();
+		float GetFrameTime();
+		void PreRender();
+		void PostRender();
+		void Clear(const bool clear_render_target, const bool clear_depth_buffer, const bool clear_stencil_buffer) const;
+
+		std::string FormatFilename(const std::string& filename) const;
+		std::string FormatFilename(const char* filename) const;
+
+		Matrix44 PerspectiveProjectionFov(const float fov, const float aspect_ratio, const float near_distance, const float far_distance) const;
+		Matrix44 PerspectiveProjectionFrustum(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance) const;
+		Matrix44 OrthographicFrustum(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance) const;
+
+		void BeginScene() const;
+		void EndScene() const;
+		std::wstring GetShaderDirectory() const;
+		std::wstring GetShaderFileExtension() const;
+
+		/// @brief Get the stream the null graphics objects created with a platform record into.
+		/// The null graphics objects call this when they are created and keep the stream.
+		/// @return The command stream if platform is a PlatformNull, otherwise NULL and the objects make no recording.
+		static CommandStreamNull* GetCommandStream(const Platform& platform);
+
+		/// @brief The commands made by the null graphics objects created with this platform.
+		inline CommandStreamNull& command_stream() const { return command_stream_; }
+
+		/// @brief Set the value returned by GetFrameTime, so updates are repeatable.
+		inline void set_frame_time(float frame_time) { frame_time_ = frame_time; }
+		inline UInt32 num_frames() const { return num_frames_; }
+
+	private:
+		// mutable as the graphics objects record through a const Platform&, like a device context
+		mutable CommandStreamNull command_stream_;
+		float frame_time_;
+		UInt32 num_frames_;
+	};
+}
+
+#endif // _GEF_PLATFORM_NULL_H
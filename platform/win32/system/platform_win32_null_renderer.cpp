@@ -19,6 +19,7 @@ namespace gef
 
 	void PlatformWin32NullRenderer::PreRender()
 	{
+		frame_allocator_.NextFrame();
 	}
 
 	void PlatformWin32NullRenderer::PostRender()
@@ -52,23 +53,17 @@ namespace gef
 
 	Matrix44 PlatformWin32NullRenderer::PerspectiveProjectionFov(const float fov, const float aspect_ratio, const float near_distance, const float far_distance) const
 	{
-		Matrix44 projection_matrix;
-		projection_matrix.SetIdentity();
-		return projection_matrix;
+		return Matrix44::MakeIdentity();
 	}
 
 	Matrix44 PlatformWin32NullRenderer::PerspectiveProjectionFrustum(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance) const
 	{
-		Matrix44 projection_matrix;
-		projection_matrix.SetIdentity();
-		return projection_matrix;
+		return Matrix44::MakeIdentity();
 	}
 
 	Matrix44 PlatformWin32NullRenderer::OrthographicFrustum(const float left, const float right, const float top, const float bottom, const float near_distance, const float far_distance) const
 	{
-		Matrix44 projection_matrix;
-		projection_matrix.SetIdentity();
-		return projection_matrix;
+		return Matrix44::MakeIdentity();
 	}
 
 	void PlatformWin32NullRenderer::BeginScene() const
@@ -0,0 +1,180 @@
+#include <system/frame_allocator.h>
+#include <cstdlib>
+#include <cstdint>
+#include <cassert>
+
+namespace gef
+{
+	// memory handed to a thread by AllocateThreadLocal, valid for one frame of one allocator
+	struct ThreadChunk
+	{
+		UInt32 allocator_id;
+		UInt32 frame_number;
+		uintptr_t next;
+		uintptr_t end;
+	};
+
+	static thread_local ThreadChunk thread_chunk = { 0, 0, 0, 0 };
+
+	// ids start at 1 so a zeroed ThreadChunk never matches an allocator
+	static std::atomic<UInt32> next_allocator_id{1};
+
+	static inline uintptr_t AlignUp(uintptr_t address, size_t alignment)
+	{
+		return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	}
+
+	FrameAllocator::FrameAllocator(size_t frame_size, UInt32 num_frames) :
+		frames_(new Frame[num_frames > 0 ? num_frames : 1]),
+		frame_size_(frame_size),
+		num_frames_(num_frames > 0 ? num_frames : 1),
+		current_frame_(0),
+		frame_number_(0),
+		id_(next_allocator_id++),
+		high_water_mark_(0),
+		num_overflows_{0}
+	{
+		for (UInt32 frame_num = 0; frame_num < num_frames_; ++frame_num)
+		{
+			Frame& frame = frames_[frame_num];
+			frame.buffer = NULL;
+			frame.offset = 0;
+			frame.overflow_bytes = 0;
+		}
+	}
+
+	FrameAllocator::~FrameAllocator()
+	{
+		for (UInt32 frame_num = 0; frame_num < num_frames_; ++frame_num)
+		{
+			ResetFrame(frames_[frame_num]);
+			free(frames_[frame_num].buffer);
+		}
+	}
+
+	void* FrameAllocator::Allocate(size_t size, size_t alignment)
+	{
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		Frame& frame = frames_[current_frame_];
+		UInt8* buffer = frame.buffer.load(std::memory_order_acquire);
+		if (buffer == NULL)
+		{
+			buffer = AllocateBuffer(frame);
+			// without a buffer every allocation takes the heap fallback
+			if (buffer == NULL)
+				return AllocateOverflow(frame, size, alignment);
+		}
+
+		const uintptr_t base = (uintptr_t)buffer;
+		size_t offset = frame.offset.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			const size_t aligned_offset = AlignUp(base + offset, alignment) - base;
+			const size_t end = aligned_offset + size;
+			if (end > frame_size_ || end < aligned_offset)
+				return AllocateOverflow(frame, size, alignment);
+
+			// on failure offset is reloaded with the value another thread wrote
+			if (frame.offset.compare_exchange_weak(offset, end, std::memory_order_relaxed))
+				return buffer + aligned_offset;
+		}
+	}
+
+	void* FrameAllocator::AllocateThreadLocal(size_t size, size_t alignment)
+	{
+		ThreadChunk& chunk = thread_chunk;
+		if (chunk.allocator_id == id_ && chunk.frame_number == frame_number_)
+		{
+			const uintptr_t address = AlignUp(chunk.next, alignment);
+			if (address <= chunk.end && chunk.end - address >= size)
+			{
+				chunk.next = address + size;
+				return (void*)address;
+			}
+		}
+
+		// large requests would waste most of a chunk, so they go straight to the frame buffer
+		if (size + alignment > kThreadChunkSize / 4)
+			return Allocate(size, alignment);
+
+		void* chunk_memory = Allocate(kThreadChunkSize, kDefaultAlignment);
+		if (chunk_memory == NULL)
+			return NULL;
+
+		chunk.allocator_id = id_;
+		chunk.frame_number = frame_number_;
+		chunk.end = (uintptr_t)chunk_memory + kThreadChunkSize;
+		const uintptr_t address = AlignUp((uintptr_t)chunk_memory, alignment);
+		chunk.next = address + size;
+		return (void*)address;
+	}
+
+	UInt8* FrameAllocator::AllocateBuffer(Frame& frame)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		// another thread may have created it while this one waited
+		UInt8* buffer = frame.buffer.load(std::memory_order_relaxed);
+		if (buffer == NULL)
+		{
+			buffer = static_cast<UInt8*>(malloc(frame_size_));
+			frame.buffer.store(buffer, std::memory_order_release);
+		}
+		return buffer;
+	}
+
+	void* FrameAllocator::AllocateOverflow(Frame& frame, size_t size, size_t alignment)
+	{
+		void* memory = malloc(size + alignment);
+		if (memory == NULL)
+			return NULL;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			frame.overflow_allocations.push_back(memory);
+		}
+		frame.overflow_bytes += size;
+		++num_overflows_;
+
+		return (void*)AlignUp((uintptr_t)memory, alignment);
+	}
+
+	void FrameAllocator::ResetFrame(Frame& frame)
+	{
+		for (void* memory : frame.overflow_allocations)
+			free(memory);
+		frame.overflow_allocations.clear();
+		frame.offset = 0;
+		frame.overflow_bytes = 0;
+	}
+
+	void FrameAllocator::NextFrame()
+	{
+		const size_t bytes_used = GetStats().bytes_used;
+		if (bytes_used > high_water_mark_)
+			high_water_mark_ = bytes_used;
+
+		current_frame_ = (current_frame_ + 1) % num_frames_;
+		++frame_number_;
+		ResetFrame(frames_[current_frame_]);
+	}
+
+	FrameAllocator::Stats FrameAllocator::GetStats() const
+	{
+		const Frame& frame = frames_[current_frame_];
+
+		Stats stats;
+		stats.frame_size = frame_size_;
+		stats.bytes_used = frame.offset.load() + frame.overflow_bytes.load();
+		stats.high_water_mark = stats.bytes_used > high_water_mark_ ? stats.bytes_used : high_water_mark_;
+		stats.num_overflows = num_overflows_;
+		return stats;
+	}
+
+	void FrameAllocator::ResetStats()
+	{
+		high_water_mark_ = 0;
+		num_overflows_ = 0;
+	}
+}
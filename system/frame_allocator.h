@@ -0,0 +1,126 @@
+#ifndef _GEF_FRAME_ALLOCATOR_H
+#define _GEF_FRAME_ALLOCATOR_H
+
+#include <gef.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+namespace gef
+{
+	/**
+	Linear allocator for scratch data that only lives for a frame or two.
+	Each frame allocates from its own buffer by bumping an offset, memory is never freed individually.
+	The buffers are used in rotation and a buffer is reset when NextFrame comes back round to it,
+	so memory allocated during a frame stays valid for num_frames - 1 further frames.
+	Allocation is thread safe. Worker threads making many small allocations should use AllocateThreadLocal,
+	which takes memory from the current buffer in chunks so threads do not contend on the offset.
+	Requests that do not fit in the buffer fall back to the heap and are freed when the buffer is reset.
+	The high water mark includes these, so it can be used to size the buffers.
+	Each buffer is allocated the first time it is used, so an allocator that is never used takes no memory.
+	*/
+	class FrameAllocator
+	{
+	public:
+		/// @brief Memory use, for sizing the frame buffers.
+		struct Stats
+		{
+			/// The size of each frame buffer in bytes.
+			size_t frame_size;
+			/// The number of bytes allocated in the current frame.
+			size_t bytes_used;
+			/// The largest number of bytes allocated in a single frame since the last ResetStats, including heap fallback allocations.
+			size_t high_water_mark;
+			/// The number of allocations that did not fit in a frame buffer since the last ResetStats.
+			UInt32 num_overflows;
+		};
+
+		/// @brief Constructor.
+		/// @param[in] frame_size	The size of each frame buffer in bytes.
+		/// @param[in] num_frames	The number of frame buffers. 2 for double buffering, 3 for triple buffering.
+		FrameAllocator(size_t frame_size = kDefaultFrameSize, UInt32 num_frames = kDefaultNumFrames);
+		~FrameAllocator();
+
+		FrameAllocator(const FrameAllocator&) = delete;
+		FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+		/// @brief Allocate memory from the current frame.
+		/// @param[in] size			The number of bytes.
+		/// @param[in] alignment	The alignment in bytes. Must be a power of two.
+		/// @return The memory, or NULL if the request did not fit and the heap allocation failed.
+		void* Allocate(size_t size, size_t alignment = kDefaultAlignment);
+
+		/// @brief Allocate memory from the current frame through a chunk owned by the calling thread.
+		/// Same as Allocate, but the shared buffer offset is only updated once per chunk.
+		/// The unused end of each chunk is wasted, so this suits many small allocations from worker threads.
+		void* AllocateThreadLocal(size_t size, size_t alignment = kDefaultAlignment);
+
+		/// @brief Allocate uninitialised storage for an array.
+		/// @note Destructors are never run, so T must be trivially destructible.
+		template<class T>
+		T* Allocate(UInt32 count)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "frame allocations are never destroyed");
+			return static_cast<T*>(Allocate(sizeof(T)*count, alignof(T) > kDefaultAlignment ? alignof(T) : kDefaultAlignment));
+		}
+
+		template<class T>
+		T* AllocateThreadLocal(UInt32 count)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "frame allocations are never destroyed");
+			return static_cast<T*>(AllocateThreadLocal(sizeof(T)*count, alignof(T) > kDefaultAlignment ? alignof(T) : kDefaultAlignment));
+		}
+
+		/// @brief Move on to the next frame buffer and reset it. Called by the platform in PreRender.
+		/// @note Must not be called while other threads are allocating.
+		void NextFrame();
+
+		Stats GetStats() const;
+
+		/// @brief Reset the high water mark and overflow count.
+		void ResetStats();
+
+		inline size_t frame_size() const { return frame_size_; }
+		inline UInt32 num_frames() const { return num_frames_; }
+		/// @brief The number of times NextFrame has been called.
+		inline UInt32 frame_number() const { return frame_number_; }
+
+		static const size_t kDefaultFrameSize = 1024 * 1024;
+		static const UInt32 kDefaultNumFrames = 2;
+		static const size_t kDefaultAlignment = 16;
+		/// The size of the chunks handed to each thread by AllocateThreadLocal.
+		static const size_t kThreadChunkSize = 16 * 1024;
+
+	private:
+		struct Frame
+		{
+			// NULL until the first allocation from this frame
+			std::atomic<UInt8*> buffer;
+			std::atomic<size_t> offset;
+			std::atomic<size_t> overflow_bytes;
+			// heap allocations for requests that did not fit in the buffer
+			std::vector<void*> overflow_allocations;
+		};
+
+		UInt8* AllocateBuffer(Frame& frame);
+		void* AllocateOverflow(Frame& frame, size_t size, size_t alignment);
+		void ResetFrame(Frame& frame);
+
+		std::unique_ptr<Frame[]> frames_;
+		size_t frame_size_;
+		UInt32 num_frames_;
+		UInt32 current_frame_;
+		UInt32 frame_number_;
+		// identifies the allocator to the per thread chunks
+		UInt32 id_;
+		// guards creating the buffers and the overflow allocation lists
+		std::mutex mutex_;
+		size_t high_water_mark_;
+		std::atomic<UInt32> num_overflows_;
+	};
+}
+
+#endif // _GEF_FRAME_ALLOCATOR_H
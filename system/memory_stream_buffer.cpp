@@ -7,4 +7,27 @@ namespace gef
 		setg(buffer, buffer, buffer + size);
 		setp(buffer, buffer + size);
 	}
+
+	MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which)
+	{
+		if (!(which & std::ios_base::in))
+			return pos_type(off_type(-1));
+
+		char* base = eback();
+		if (direction == std::ios_base::cur)
+			base = gptr();
+		else if (direction == std::ios_base::end)
+			base = egptr();
+
+		if (offset < eback() - base || offset > egptr() - base)
+			return pos_type(off_type(-1));
+
+		setg(eback(), base + offset, egptr());
+		return pos_type(gptr() - eback());
+	}
+
+	MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type position, std::ios_base::openmode which)
+	{
+		return seekoff(off_type(position), std::ios_base::beg, which);
+	}
 }
@@ -9,6 +9,11 @@ namespace gef
 	{
 	public:
 		MemoryStreamBuffer(char* buffer, size_t size);
+
+	protected:
+		// seeking moves the read position, so readers can tellg and seekg to find how much data is left
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
+		pos_type seekpos(pos_type position, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out);
 	};
 }
 
@@ -0,0 +1,186 @@
+#include <system/parallel_for.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gef
+{
+	namespace
+	{
+		// set on the threads of the pool, and on the calling thread while it runs a job,
+		// so a ParallelFor called from inside a chunk runs on the thread that called it
+		thread_local bool in_parallel_for = false;
+
+		/**
+		Threads started by the first ParallelFor that needs them and kept until the program exits,
+		so each call wakes threads that are already waiting rather than creating new ones.
+		One job runs at a time. Its chunks are taken by the calling thread and the woken workers until none are left.
+		*/
+		class WorkerPool
+		{
+		public:
+			static WorkerPool& Get()
+			{
+				static WorkerPool pool;
+				return pool;
+			}
+
+			~WorkerPool()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					quit_ = true;
+				}
+				job_ready_.notify_all();
+				for (std::thread& thread : threads_)
+					thread.join();
+			}
+
+			UInt32 num_threads() const { return (UInt32)threads_.size(); }
+
+			void Run(UInt32 count, UInt32 chunk_size, UInt32 num_chunks, const std::function<void(UInt32 begin, UInt32 end)>& func)
+			{
+				std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					func_ = &func;
+					count_ = count;
+					chunk_size_ = chunk_size;
+					num_chunks_ = num_chunks;
+					// the first chunk is kept for the calling thread
+					next_chunk_.store(1, std::memory_order_relaxed);
+					++job_num_;
+				}
+				const UInt32 num_woken = num_chunks - 1 < num_threads() ? num_chunks - 1 : num_threads();
+				for (UInt32 thread_num = 0; thread_num < num_woken; ++thread_num)
+					job_ready_.notify_one();
+
+				in_parallel_for = true;
+				RunChunk(0);
+				RunChunks();
+				in_parallel_for = false;
+
+				// every chunk has been taken, so once the workers that joined the job have finished it is complete
+				std::unique_lock<std::mutex> lock(mutex_);
+				job_done_.wait(lock, [this] { return num_busy_threads_ == 0; });
+				func_ = NULL;
+			}
+
+		private:
+			WorkerPool() :
+				func_(NULL),
+				count_(0),
+				chunk_size_(0),
+				num_chunks_(0),
+				next_chunk_(0),
+				job_num_(0),
+				num_busy_threads_(0),
+				quit_(false)
+			{
+				const UInt32 num_threads = GetNumHardwareThreads() - 1;
+				threads_.reserve(num_threads);
+				for (UInt32 thread_num = 0; thread_num < num_threads; ++thread_num)
+					threads_.emplace_back(&WorkerPool::WorkerMain, this);
+			}
+
+			void WorkerMain()
+			{
+				in_parallel_for = true;
+				UInt32 last_job_num = 0;
+				std::unique_lock<std::mutex> lock(mutex_);
+				for (;;)
+				{
+					job_ready_.wait(lock, [this, last_job_num] { return quit_ || job_num_ != last_job_num; });
+					if (quit_)
+						return;
+
+					// a worker that wakes after the job has finished finds no chunks left
+					last_job_num = job_num_;
+					if (func_ == NULL)
+						continue;
+					++num_busy_threads_;
+					lock.unlock();
+
+					RunChunks();
+
+					lock.lock();
+					if (--num_busy_threads_ == 0)
+						job_done_.notify_one();
+				}
+			}
+
+			void RunChunks()
+			{
+				for (;;)
+				{
+					const UInt32 chunk_num = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+					if (chunk_num >= num_chunks_)
+						return;
+					RunChunk(chunk_num);
+				}
+			}
+
+			inline void RunChunk(UInt32 chunk_num)
+			{
+				const UInt32 begin = chunk_num * chunk_size_;
+				const UInt32 end = begin + chunk_size_ < count_ ? begin + chunk_size_ : count_;
+				(*func_)(begin, end);
+			}
+
+			std::vector<std::thread> threads_;
+
+			// held by the thread running a job, so jobs from different threads run one after another
+			std::mutex run_mutex_;
+			// guards the job and the counters below
+			std::mutex mutex_;
+			std::condition_variable job_ready_;
+			std::condition_variable job_done_;
+
+			const std::function<void(UInt32 begin, UInt32 end)>* func_;
+			UInt32 count_;
+			UInt32 chunk_size_;
+			UInt32 num_chunks_;
+			std::atomic<UInt32> next_chunk_;
+			UInt32 job_num_;
+			UInt32 num_busy_threads_;
+			bool quit_;
+		};
+	}
+
+	UInt32 GetNumHardwareThreads()
+	{
+		UInt32 num_threads = std::thread::hardware_concurrency();
+		return num_threads > 0 ? num_threads : 1;
+	}
+
+	void ParallelFor(UInt32 count, UInt32 num_threads, const std::function<void(UInt32 begin, UInt32 end)>& func)
+	{
+		if (count == 0)
+			return;
+
+		if (num_threads == 0)
+			num_threads = GetNumHardwareThreads();
+		if (num_threads > count)
+			num_threads = count;
+
+		if (num_threads <= 1 || in_parallel_for)
+		{
+			func(0, count);
+			return;
+		}
+
+		WorkerPool& pool = WorkerPool::Get();
+		if (pool.num_threads() == 0)
+		{
+			func(0, count);
+			return;
+		}
+
+		const UInt32 chunk_size = (count + num_threads - 1) / num_threads;
+		const UInt32 num_chunks = (count + chunk_size - 1) / chunk_size;
+		pool.Run(count, chunk_size, num_chunks, func);
+	}
+}
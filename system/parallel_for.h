@@ -0,0 +1,23 @@
+#ifndef _GEF_PARALLEL_FOR_H
+#define _GEF_PARALLEL_FOR_H
+
+#include <gef.h>
+#include <functional>
+
+namespace gef
+{
+	/// @brief Get the number of threads the hardware can run concurrently.
+	/// @return The number of hardware threads. Always at least 1.
+	UInt32 GetNumHardwareThreads();
+
+	/// @brief Split a range of work items into contiguous chunks and process them on multiple threads.
+	/// @param[in] count		The number of work items.
+	/// @param[in] num_threads	The maximum number of threads to use. 0 uses GetNumHardwareThreads().
+	/// @param[in] func			Called once per chunk with the [begin, end) range of items to process.
+	/// @note The calling thread processes the first chunk, the rest are taken by threads of a pool that is started
+	/// by the first call and kept until the program exits. The function returns once all chunks have completed.
+	/// A ParallelFor called from inside func processes its whole range on the thread that called it.
+	void ParallelFor(UInt32 count, UInt32 num_threads, const std::function<void(UInt32 begin, UInt32 end)>& func);
+}
+
+#endif // _GEF_PARALLEL_FOR_H
@@ -6,6 +6,7 @@
 #include <string>
 #include <list>
 #include <maths/matrix44.h>
+#include <system/frame_allocator.h>
 
 namespace gef
 {
@@ -111,6 +112,10 @@ namespace gef
 		inline void set_depth_buffer(DepthBuffer* depth_buffer) { depth_buffer_ = depth_buffer; }
 		inline DepthBuffer* depth_buffer() const { return depth_buffer_; }
 
+		/// @brief Get the allocator for per frame scratch data.
+		/// Platform implementations move it on to the next frame in PreRender.
+		inline FrameAllocator& frame_allocator() const { return frame_allocator_; }
+
 	protected:
 		inline void set_width(const Int32 width) { width_ = width; }
 		inline void set_height(const Int32 height) { height_ = height; }
@@ -130,6 +135,9 @@ namespace gef
 
 		gef::Texture* default_texture_;
 		gef::Texture* default_normal_;
+
+		// mutable so scratch memory can be allocated through a const Platform&
+		mutable FrameAllocator frame_allocator_;
 	};
 }
 
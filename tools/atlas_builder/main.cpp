@@ -0,0 +1,86 @@
+/*
+ * atlas_builder
+ *
+ * Packs PNG images into a texture atlas file that gef::TextureAtlas::ReadFromFile loads at startup.
+ * Each image is named after its filename without the directory or extension.
+ *
+ * Build it with build/vs2015/atlas_builder.sln, or as a console program with the gef library, no platform is needed.
+ *
+ * Usage: atlas_builder [-o output.atlas] [-max-size 2048] [-padding 1] image.png [image.png ...]
+ */
+
+#include <graphics/texture_atlas.h>
+#include <graphics/image_data.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char* argv[])
+{
+	const char* output_filename = "output.atlas";
+	UInt32 max_size = gef::TextureAtlas::kDefaultMaxSize;
+	UInt32 padding = 1;
+	std::vector<const char*> input_filenames;
+
+	for (int arg_num = 1; arg_num < argc; ++arg_num)
+	{
+		if (strcmp(argv[arg_num], "-o") == 0 && arg_num < argc - 1)
+			output_filename = argv[++arg_num];
+		else if (strcmp(argv[arg_num], "-max-size") == 0 && arg_num < argc - 1)
+			max_size = (UInt32)atoi(argv[++arg_num]);
+		else if (strcmp(argv[arg_num], "-padding") == 0 && arg_num < argc - 1)
+			padding = (UInt32)atoi(argv[++arg_num]);
+		else
+			input_filenames.push_back(argv[arg_num]);
+	}
+
+	std::cout << std::endl << "Texture Atlas Builder v0.01" << std::endl << std::endl;
+
+	if (input_filenames.empty())
+	{
+		std::cout << "usage: atlas_builder [-o output.atlas] [-max-size 2048] [-padding 1] image.png [image.png ...]" << std::endl;
+		return -1;
+	}
+
+	gef::TextureAtlas atlas;
+	std::vector<std::unique_ptr<gef::ImageData>> images;
+	for (const char* input_filename : input_filenames)
+	{
+		std::unique_ptr<gef::ImageData> image(new gef::ImageData(input_filename));
+		if (image->image() == NULL)
+		{
+			std::cout << "ERROR: failed to load image: " << input_filename << std::endl;
+			return -1;
+		}
+
+		std::string name(input_filename);
+		const size_t directory_end = name.find_last_of("/\\");
+		if (directory_end != std::string::npos)
+			name = name.substr(directory_end + 1);
+		name = name.substr(0, name.find_last_of('.'));
+
+		atlas.AddImage(name.c_str(), *image);
+		images.push_back(std::move(image));
+	}
+
+	std::cout << "packing " << images.size() << " images" << std::endl;
+	if (!atlas.Build(max_size, padding))
+	{
+		std::cout << "ERROR: images do not fit in " << max_size << "x" << max_size << std::endl;
+		return -1;
+	}
+
+	std::cout << "atlas size: " << atlas.width() << "x" << atlas.height() << std::endl;
+	std::cout << "Writing output file: " << output_filename << std::endl;
+	if (!atlas.WriteToFile(output_filename))
+	{
+		std::cout << "ERROR: failed to write output file: " << output_filename << std::endl;
+		return -1;
+	}
+
+	std::cout << "Success." << std::endl;
+	return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * font_converter
+ *
+ * Converts a BMFont text file (.fnt) to the binary font format (.fntb) that gef::Font::Load reads first.
+ * The page images are not changed, keep them next to the binary font.
+ *
+ * Build it with build/vs2015/font_converter.sln, or as a console program with the gef library, no platform is needed.
+ *
+ * Usage: font_converter input.fnt [output.fntb]
+ */
+
+#include <graphics/font.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+	std::cout << std::endl << "Font Converter v0.01" << std::endl << std::endl;
+
+	if (argc < 2)
+	{
+		std::cout << "usage: font_converter input.fnt [output.fntb]" << std::endl;
+		return -1;
+	}
+
+	const std::string input_filename(argv[1]);
+	std::string output_filename;
+	if (argc > 2)
+		output_filename = argv[2];
+	else
+		output_filename = input_filename.substr(0, input_filename.find_last_of('.')) + ".fntb";
+
+	std::cout << "Writing output file: " << output_filename << std::endl;
+	if (!gef::Font::ConvertToBinary(input_filename.c_str(), output_filename.c_str()))
+	{
+		std::cout << "ERROR: failed to convert font: " << input_filename << std::endl;
+		return -1;
+	}
+
+	std::cout << "Success." << std::endl;
+	return 0;
+}